@@ -1,5 +1,6 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
 #include "esp_log.h"
 #include "arming_manager.h"
 #include "gps.h"
@@ -7,82 +8,218 @@
 #include "mqtt_client.h"
 #include "lora.h"
 #include "nvs_store.h"
+#include "config.h"
+#include "track_buffer.h"
+#include "gps_standby.h"
+#include "report_policy.h"
 
 static const char *TAG = "ALARM_RUNNER";
 
+// In power save a heartbeat may go this much early to ride on the period's
+// fix, and waits as long for it
+#define PSM_FIX_SYNC_MS     (2000)
+
+static track_point_t s_track_points[TRACK_CAPACITY];
+static track_t s_track;
+static report_policy_t s_report;
+
+static uint32_t uptime_s(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+// Oldest unsent points as one <system_iot/user/device/track/reason=hex> frame.
+// Returns false if nothing went out.
+static bool send_track(const char *user, const char *device, report_reason_t reason) {
+    static const char hex[] = "0123456789ABCDEF";
+    uint8_t batch[TRACK_FRAME_BYTES];
+    uint16_t points;
+    size_t len = track_encode(&s_track, uptime_s(), TRACK_QUANT_E7, batch, sizeof(batch), &points);
+    if (len == 0) return false;
+
+    char message[64 + 2 * TRACK_FRAME_BYTES + 128];
+    int n = snprintf(message, sizeof(message), "<system_iot/%s/%s/track/%s=", user, device,
+                     report_reason_name(reason));
+    for (size_t i = 0; i < len; i++) {
+        message[n++] = hex[batch[i] >> 4];
+        message[n++] = hex[batch[i] & 0x0F];
+    }
+    message[n++] = '>';
+
+    // Points leave the buffer only once the frame went out
+    if (lora_send((uint8_t*)message, n) == n) {
+        track_consume(&s_track, points);
+        ESP_LOGI(TAG, "LORA Track Sent (%s): %u points in %u B, %u left", report_reason_name(reason),
+                 points, (unsigned)len, track_count(&s_track));
+        return true;
+    }
+    ESP_LOGW(TAG, "LORA Track send failed, %u points kept", track_count(&s_track));
+    return false;
+}
+
+// Wake-to-first-fix of this alarm and what the receiver started from
+static void send_ttff(const gps_stats_t *stats) {
+    char user[64];
+    char device[64];
+    nvs_load_user_id(user, 64);
+    nvs_load_device_id(device, 64);
+    char message[256];
+    int len = snprintf(message, sizeof(message),
+        "<system_iot/%s/%s/gps/ttff={\"ms\":%lu,\"start\":\"%s\"}>", user, device,
+        (unsigned long)stats->ttff_ms, gps_start_name(stats->start));
+    lora_send((uint8_t*)message, len);
+    ESP_LOGI(TAG, "TTFF %lu ms (%s start)", (unsigned long)stats->ttff_ms, gps_start_name(stats->start));
+}
+
+static void send_report(const gps_snapshot_t *snap, bool fix, report_reason_t reason) {
+    char user[64];
+    char device[64];
+    nvs_load_user_id(user, 64);
+    nvs_load_device_id(device, 64);
+
+    track_flush(&s_track, NULL);
+
+    // The current position as a <.../gps={json}> frame, as before the track
+    // buffer; the track frames carry the history up to it
+    if (fix) {
+        char lat[GPS_COORD_STR_MAX], lon[GPS_COORD_STR_MAX];
+        gps_coord_format(snap->data.pos.lat_e7, lat, sizeof(lat));
+        gps_coord_format(snap->data.pos.lon_e7, lon, sizeof(lon));
+        ESP_LOGE(TAG, "ALARM ACTIVE: Fix Lat: %s, Lon: %s, Sats: %d, track %u points (%lu overwritten)",
+                 lat, lon, snap->data.satellites, track_count(&s_track),
+                 (unsigned long)s_track.dropped);
+        char payload[128];
+        snprintf(payload, sizeof(payload), "{\"lat\":%s,\"lon\":%s,\"sats\":%d,\"reason\":\"%s\"}",
+                 lat, lon, snap->data.satellites, report_reason_name(reason));
+        char message[256];
+        int len = snprintf(message, sizeof(message),
+            "<system_iot/%s/%s/gps=%s>", user, device, payload);
+        lora_send((uint8_t*)message, len);
+        ESP_LOGI(TAG, "LORA Sent: %s", payload);
+    } else {
+        char payload[128];
+        snprintf(payload, sizeof(payload), "{\"gps_fix\":false,\"sats\":%d,\"reason\":\"%s\"}",
+                 snap->data.satellites, report_reason_name(reason));
+        char message[256];
+        int len = snprintf(message, sizeof(message), 
+            "<system_iot/%s/%s/gps/status=%s>", user, device, payload);
+        lora_send((uint8_t*)message, len);
+        ESP_LOGW(TAG, "LORA Status Sent: %s", payload);
+    }
+
+    // A backlog left by failed sends gets a few frames per report
+    for (int i = 0; i < TRACK_FRAMES_PER_REPORT && track_count(&s_track) > 0; i++) {
+        if (!send_track(user, device, reason)) break;
+    }
+}
+
 void alarm_runner_task(void *pvParameter)
 {
     bool gps_active = false;
+    bool ttff_sent = false;
+    bool alarm_fix = false;         // A fix arrived during this alarm
+    uint32_t fix_seq = 0;
+    TickType_t last_sample = 0;
+    const bool psm = GPS_ALARM_PSM_PERIOD_MS > 0;
+    const report_policy_config_t report_cfg = {
+        .min_interval_ms = ALARM_REPORT_MIN_MS,
+        .max_interval_ms = ALARM_REPORT_MAX_MS,
+        .dist_m = ALARM_REPORT_DIST_M,
+        .heading_deg = ALARM_REPORT_HEADING_DEG,
+        .heading_min_mm_s = ALARM_REPORT_HEADING_MIN_MM_S,
+        .fix_sync_ms = psm ? PSM_FIX_SYNC_MS : 0,
+    };
+
+    track_init(&s_track, s_track_points, TRACK_CAPACITY, TRACK_MIN_DIST_M, TRACK_TOLERANCE_M);
+    gps_standby_init();
 
     while (1) {
         if (is_system_in_alarm()) {
-            
+            gps_snapshot_t snap;
+
             // 1. Wake GPS if not already active
             if (!gps_active) {
-                ESP_LOGW(TAG, "Alarm triggered! Waking GPS...");
-                gps_wake();
+                // A standby session may already have the receiver running
+                if (gps_standby_handover()) {
+                    ESP_LOGW(TAG, "Alarm triggered! GPS already awake (standby)");
+                } else {
+                    ESP_LOGW(TAG, "Alarm triggered! Waking GPS...");
+                    gps_read_snapshot(&snap, &fix_seq);     // Fixes from before the sleep are stale
+                    gps_wake();
+                }
                 gps_active = true;
+                // One fix per shortest report interval in power save, faster fixes otherwise
+                if (psm) gps_set_power_save(GPS_ALARM_PSM_PERIOD_MS);
+                else gps_set_nav_rate(GPS_ALARM_NAV_RATE_MS);
+                track_reset(&s_track);
+                report_policy_init(&s_report, &report_cfg);
+                ttff_sent = false;
+                alarm_fix = false;
+                last_sample = xTaskGetTickCount() - pdMS_TO_TICKS(TRACK_SAMPLE_MS);
                 // Give GPS module time to wake up and start acquiring satellites
                 vTaskDelay(pdMS_TO_TICKS(500)); 
             }
 
-            // 2. Get Real Coordinates
-            gps_data_t coords = gps_get_coordinates();
-
-            if (coords.is_valid) {
-                // Log valid coordinates (This is where you would eventually send HTTP POST)
-                ESP_LOGE(TAG, "ALARM ACTIVE: Valid Fix! Lat: %.5f, Lon: %.5f, Sats: %d",
-                         coords.latitude, 
-                         coords.longitude,
-                         coords.satellites);
-                    char user[64];
-                    char device[64];
-                    nvs_load_user_id(user, 64);
-                    nvs_load_device_id(device, 64);
-                    char payload[128];
-                    snprintf(payload, sizeof(payload),
-                        "{\"lat\":%.6f,\"lon\":%.6f,\"sats\":%d}",
-                        coords.latitude,
-                        coords.longitude,
-                        coords.satellites
-                    );
-                    char message[256];
-                    int len = snprintf(message, sizeof(message), 
-                        "<system_iot/%s/%s/gps=%s>", user, device, payload);
-                    lora_send((uint8_t*)message, len);
-                    ESP_LOGI(TAG, "LORA Sent: %s", payload);
-
-            } else {
-
-                char user[64];
-                char device[64];
-                nvs_load_user_id(user, 64);
-                nvs_load_device_id(device, 64);
-                char payload[128];
-                snprintf(payload, sizeof(payload),
-                        "{\"gps_fix\":false,\"sats\":%d}", coords.satellites);
-                char message[256];
-                int len = snprintf(message, sizeof(message), 
-                    "<system_iot/%s/%s/gps/status=%s>", user, device, payload);
-                lora_send((uint8_t*)message, len);
-                ESP_LOGW(TAG, "LORA Status Sent: %s", payload);
+            // 2. Sample new fixes into the track
+            bool new_fix = gps_read_snapshot(&snap, &fix_seq) && snap.data.is_valid;
+            TickType_t now = xTaskGetTickCount();
+            track_point_t p = {
+                .lat_e7 = snap.data.pos.lat_e7,
+                .lon_e7 = snap.data.pos.lon_e7,
+                .t_s = (uint32_t)(snap.fix_time_us / 1000000),
+            };
+            if (new_fix) alarm_fix = true;
+            if (new_fix && now - last_sample >= pdMS_TO_TICKS(TRACK_SAMPLE_MS)) {
+                track_add(&s_track, &p);
+                last_sample = now;
+            }
+            if (!ttff_sent) {
+                gps_stats_t stats;
+                gps_get_stats(&stats);
+                if (stats.ttff_ms > 0) {
+                    send_ttff(&stats);
+                    ttff_sent = true;
+                }
             }
 
-            // 1 second delay between logs/updates
-            vTaskDelay(pdMS_TO_TICKS(30000));
+            // 3. Report when the fix says it matters: first fix, moved,
+            // turned, or a heartbeat backing off while parked
+            report_inputs_t in = {
+                .fix = alarm_fix && snap.data.is_valid,
+                .new_fix = new_fix,
+                .pos = p,
+                .course_e2 = snap.data.course_e2,
+                .speed_mm_s = snap.data.speed_mm_s,
+            };
+            uint32_t now_ms = pdTICKS_TO_MS(now);
+            report_reason_t reason = report_policy_step(&s_report, &in, now_ms);
+            if (reason != REPORT_REASON_NONE) {
+                send_report(&snap, in.fix, reason);
+                report_policy_sent(&s_report, reason, &in, now_ms);
+                ESP_LOGI(TAG, "Report (%s), next heartbeat in %lu s", report_reason_name(reason),
+                         (unsigned long)(s_report.interval_ms / 1000));
+            }
+
+            // Alarm fixes count as fresh for the standby policy
+            gps_standby_poll();
+            vTaskDelay(pdMS_TO_TICKS(ALARM_POLL_MS));
 
         } else {
             // System is NOT in alarm
             
-            // 3. Sleep GPS if it was active
+            // 4. Sleep GPS if it was active
             if (gps_active) {
                 ESP_LOGI(TAG, "Alarm cleared. Putting GPS to sleep.");
+                if (psm) gps_set_power_save(0);
+                else gps_set_nav_rate(GPS_NAV_RATE_MS);
                 gps_sleep();
                 gps_active = false;
             }
 
+            // 5. Keep the receiver's aiding data warm while armed
+            gps_standby_poll();
+
             // Idle wait
             vTaskDelay(pdMS_TO_TICKS(500));
         }
     }
-}
\ No newline at end of file
+}
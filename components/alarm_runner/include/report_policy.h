@@ -0,0 +1,84 @@
+#ifndef REPORT_POLICY_H
+#define REPORT_POLICY_H
+
+/*
+ * Decides when an alarm sends a LoRa report, so that airtime goes to a bike
+ * being moved and not to one standing in a van. Pure logic with explicit
+ * time input (ms) and no ESP-IDF dependencies, like power_fsm.
+ *
+ * The alarm start and the first valid fix are reported at once. After that
+ * a report goes out when the position moved dist_m from the last reported
+ * one, or the course turned by heading_deg (only above heading_min_mm_s,
+ * the GPS course is noise at walking pace). Both wait for min_interval_ms.
+ * Without movement a heartbeat keeps the link alive; its interval starts at
+ * min_interval_ms and doubles with every heartbeat up to max_interval_ms.
+ * Movement resets it.
+ *
+ * With the receiver in power save a fix arrives once per period: a
+ * heartbeat may then go fix_sync_ms early to ride on a fresh fix, and
+ * waits as long past its deadline for one.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "track_buffer.h"
+
+typedef enum {
+    REPORT_REASON_NONE,
+    REPORT_REASON_START,        // Alarm raised, no fix yet
+    REPORT_REASON_FIRST_FIX,    // First valid fix of the alarm
+    REPORT_REASON_MOVED,        // Displacement since the last report
+    REPORT_REASON_TURNED,       // Course change while riding
+    REPORT_REASON_HEARTBEAT,    // Interval elapsed without movement
+} report_reason_t;
+
+typedef struct {
+    uint32_t min_interval_ms;   // Between movement reports; first heartbeat interval
+    uint32_t max_interval_ms;   // Longest heartbeat interval
+    uint16_t dist_m;
+    uint16_t heading_deg;
+    uint32_t heading_min_mm_s;
+    uint32_t fix_sync_ms;       // 0 = fixes arrive continuously
+} report_policy_config_t;
+
+typedef struct {
+    bool fix;                   // Valid position (not necessarily new)
+    bool new_fix;               // New since the last step
+    track_point_t pos;
+    uint16_t course_e2;         // Degrees * 100
+    uint32_t speed_mm_s;
+} report_inputs_t;
+
+typedef struct {
+    report_policy_config_t cfg;
+    bool started;               // START sent
+    bool had_fix;               // FIRST_FIX sent
+    uint32_t last_ms;           // Last report
+    uint32_t interval_ms;       // Current heartbeat interval
+    bool has_pos;
+    track_point_t last_pos;     // Position of the last report with a fix
+    bool has_course;
+    uint16_t last_course_e2;
+    uint32_t sent[REPORT_REASON_HEARTBEAT + 1];
+} report_policy_t;
+
+/**
+ * @brief Reset for a new alarm; the next step asks for a START report.
+ */
+void report_policy_init(report_policy_t *p, const report_policy_config_t *cfg);
+
+/**
+ * @brief Evaluate the latest fix.
+ * @return The reason to report now, REPORT_REASON_NONE to wait.
+ */
+report_reason_t report_policy_step(const report_policy_t *p, const report_inputs_t *in, uint32_t now_ms);
+
+/**
+ * @brief Record a report made for reason, with the inputs it was decided on.
+ * Points of a frame that failed to send stay in the track for the next one.
+ */
+void report_policy_sent(report_policy_t *p, report_reason_t reason, const report_inputs_t *in, uint32_t now_ms);
+
+const char *report_reason_name(report_reason_t reason);
+
+#endif // REPORT_POLICY_H
@@ -0,0 +1,71 @@
+#include "report_policy.h"
+#include <string.h>
+
+void report_policy_init(report_policy_t *p, const report_policy_config_t *cfg) {
+    memset(p, 0, sizeof(*p));
+    p->cfg = *cfg;
+    p->interval_ms = cfg->min_interval_ms;
+}
+
+static uint16_t course_diff_e2(uint16_t a, uint16_t b) {
+    uint32_t d = (a > b ? a - b : b - a) % 36000u;
+    return (uint16_t)(d > 18000u ? 36000u - d : d);
+}
+
+report_reason_t report_policy_step(const report_policy_t *p, const report_inputs_t *in, uint32_t now_ms) {
+    if (in->fix && !p->had_fix) return REPORT_REASON_FIRST_FIX;
+    if (!p->started) return REPORT_REASON_START;
+
+    // fix_sync_ms lets a report ride on a power save fix that comes a bit early
+    const uint32_t since = now_ms - p->last_ms;
+    const uint32_t sync = p->cfg.fix_sync_ms;
+
+    if (in->new_fix && since + sync >= p->cfg.min_interval_ms) {
+        if (p->has_pos && track_distance_m(&p->last_pos, &in->pos) >= (float)p->cfg.dist_m) {
+            return REPORT_REASON_MOVED;
+        }
+        if (p->has_course && in->speed_mm_s >= p->cfg.heading_min_mm_s &&
+            course_diff_e2(in->course_e2, p->last_course_e2) >= p->cfg.heading_deg * 100u) {
+            return REPORT_REASON_TURNED;
+        }
+    }
+
+    if (since + sync >= p->interval_ms && (in->new_fix || since >= p->interval_ms + sync)) {
+        return REPORT_REASON_HEARTBEAT;
+    }
+    return REPORT_REASON_NONE;
+}
+
+void report_policy_sent(report_policy_t *p, report_reason_t reason, const report_inputs_t *in, uint32_t now_ms) {
+    if (reason == REPORT_REASON_NONE) return;
+    p->sent[reason]++;
+    p->last_ms = now_ms;
+    p->started = true;
+    if (reason == REPORT_REASON_FIRST_FIX) p->had_fix = true;
+
+    if (reason == REPORT_REASON_HEARTBEAT) {
+        // Nothing moved: back off
+        p->interval_ms = p->interval_ms > p->cfg.max_interval_ms / 2 ? p->cfg.max_interval_ms : p->interval_ms * 2;
+    } else {
+        p->interval_ms = p->cfg.min_interval_ms;
+    }
+
+    if (in->fix) {
+        p->has_pos = true;
+        p->last_pos = in->pos;
+        p->has_course = in->speed_mm_s >= p->cfg.heading_min_mm_s;
+        p->last_course_e2 = in->course_e2;
+    }
+}
+
+const char *report_reason_name(report_reason_t reason) {
+    switch (reason) {
+    case REPORT_REASON_NONE:      return "none";
+    case REPORT_REASON_START:     return "start";
+    case REPORT_REASON_FIRST_FIX: return "first_fix";
+    case REPORT_REASON_MOVED:     return "moved";
+    case REPORT_REASON_TURNED:    return "turned";
+    case REPORT_REASON_HEARTBEAT: return "heartbeat";
+    default:                      return "?";
+    }
+}
@@ -51,6 +51,22 @@ void set_system_armed(bool armed) {
     xEventGroupSetBits(arming_event_group, SEND_STATUS_BIT);
 }
 
+void arming_restore(bool armed) {
+    if (arming_event_group == NULL) return;
+
+    if (armed) {
+        xEventGroupSetBits(arming_event_group, SYSTEM_ARMED_BIT);
+        ESP_LOGI(TAG, "Armed state restored after sleep");
+    } else {
+        xEventGroupClearBits(arming_event_group, SYSTEM_ARMED_BIT);
+    }
+}
+
+bool arming_status_pending(void) {
+    if (arming_event_group == NULL) return false;
+    return (xEventGroupGetBits(arming_event_group) & SEND_STATUS_BIT) != 0;
+}
+
 void arming_lora_sender_task(void *pv) {
     while(1) {
         // Czekaj aż pojawi się bit prośby o wysyłkę
@@ -17,4 +17,9 @@ void trigger_system_alarm(void);
 void clear_system_alarm(void);    
 void arming_lora_sender_task(void *pv);
 
+// Restores the armed state after a deep-sleep wake (no status message)
+void arming_restore(bool armed);
+// True while an armed/disarmed status message waits to be sent
+bool arming_status_pending(void);
+
 #endif
\ No newline at end of file
@@ -9,8 +9,7 @@
 #include "arming_manager.h"
 #include "button_monitor.h"
 #include "nvs_store.h" // Updated include
-
-#define BOOT_BUTTON_PIN 0
+#include "config.h"
 
 // Time Thresholds (in Milliseconds)
 #define SHORT_HOLD_MIN_MS  1000  // 1 second
@@ -7,14 +7,124 @@
 #define GPS_TXD_PIN (GPIO_NUM_26)
 #define GPS_RXD_PIN (GPIO_NUM_27)
 #define GPS_UART_PORT (UART_NUM_1)
-#define GPS_BAUD_RATE (9600)
+#define GPS_BAUD_RATE (9600)            // Module default after a cold start
 #define GPS_RX_BUF_SIZE (1024)
+#define GPS_PROTOCOL_UBX (1)            // 1 = binary UBX-NAV output, 0 = reduced NMEA sentence set
+#define GPS_UBX_NAV_PVT (0)             // NAV-PVT instead of POSLLH+SOL+VELNED (u-blox 7 and later)
+#define GPS_TARGET_BAUD_RATE (38400)    // Negotiated with CFG-PRT after power-up
+#define GPS_NAV_RATE_MS (1000)          // Fix period normally ...
+#define GPS_ALARM_NAV_RATE_MS (500)     // ... and during an alarm in continuous tracking
+// Alarm power save (opt-in): one fix per period saves most of the receiver
+// energy (tools/gps_bench/psm_energy), but the track then holds one point per
+// period instead of one per TRACK_SAMPLE_MS and the course is stale between
+// fixes. Only worth it where battery matters more than the route.
+#define GPS_ALARM_PSM_PERIOD_MS (0)     // Alarm power save fix period, e.g. ALARM_REPORT_MIN_MS (0 = continuous tracking)
+#define GPS_PSM_SEARCH_MS (10000)       // Power save retry period without a fix
+#define GPS_PSM_ON_TIME_S (2)           // Tracking kept after each power save fix
+#define GPS_DYN_MODEL (3)               // CFG-NAV5 model, 3 = pedestrian (bike speeds)
+#define GPS_ACK_TIMEOUT_MS (300)        // Wait for ACK-ACK/NAK per attempt
+#define GPS_CFG_ATTEMPTS (3)            // Attempts per configuration message
+#define GPS_EVENT_QUEUE_LEN (16)        // UART driver events
+#define GPS_PATTERN_QUEUE_LEN (16)      // Pending '\n' positions (two NMEA epochs)
+#define GPS_RX_TIMEOUT_SYMBOLS (4)      // Idle byte times that end a burst / UBX frame
+#define GPS_LEAP_SECONDS (18)           // GPS - UTC, to date NMEA/PVT fixes in GPS time
+#define GPS_AID_POS_ACC_M (50000)       // Accuracy claimed for the stored position (bike may have moved)
+#define GPS_AID_TIME_ACC_MS (1000)      // Time aiding accuracy right after a fix ...
+#define GPS_AID_RTC_DRIFT_PPM (500)     // ... plus the ESP32 RTC clock drift since
+#define GPS_EPHEMERIS_MAX_AGE_S (14400) // Last fix older than this = warm start
+
+// --- GPS warm standby (armed, no alarm) ---
+#define GPS_STANDBY_REFRESH_S (10800)       // Refix before the ephemeris ages out (0 = never)
+#define GPS_STANDBY_ACTIVITY_GAP_S (900)    // Sub-threshold motion refixes if the last fix is older
+#define GPS_STANDBY_AFTER_FIX_S (30)        // Kept on past the first fix to finish the ephemeris
+#define GPS_STANDBY_SESSION_MAX_S (120)     // Give up without a fix
+#define GPS_STANDBY_BUDGET_S (1800)         // Standby receiver-on seconds per day
+
+// --- Alarm track ---
+#define ALARM_REPORT_MIN_MS (30000)     // Shortest LoRa report interval during an alarm ...
+#define ALARM_REPORT_MAX_MS (600000)    // ... longest, heartbeats back off to it while parked
+#define ALARM_REPORT_DIST_M (50)        // Displacement since the last report that triggers one
+#define ALARM_REPORT_HEADING_DEG (45)   // Course change that triggers a report ...
+#define ALARM_REPORT_HEADING_MIN_MM_S (2000) // ... above this speed (course is noise when slower)
+#define ALARM_POLL_MS (500)             // Fix polling during an alarm
+#define TRACK_SAMPLE_MS (5000)          // Fix sampling into the track buffer
+#define TRACK_CAPACITY (128)            // Kept points awaiting upload (12 B each)
+#define TRACK_MIN_DIST_M (10)           // Closer fixes are jitter
+#define TRACK_TOLERANCE_M (15)          // Max deviation of the simplified track
+#define TRACK_QUANT_E7 (10)             // Delta resolution, 1e-6 deg (~1.1 m)
+#define TRACK_FRAME_BYTES (48)          // Binary bytes per track frame (hex encoded)
+#define TRACK_FRAMES_PER_REPORT (4)     // Track frames per report while a backlog is left
 
 // --- MPU Config ---
 #define MPU_SCL_IO (22)
 #define MPU_SDA_IO (21)
 #define MPU_DEVICE_ADDR (0x68)
 #define MPU_I2C_PORT (0)
+#define MPU_INT_PIN (GPIO_NUM_32)       // MPU INT output (active high, RTC-capable GPIO)
+#define MPU_STATE_CHECK_MS (500)        // How often the monitor re-checks arming state while idle
+#define MPU_MOTION_THRESHOLD (20)       // Default MOT_THR (1 LSB = 2 mg), changeable by command
+#define MPU_MOTION_DURATION (1)         // Default MOT_DUR (ms)
+#define MPU_CMD_QUEUE_LEN (8)           // Pending commands for the IMU service
+#define MPU_CALIB_ITERATIONS (200)      // Samples for a commanded recalibration
+#define MPU_ARMED_SENSING_DEFAULT (MPU_SENSING_PARKED_SENSITIVE) // Armed profile until one is selected remotely
+
+// --- Motion Verification (false alarm filter) ---
+// A hardware motion interrupt only escalates to an alarm if the sampled
+// motion that follows satisfies the rule below.
+#define MOTION_ODR_HZ            (50)    // FIFO sample rate while verifying
+#define MOTION_DRAIN_MS          (100)   // FIFO drain period while verifying
+#define MOTION_VERIFY_MS         (3000)  // Verification window after the last interrupt
+#define MOTION_WINDOW_SAMPLES    (50)    // 1 s feature window
+#define MOTION_ACTIVE_MG         (60)    // Dynamic accel counted as motion
+#define MOTION_GAP_MS            (400)   // Quiet gap tolerated inside one motion episode
+#define MOTION_SUSTAINED_MS      (4000)  // Required sustained motion (longer than a rack jostle)
+#define MOTION_RMS_MG            (80)    // Required windowed RMS ...
+#define MOTION_JERK_MG_S         (0)     // ... or windowed jerk (0 = disabled)
+#define MOTION_MIN_VARIANCE_MG2  (0)     // Min |a| variance (0 = disabled)
+
+// --- Tilt Detection ---
+// Orientation captured at arm time; lifting / tipping the bike raises an alarm.
+#define TILT_THRESHOLD_DEG       (20.0f) // Deviation from the armed orientation
+#define TILT_ACCEL_WEIGHT        (0.05f) // Complementary filter accel weight
+#define TILT_ACCEL_GATE_G        (0.25f) // Ignore accel during shocks
+#define TILT_SETTLE_SAMPLES      (50)    // Samples before the reference is captured (1 s)
+
+// --- IMU Calibration ---
+// Offsets are loaded from NVS at boot and refined in the background while
+// disarmed, from windows in which the sensor was still.
+#define IMU_RECAL_WINDOW_SAMPLES (16)    // One sample per MPU_STATE_CHECK_MS -> 8 s window
+#define IMU_RECAL_ACCEL_BAND_LSB (80)    // Max peak-to-peak per accel axis (~10 mg at 4G)
+#define IMU_RECAL_GYRO_BAND_LSB  (65)    // Max peak-to-peak per gyro axis (~0.5 deg/s)
+#define IMU_RECAL_FLAT_TOL_LSB   (800)   // Accel offsets only learnt within ~0.1 g of flat
+#define IMU_RECAL_BLEND_SHIFT    (2)     // Each still window moves offsets by 1/4
+#define IMU_CALIB_SAVE_INTERVAL_S (3600) // Min time between NVS writes (flash wear)
+
+// Offset drift with temperature: a line per axis fitted to the still windows,
+// evaluated at the die temperature read every IMU_TEMP_READ_PERIOD_S.
+#define IMU_TEMP_READ_PERIOD_S       (30)
+#define IMU_TEMPCO_MEMORY_POINTS     (512)    // Forgetting horizon of the fit (points)
+#define IMU_TEMPCO_MIN_POINTS        (32)     // Points per axis before a slope is used
+#define IMU_TEMPCO_MIN_SPAN_CENTI    (200)    // Temperature spread (1 sigma) before a slope is used
+#define IMU_TEMPCO_MIN_STEP_CENTI    (50)     // Windows within 0.5 C of the last point...
+#define IMU_TEMPCO_SAME_TEMP_EVERY   (8)      // ...count only every 8th (~1 min)
+#define IMU_TEMPCO_MAX_ACCEL_G_PER_C (0.002f) // Plausibility clamps on the slope
+#define IMU_TEMPCO_MAX_GYRO_DPS_PER_C (0.5f)
+#define IMU_TEMPCO_CALIB_WEIGHT      (8.0f)   // A full calibration counts as 8 windows
+
+// --- Pre-trigger Capture ---
+// Raw accel history kept while armed, frozen and stored in NVS on each alarm.
+// Footprint: 6 B per sample + 32 B header (RAM and NVS), e.g. 8 s @ 50 Hz = 2432 B.
+// A verified motion alarm fires MOTION_SUSTAINED_MS after the interrupt, so
+// the ring has to be longer than that to keep anything from before it.
+// The ring only fills while the sample stream runs. After a deep sleep wake,
+// or with a low-power armed profile, the stream starts at the interrupt, so
+// the record holds the verification window and no history before it (the
+// FIFO is off while parked). The header says how much of the record came
+// before the trigger (pre_count, to within one FIFO drain) and flags a
+// trigger that woke the chip.
+#define PRETRIGGER_SECONDS       (8)
+#define PRETRIGGER_DECIMATION    (1)     // Keep every n-th stream sample
+#define PRETRIGGER_SAMPLES       (PRETRIGGER_SECONDS * MOTION_ODR_HZ / PRETRIGGER_DECIMATION)
 
 // --- Battery Config ---
 // ADC1_CHANNEL_6 is GPIO 34 on most ESP32 boards
@@ -31,6 +141,19 @@
 #define BAT_MAX_VOLTAGE (4500) // 4.5V (1.5V per cell)
 #define BAT_MIN_VOLTAGE (3300) // 3.3V (1.1V per cell - empty)
 
+// --- Button ---
+#define BOOT_BUTTON_PIN (GPIO_NUM_0)    // Active low, RTC-capable (ext0 wake)
+
+// --- Power Management ---
+// While armed and quiet the device enters deep sleep. Wake sources: MPU INT
+// (ext1), boot button (ext0), LoRa AUX (ext1, see LORA_AUX_BUSY_LEVEL) and
+// an optional periodic timer that opens a downlink listen window.
+#define POWER_EVAL_MS            (250)   // Sleep decision period
+#define POWER_SETTLE_MS          (15000) // Quiet time after any activity before sleeping
+#define POWER_LISTEN_MS          (3000)  // Awake window after a LoRa / timer wake
+#define POWER_LISTEN_PERIOD_S    (0)     // Timer wake period (0 = disabled)
+#define POWER_PREPARE_TIMEOUT_MS (500)   // Max wait for the IMU service to park
+
 // --- Lora Config ---
 #define LORA_TX_PIN (GPIO_NUM_17)
 #define LORA_RX_PIN (GPIO_NUM_16)
@@ -39,5 +162,8 @@
 #define LORA_AUX_PIN        (GPIO_NUM_4)
 #define LORA_UART_PORT      (UART_NUM_2)
 #define LORA_BAUD_RATE      (9600)
+#define LORA_AUX_BUSY_LEVEL (1)    // AUX level while the module is busy (see wait_for_aux)
+#define LORA_DUMP_CHUNK_BYTES (48) // Binary bytes per frame when dumping a capture (hex encoded)
+#define LORA_DUMP_GAP_MS    (200)  // Pause between dump frames
 
 #endif // CONFIG_H
\ No newline at end of file
@@ -1,28 +1,124 @@
 #include "gps.h"
+#include "gps_stream.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "driver/uart.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
 
 #include "config.h" 
+#include "nvs_store.h"
 
 #define GPS_TASK_STACK      4096
 
 static const char *TAG = "GPS";
 
-// Thread safety
-static SemaphoreHandle_t gps_mutex = NULL;
-static gps_data_t current_gps_data = {0};
+// Fix state. gps_task assembles it in s_work and publishes a copy into one
+// of two slots; s_pub_seq counts half-steps (odd while a slot is written).
+// Publication n lives in slot n & 1, so a reader copying the latest slot is
+// only disturbed if two more publications start during its copy.
+static gps_snapshot_t s_work;
+static gps_snapshot_t s_slots[2];
+static uint32_t s_pub_seq = 0;
+
+// Byte-stream parsers, owned by gps_task
+static gps_stream_t s_stream;
+
+// Last UBX navigation messages of the current epoch (gps_task only)
+static ubx_nav_posllh_t s_posllh;
+static ubx_nav_sol_t s_sol;
+static uint32_t s_committed_itow = UINT32_MAX;
+
+// Ingestion counters; cfg_errors and start are written by the configuring
+// task, the rest by gps_task
+static gps_stats_t s_stats;
+
+// Aiding data for the next wake, written by gps_task. The RTC copy survives
+// deep sleep together with the RTC clock that dates it; the NVS copy keeps
+// the position through a power loss.
+#define GPS_AID_MAGIC       (0x47414931)    // "GAI1"
+#define GPS_EPOCH_UNIX_DAYS (3657)          // 1980-01-06
+#define MS_PER_WEEK         (604800000LL)
+
+typedef struct {
+    uint32_t magic;
+    bool has_pos;
+    bool has_time;
+    bool dated;             // pos_rtc_us is on the current RTC clock
+    int32_t lat_e7;
+    int32_t lon_e7;
+    int64_t pos_rtc_us;     // RTC clock when the position was fixed
+    int64_t gps_ms;         // GPS time since 1980-01-06 ...
+    int64_t time_rtc_us;    // ... at this RTC clock
+} gps_aid_t;
+
+static RTC_DATA_ATTR gps_aid_t s_aid;
+static bool s_aid_dirty = false;            // Position not in NVS yet
+static RTC_DATA_ATTR volatile bool s_state_lost = true;   // No fix since the receiver lost its backup state
+static volatile bool s_ttff_pending = false;
+static int64_t s_wake_us;
+
+// Receiver configuration. s_wanted is what callers declared, s_applied what
+// the module confirmed (only meaningful while s_applied_valid). The module
+// keeps its configuration in backup, so the confirmed state and the port
+// baud stay in RTC memory across deep sleep with it.
+typedef enum {
+    CFG_REPLY_ACK,
+    CFG_REPLY_NAK,
+    CFG_REPLY_POLL,         // CFG message sent back for a poll request
+} cfg_reply_kind_t;
+
+#define CFG_REPLY_MAX       (44)     // CFG-PM2
+
+typedef struct {
+    cfg_reply_kind_t kind;
+    uint8_t cls;            // Acknowledged or polled message
+    uint8_t id;
+    uint8_t len;
+    uint8_t payload[CFG_REPLY_MAX];
+} cfg_reply_t;
+
+static QueueHandle_t s_cfg_replies = NULL;   // gps_task -> configuring task
+static SemaphoreHandle_t s_cfg_mutex = NULL;
+static gps_receiver_config_t s_wanted = {
+    .baud_rate = GPS_TARGET_BAUD_RATE,
+    .nav_rate_ms = GPS_NAV_RATE_MS,
+    .dyn_model = GPS_DYN_MODEL,
+    .ubx_output = GPS_PROTOCOL_UBX,
+    .psm_period_ms = 0,
+};
+static RTC_DATA_ATTR gps_receiver_config_t s_applied;
+static RTC_DATA_ATTR bool s_applied_valid = false;
+static bool s_awake = false;
+static RTC_DATA_ATTR uint32_t s_uart_baud = GPS_BAUD_RATE;
+
+// UART ingestion. gps_task sleeps on the driver's event queue; in NMEA
+// output a '\n' pattern event marks each complete sentence, UBX frames end
+// at the rx idle timeout. A private event parks the task for gps_sleep().
+#define GPS_EVENT_PARK      (UART_EVENT_MAX)
+
+static QueueHandle_t s_uart_events = NULL;
+static SemaphoreHandle_t s_parked = NULL;       // Given by gps_task when parked
+static volatile bool s_rx_lines = true;         // Read up to '\n' positions only
+static volatile bool s_cfg_active = false;      // Replies without '\n' expected
+
+static void rx_discard(void);
 
 // Internal parsing helpers
-static void parse_nmea_line(char *line);
-static float nmea_to_decimal(float nmea_coord, char quadrant);
+static void handle_message(void *ctx, const gps_stream_t *s, nmea_type_t nmea, ubx_type_t ubx);
 static void send_ubx(uint8_t cls, uint8_t id, uint8_t *payload, uint16_t length);
+static esp_err_t apply_config(void);
+static bool verify_config(void);
+static void psm_nudge(void);
 
 #pragma pack(push, 1)
 
@@ -32,26 +128,225 @@ typedef struct {
     uint32_t flags;     // 0x02 = Backup
 } ubx_rxm_pmreq_t;
 
+// UBX-CFG-PRT for a UART port (u-blox 6 layout)
+typedef struct {
+    uint8_t port_id;        // 1 = UART1
+    uint8_t reserved0;
+    uint16_t tx_ready;
+    uint32_t mode;          // Character framing
+    uint32_t baud_rate;
+    uint16_t in_proto_mask;
+    uint16_t out_proto_mask;
+    uint16_t flags;
+    uint16_t reserved5;
+} ubx_cfg_prt_t;
+
+// UBX-CFG-MSG, rate on the port the command arrives on
+typedef struct {
+    uint8_t msg_class;
+    uint8_t msg_id;
+    uint8_t rate;           // Per navigation epoch, 0 = off
+} ubx_cfg_msg_t;
+
+// UBX-CFG-RATE
+typedef struct {
+    uint16_t meas_rate_ms;
+    uint16_t nav_rate;      // Measurements per solution, always 1
+    uint16_t time_ref;      // 1 = GPS time
+} ubx_cfg_rate_t;
+
+// UBX-CFG-NAV5, only the fields selected by mask are applied
+typedef struct {
+    uint16_t mask;
+    uint8_t dyn_model;
+    uint8_t fix_mode;
+    uint8_t reserved[32];
+} ubx_cfg_nav5_t;
+
+// UBX-CFG-RXM (u-blox 6 layout)
+typedef struct {
+    uint8_t reserved1;      // Always 8
+    uint8_t lp_mode;        // 0 = continuous (max performance), 1 = power save
+} ubx_cfg_rxm_t;
+
+// UBX-CFG-PM2, power save mode settings (u-blox 6, version 1)
+typedef struct {
+    uint8_t version;
+    uint8_t reserved1;
+    uint8_t reserved2;
+    uint8_t reserved3;
+    uint32_t flags;
+    uint32_t update_period_ms;  // Fix period; > 10 s runs ON/OFF, shorter cyclic tracking
+    uint32_t search_period_ms;  // Retry period after a failed acquisition
+    uint32_t grid_offset_ms;
+    uint16_t on_time_s;         // Kept tracking after each fix
+    uint16_t min_acq_time_s;
+    uint8_t reserved4[20];
+} ubx_cfg_pm2_t;
+
+// UBX-AID-INI, position as latitude/longitude and time as GPS week/TOW
+typedef struct {
+    int32_t lat_e7;         // ecefXOrLat
+    int32_t lon_e7;         // ecefYOrLon
+    int32_t alt_cm;         // ecefZOrAlt
+    uint32_t pos_acc_cm;
+    uint16_t tm_cfg;
+    uint16_t week;          // wnoOrDate
+    uint32_t tow_ms;        // towOrTime
+    int32_t tow_ns;
+    uint32_t t_acc_ms;
+    uint32_t t_acc_ns;
+    int32_t clk_d;
+    uint32_t clk_d_acc;
+    uint32_t flags;
+} ubx_aid_ini_t;
+
 #pragma pack(pop)
 
+#define UBX_CFG_PRT         (0x00)
+#define UBX_CFG_MSG         (0x01)
+#define UBX_CFG_RATE        (0x08)
+#define UBX_CFG_RXM         (0x11)
+#define UBX_CFG_NAV5        (0x24)
+#define UBX_CFG_PM2         (0x3B)
+#define UBX_PRT_UART1       (1)
+#define UBX_PRT_MODE_8N1    (0x000008D0)
+#define UBX_PROTO_UBX       (0x0001)
+#define UBX_PROTO_NMEA      (0x0002)
+#define UBX_NAV5_MASK_DYN   (0x0001)
+#define UBX_RXM_CONTINUOUS  (0)
+#define UBX_RXM_POWER_SAVE  (1)
+#define UBX_PM2_UPDATE_RTC  (0x00000800)
+#define UBX_PM2_UPDATE_EPH  (0x00001000)
+#define UBX_AID_INI         (0x01)
+#define UBX_AID_INI_POS     (0x0001)
+#define UBX_AID_INI_TIME    (0x0002)
+#define UBX_AID_INI_LLA     (0x0020)
+#define UBX_AID_INI_ALT_INV (0x0040)
+
+// NMEA standard messages (class 0xF0)
+#define NMEA_CLASS_STD      (0xF0)
+#define NMEA_MSG_GGA        (0x00)
+#define NMEA_MSG_GLL        (0x01)
+#define NMEA_MSG_GSA        (0x02)
+#define NMEA_MSG_GSV        (0x03)
+#define NMEA_MSG_RMC        (0x04)
+#define NMEA_MSG_VTG        (0x05)
+
+// Declared message set: rate per epoch in UBX and in NMEA output mode.
+// ACKs and poll replies are UBX, so UBX output stays on in NMEA mode.
+static const struct {
+    uint8_t cls;
+    uint8_t id;
+    uint8_t ubx_rate;
+    uint8_t nmea_rate;
+} s_messages[] = {
+    {UBX_CLASS_NAV, UBX_NAV_POSLLH, !GPS_UBX_NAV_PVT, 0},
+    {UBX_CLASS_NAV, UBX_NAV_SOL,    !GPS_UBX_NAV_PVT, 0},
+    {UBX_CLASS_NAV, UBX_NAV_VELNED, !GPS_UBX_NAV_PVT, 0},
+#if GPS_UBX_NAV_PVT
+    {UBX_CLASS_NAV, UBX_NAV_PVT,    1, 0},
+#endif
+    {NMEA_CLASS_STD, NMEA_MSG_GGA,  0, 1},
+    {NMEA_CLASS_STD, NMEA_MSG_RMC,  0, 1},
+    {NMEA_CLASS_STD, NMEA_MSG_GSA,  0, 1},
+    {NMEA_CLASS_STD, NMEA_MSG_VTG,  0, 0},  // Speed and course also come with RMC
+    {NMEA_CLASS_STD, NMEA_MSG_GSV,  0, 0},  // Three sentences per epoch, unused
+    {NMEA_CLASS_STD, NMEA_MSG_GLL,  0, 0},
+};
+
+// Module rates tried when its baud is unknown, most likely first
+static const uint32_t s_baud_candidates[] = {
+    GPS_TARGET_BAUD_RATE, GPS_BAUD_RATE, 115200, 57600, 38400, 19200, 9600, 4800,
+};
+
 static TaskHandle_t s_gps_task_handle = NULL;
 
-void gps_sleep(void) {
-    ESP_LOGI(TAG, "GPS: Sending Sleep Command...");
-    if (s_gps_task_handle != NULL) vTaskSuspend(s_gps_task_handle);
+// --- Receiver aiding ---
 
+// Survives deep sleep (RTC timer), unlike esp_timer
+static int64_t rtc_time_us(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
 
-    // 1. SEND SLEEP COMMAND (Backup Mode)
-    // We ask the module to enter Backup Mode immediately.
-    ubx_rxm_pmreq_t pmreq = {0};
-    pmreq.duration = 0;     // Infinite sleep
-    pmreq.flags = 0x02;     // Backup Mode (Force Sleep)
-    send_ubx(0x02, 0x41, (uint8_t*)&pmreq, sizeof(pmreq));
-    
-    // 2. WAIT FOR TX COMPLETE
-    uart_wait_tx_done(GPS_UART_PORT, 200); 
-    
-    // 3. FORCE TX HIGH
+// RTC copy after deep sleep, else the position stored before the power loss
+static void aid_load(void) {
+    if (s_aid.magic == GPS_AID_MAGIC) return;
+
+    gps_aid_t stored;
+    memset(&s_aid, 0, sizeof(s_aid));
+    if (nvs_load_gps_aid(&stored, sizeof(stored)) == ESP_OK &&
+        stored.magic == GPS_AID_MAGIC && stored.has_pos) {
+        // The RTC clock restarted: the time and the position's age are gone
+        s_aid = stored;
+        s_aid.has_time = false;
+        s_aid.dated = false;
+        ESP_LOGI(TAG, "Aiding position loaded from NVS");
+    }
+}
+
+// Start type of this wake; a receiver without its backup state gets the
+// last position (and the time, if the RTC kept counting) with AID-INI
+static gps_start_t aid_receiver(const gps_aid_t *aid) {
+    const int64_t now = rtc_time_us();
+
+    if (!s_state_lost) {
+        bool recent = aid->has_pos && aid->dated &&
+                      now - aid->pos_rtc_us < GPS_EPHEMERIS_MAX_AGE_S * 1000000LL;
+        return recent ? GPS_START_HOT : GPS_START_WARM;
+    }
+    if (!aid->has_pos) return GPS_START_COLD;
+
+    ubx_aid_ini_t ini = {
+        .lat_e7 = aid->lat_e7,
+        .lon_e7 = aid->lon_e7,
+        .pos_acc_cm = GPS_AID_POS_ACC_M * 100u,
+        .flags = UBX_AID_INI_POS | UBX_AID_INI_LLA | UBX_AID_INI_ALT_INV,
+    };
+    if (aid->has_time && now >= aid->time_rtc_us) {
+        int64_t elapsed_ms = (now - aid->time_rtc_us) / 1000;
+        int64_t gps_ms = aid->gps_ms + elapsed_ms;
+        ini.week = (uint16_t)(gps_ms / MS_PER_WEEK);
+        ini.tow_ms = (uint32_t)(gps_ms % MS_PER_WEEK);
+        ini.t_acc_ms = GPS_AID_TIME_ACC_MS + (uint32_t)(elapsed_ms * GPS_AID_RTC_DRIFT_PPM / 1000000);
+        ini.flags |= UBX_AID_INI_TIME;
+    }
+    send_ubx(UBX_CLASS_AID, UBX_AID_INI, (uint8_t*)&ini, sizeof(ini));
+    uart_wait_tx_done(GPS_UART_PORT, pdMS_TO_TICKS(100));
+
+    if (ini.flags & UBX_AID_INI_TIME) {
+        ESP_LOGI(TAG, "AID-INI: position and time (week %u, +-%lu ms)",
+                 ini.week, (unsigned long)ini.t_acc_ms);
+        return GPS_START_AIDED;
+    }
+    ESP_LOGI(TAG, "AID-INI: position only");
+    return GPS_START_AIDED_POS;
+}
+
+const char *gps_start_name(gps_start_t start) {
+    static const char *const names[] = {"none", "hot", "warm", "aided", "aided_pos", "cold"};
+    return (unsigned)start < sizeof(names) / sizeof(names[0]) ? names[start] : "?";
+}
+
+// Park the reader between events instead of suspending it mid-read
+static void park_reader(void) {
+    xSemaphoreTake(s_cfg_mutex, portMAX_DELAY);
+    s_awake = false;
+    xSemaphoreGive(s_cfg_mutex);
+
+    if (s_gps_task_handle != NULL) {
+        uart_event_t park = {.type = GPS_EVENT_PARK};
+        xQueueSendToFront(s_uart_events, &park, portMAX_DELAY);
+        if (xSemaphoreTake(s_parked, pdMS_TO_TICKS(1000)) != pdTRUE) {
+            ESP_LOGW(TAG, "GPS task did not park");
+        }
+    }
+}
+
+// Hold the lines idle so that nothing wakes the module from backup
+static void release_port(void) {
     uart_set_pin(GPS_UART_PORT, -1, -1, -1, -1);
 
     // Drive TX High (Idle state)
@@ -74,12 +369,40 @@ void gps_sleep(void) {
         .intr_type = GPIO_INTR_DISABLE
     };
     gpio_config(&rx_conf);
+}
+
+void gps_sleep(void) {
+    ESP_LOGI(TAG, "GPS: Sending Sleep Command...");
+    park_reader();
+
+    // Position for a wake after a power loss; once per alarm, not per fix
+    if (s_aid_dirty) {
+        esp_err_t err = nvs_save_gps_aid(&s_aid, sizeof(s_aid));
+        if (err == ESP_OK) s_aid_dirty = false;
+        else ESP_LOGW(TAG, "Saving aiding position failed: %s", esp_err_to_name(err));
+    }
+
+
+    // 1. SEND SLEEP COMMAND (Backup Mode)
+    // We ask the module to enter Backup Mode immediately.
+    if (s_applied_valid && s_applied.psm_period_ms > 0) psm_nudge();
+    ubx_rxm_pmreq_t pmreq = {0};
+    pmreq.duration = 0;     // Infinite sleep
+    pmreq.flags = 0x02;     // Backup Mode (Force Sleep)
+    send_ubx(0x02, 0x41, (uint8_t*)&pmreq, sizeof(pmreq));
+    
+    // 2. WAIT FOR TX COMPLETE
+    uart_wait_tx_done(GPS_UART_PORT, 200); 
+    
+    // 3. FORCE TX HIGH
+    release_port();
     
     ESP_LOGI(TAG, "GPS: Sleep Sequence Complete (TX Held High).");
 }
 
 void gps_wake(void) {
     ESP_LOGI(TAG, "GPS: Waking Up...");
+    s_wake_us = esp_timer_get_time();
 
     // 1. RECONNECT UART PINS
     uart_set_pin(GPS_UART_PORT, GPS_TXD_PIN, GPS_RXD_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
@@ -91,15 +414,83 @@ void gps_wake(void) {
     // 3. STABILIZATION DELAY
     // Give the GPS crystal time to stabilize and CPU to boot.
     vTaskDelay(pdMS_TO_TICKS(500));
-    
-    if (s_gps_task_handle != NULL) vTaskResume(s_gps_task_handle);
-    ESP_LOGI(TAG, "GPS Awake.");
+
+    // Output from before the sleep is stale; the reader is still parked
+    rx_discard();
+    gps_aid_t aid = s_aid;
+    s_stats.ttff_ms = 0;
+    s_ttff_pending = true;
+    if (s_gps_task_handle != NULL) xTaskNotifyGive(s_gps_task_handle);
+
+    // 4. RECEIVER CONFIGURATION
+    // Configuration in RAM does not survive a backup without battery power;
+    // a quick poll tells whether it has to be applied again.
+    xSemaphoreTake(s_cfg_mutex, portMAX_DELAY);
+    s_awake = true;
+    if (s_applied_valid && !verify_config()) {
+        ESP_LOGW(TAG, "Receiver configuration lost, re-applying");
+        s_applied_valid = false;
+        s_state_lost = true;
+    }
+    apply_config();
+
+    // 5. AIDING (after the port is at its configured baud)
+    gps_start_t start = aid_receiver(&aid);
+    s_stats.start = start;
+    xSemaphoreGive(s_cfg_mutex);
+    ESP_LOGI(TAG, "GPS Awake (%s start).", gps_start_name(start));
+}
+
+// Text output: only complete sentences are read. Everything buffered is
+// taken when the output is binary, while configuration replies (no '\n')
+// are awaited, when the pattern queue overflowed, or before the ring
+// buffer fills up.
+static size_t rx_ready_len(const uart_event_t *ev) {
+    size_t buffered = 0;
+    uart_get_buffered_data_len(GPS_UART_PORT, &buffered);
+    if (!s_rx_lines || s_cfg_active) return buffered;
+
+    if (ev->type == UART_PATTERN_DET) {
+        int pos = uart_pattern_pop_pos(GPS_UART_PORT);
+        if (pos >= 0) return (size_t)pos + 1;
+        s_stats.pattern_overflows++;
+        return buffered;
+    }
+    return buffered > GPS_RX_BUF_SIZE ? buffered : 0;
+}
+
+static void rx_consume(uint8_t *data, size_t n) {
+    while (n > 0) {
+        int len = uart_read_bytes(GPS_UART_PORT, data, n < GPS_RX_BUF_SIZE ? n : GPS_RX_BUF_SIZE, 0);
+        if (len <= 0) break;
+
+        // Sentences and frames are decoded as the bytes arrive; only
+        // checksum-verified ones are dispatched
+        int64_t start = esp_timer_get_time();
+        gps_stream_feed(&s_stream, data, (size_t)len, handle_message, NULL);
+        s_stats.cpu_us += (uint32_t)(esp_timer_get_time() - start);
+        s_stats.rx_bytes += (uint32_t)len;
+        n -= (size_t)len;
+    }
+}
+
+// Drops everything received so far (overflow, or stale data after a park)
+// Drops buffered input and the '\n' positions that pointed into it. Events
+// already queued stay: they find less (or nothing) to read, and a pending
+// GPS_EVENT_PARK must not be lost.
+static void rx_flush(void) {
+    uart_flush_input(GPS_UART_PORT);
+    uart_pattern_queue_reset(GPS_UART_PORT, GPS_PATTERN_QUEUE_LEN);
+}
+
+// Also clears the event queue; only while gps_task is parked
+static void rx_discard(void) {
+    rx_flush();
+    xQueueReset(s_uart_events);
 }
 
 static void gps_task(void *pvParameters) {
     uint8_t *data = (uint8_t *) malloc(GPS_RX_BUF_SIZE);
-    char line_buffer[128];
-    int line_pos = 0;
 
     if (data == NULL) {
         ESP_LOGE(TAG, "Failed to allocate GPS buffer");
@@ -107,40 +498,69 @@ static void gps_task(void *pvParameters) {
     }
 
     while (1) {
-        // Read data from UART
-        int len = uart_read_bytes(GPS_UART_PORT, data, GPS_RX_BUF_SIZE, 100 / portTICK_PERIOD_MS);
-        
-        if (len > 0) {
-            for (int i = 0; i < len; i++) {
-                char c = (char)data[i];
-                if (c == '\n' || c == '\r') {
-                    if (line_pos > 0) {
-                        line_buffer[line_pos] = '\0';
-                        if (line_buffer[0] == '$') {
-                            parse_nmea_line(line_buffer);
-                        }
-                        line_pos = 0;
-                    }
-                } else {
-                    if (line_pos < sizeof(line_buffer) - 1) {
-                        line_buffer[line_pos++] = c;
-                    } else {
-                        // Buffer overflow protection: discard line
-                        line_pos = 0;
-                    }
-                }
-            }
+        uart_event_t ev;
+        if (xQueueReceive(s_uart_events, &ev, portMAX_DELAY) != pdTRUE) continue;
+        s_stats.rx_events++;
+
+        switch ((int)ev.type) {
+            case UART_DATA:
+            case UART_PATTERN_DET:
+                rx_consume(data, rx_ready_len(&ev));
+                break;
+
+            case UART_FIFO_OVF:
+                // Bytes were lost in hardware; the parsers resynchronise on
+                // the next '$' / B5 62 and checksums reject the cut message
+                s_stats.fifo_overflows++;
+                rx_flush();
+                break;
+
+            case UART_BUFFER_FULL:
+                s_stats.buffer_full++;
+                rx_flush();
+                break;
+
+            case UART_FRAME_ERR:
+            case UART_PARITY_ERR:
+            case UART_BREAK:
+                s_stats.line_errors++;
+                break;
+
+            case GPS_EVENT_PARK:
+                // gps_wake() flushes the input before releasing the task
+                xSemaphoreGive(s_parked);
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                break;
+
+            default:
+                break;
         }
     }
     free(data);
     vTaskDelete(NULL);
 }
 
+// Ingestion strategy for the output protocol
+static void set_rx_lines(bool lines) {
+    if (lines == s_rx_lines) return;
+    if (lines) {
+        uart_enable_pattern_det_baud_intr(GPS_UART_PORT, '\n', 1, 9, 0, 0);
+    } else {
+        uart_disable_pattern_det_intr(GPS_UART_PORT);
+    }
+    uart_pattern_queue_reset(GPS_UART_PORT, GPS_PATTERN_QUEUE_LEN);
+    s_rx_lines = lines;
+}
+
 void gps_init(void) {
-    gps_mutex = xSemaphoreCreateMutex();
+    s_cfg_mutex = xSemaphoreCreateMutex();
+    s_parked = xSemaphoreCreateBinary();
+    s_cfg_replies = xQueueCreate(4, sizeof(cfg_reply_t));
+    gps_stream_init(&s_stream);
+    aid_load();
     
     uart_config_t uart_config = {
-        .baud_rate = GPS_BAUD_RATE,
+        .baud_rate = s_uart_baud,
         .data_bits = UART_DATA_8_BITS,
         .parity    = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
@@ -150,82 +570,564 @@ void gps_init(void) {
 
     ESP_ERROR_CHECK(uart_param_config(GPS_UART_PORT, &uart_config));
     ESP_ERROR_CHECK(uart_set_pin(GPS_UART_PORT, GPS_TXD_PIN, GPS_RXD_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
-    ESP_ERROR_CHECK(uart_driver_install(GPS_UART_PORT, GPS_RX_BUF_SIZE * 2, 0, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_driver_install(GPS_UART_PORT, GPS_RX_BUF_SIZE * 2, 0, GPS_EVENT_QUEUE_LEN, &s_uart_events, 0));
+
+    // A cold module talks NMEA: one event per sentence, plus the idle
+    // timeout for binary replies and frames. A kept configuration may have
+    // switched it to UBX already.
+    ESP_ERROR_CHECK(uart_set_rx_timeout(GPS_UART_PORT, GPS_RX_TIMEOUT_SYMBOLS));
+    ESP_ERROR_CHECK(uart_enable_pattern_det_baud_intr(GPS_UART_PORT, '\n', 1, 9, 0, 0));
+    ESP_ERROR_CHECK(uart_pattern_queue_reset(GPS_UART_PORT, GPS_PATTERN_QUEUE_LEN));
+    set_rx_lines(!(s_applied_valid && s_applied.ubx_output));
 
     // Create the background parsing task
     xTaskCreate(gps_task, "gps_task", GPS_TASK_STACK, NULL, 4, &s_gps_task_handle);
-    ESP_LOGI(TAG, "GPS Initialized.");
 
-    // Allow time for GPS to output first messages before sleeping
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    // Configuration waits for the first gps_wake(), off the boot path.
+    // After a deep sleep the module is still in backup with the state kept
+    // above; after a power-on or restart it may be running.
+    if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED) {
+        park_reader();
+        release_port();
+    } else {
+        gps_sleep();
+    }
+    ESP_LOGI(TAG, "GPS Initialized (%lu baud, configuration %s)", (unsigned long)s_uart_baud,
+             s_applied_valid ? "kept" : "pending");
+}
+
+// Single writer (gps_task)
+static void publish(void) {
+    uint32_t seq = s_pub_seq;
+    s_work.update_time_us = esp_timer_get_time();
+
+    __atomic_store_n(&s_pub_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s_slots[((seq >> 1) + 1) & 1] = s_work;
+    __atomic_store_n(&s_pub_seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+bool gps_read_snapshot(gps_snapshot_t *out, uint32_t *last_fix_seq) {
+    while (1) {
+        uint32_t seq = __atomic_load_n(&s_pub_seq, __ATOMIC_ACQUIRE);
+        *out = s_slots[(seq >> 1) & 1];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        // The slot is rewritten only from half-step (seq | 1) + 2 on
+        uint32_t now = __atomic_load_n(&s_pub_seq, __ATOMIC_RELAXED);
+        if (now - (seq & ~1u) < 3) break;
+    }
+
+    if (last_fix_seq == NULL) return out->fix_seq != 0;
+    bool fresh = out->fix_seq != *last_fix_seq;
+    *last_fix_seq = out->fix_seq;
+    return fresh;
+}
 
-    // STARTUP SLEEP: Put GPS to sleep immediately
-    gps_sleep();
+size_t gps_coord_format(int32_t e7, char *buf, size_t len) {
+    uint32_t mag = e7 < 0 ? (uint32_t)(-(int64_t)e7) : (uint32_t)e7;
+    uint32_t frac = mag % 10000000;
+    int digits = 7;
+    while (digits > 1 && frac % 10 == 0) {
+        frac /= 10;
+        digits--;
+    }
+    int n = snprintf(buf, len, "%s%lu.%0*lu", e7 < 0 ? "-" : "", (unsigned long)(mag / 10000000),
+                     digits, (unsigned long)frac);
+    return n < 0 ? 0 : (size_t)n;
 }
 
 gps_data_t gps_get_coordinates(void) {
-    gps_data_t result;
-    if (xSemaphoreTake(gps_mutex, portMAX_DELAY) == pdTRUE) {
-        result = current_gps_data;
-        xSemaphoreGive(gps_mutex);
+    gps_snapshot_t snap;
+    gps_read_snapshot(&snap, NULL);
+    return snap.data;
+}
+
+void gps_get_stats(gps_stats_t *out) {
+    // Single writer; each counter is read whole
+    *out = s_stats;
+    out->nmea_sentences = s_stream.nmea.stats.sentences;
+    out->ubx_frames = s_stream.ubx.stats.frames;
+    out->checksum_errors = s_stream.nmea.stats.checksum_errors + s_stream.ubx.stats.checksum_errors;
+}
+
+
+// Days since 1970-01-01 of a Gregorian date
+static int32_t days_from_civil(int32_t y, uint32_t m, uint32_t d) {
+    y -= m <= 2;
+    const int32_t era = (y >= 0 ? y : y - 399) / 400;
+    const uint32_t yoe = (uint32_t)(y - era * 400);
+    const uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+}
+
+// GPS time of a valid fix, dated on the RTC clock for time aiding
+static void aid_note_time(int64_t gps_ms) {
+    s_aid.gps_ms = gps_ms;
+    s_aid.time_rtc_us = rtc_time_us();
+    s_aid.has_time = true;
+}
+
+static void aid_note_utc(uint32_t year, uint32_t month, uint32_t day, uint32_t ms_of_day) {
+    if (year < 2000 || month < 1 || month > 12 || day < 1 || day > 31) return;
+    int64_t days = days_from_civil((int32_t)year, month, day) - GPS_EPOCH_UNIX_DAYS;
+    aid_note_time(days * 86400000LL + ms_of_day + GPS_LEAP_SECONDS * 1000LL);
+}
+
+// A new valid position: readers see fix_seq change
+static void commit_position(int32_t lat_e7, int32_t lon_e7, uint32_t h_acc_mm, uint32_t v_acc_mm) {
+    s_work.data.pos.lat_e7 = lat_e7;
+    s_work.data.pos.lon_e7 = lon_e7;
+    s_work.data.h_acc_mm = h_acc_mm;
+    s_work.data.v_acc_mm = v_acc_mm;
+    s_stats.fixes++;
+    s_work.fix_seq++;
+    s_work.fix_time_us = esp_timer_get_time();
+
+    if (s_ttff_pending) {
+        s_stats.ttff_ms = (uint32_t)((s_work.fix_time_us - s_wake_us) / 1000);
+        s_ttff_pending = false;
+    }
+    s_state_lost = false;
+
+    s_aid.lat_e7 = lat_e7;
+    s_aid.lon_e7 = lon_e7;
+    s_aid.pos_rtc_us = rtc_time_us();
+    s_aid.has_pos = true;
+    s_aid.dated = true;
+    s_aid.magic = GPS_AID_MAGIC;
+    s_aid_dirty = true;
+}
+
+static void handle_sentence(nmea_type_t type, const nmea_parser_t *p) {
+    if (type == NMEA_OTHER) return;
+
+    switch (type) {
+        case NMEA_GGA:
+            s_work.data.is_valid = (p->s.gga.fix_quality > 0) && p->s.gga.has_pos;
+            s_work.data.satellites = p->s.gga.satellites;
+            s_work.data.hdop_x100 = p->s.gga.hdop_x100;
+            if (s_work.data.is_valid) {
+                commit_position(p->s.gga.lat_e7, p->s.gga.lon_e7, 0, 0);
+            }
+            break;
+
+        case NMEA_RMC:
+            // 'V' = receiver warning, the position is not usable
+            if (!p->s.rmc.active) {
+                s_work.data.is_valid = false;
+                break;
+            }
+            s_work.data.speed_mm_s = p->s.rmc.speed_mm_s;
+            if (p->s.rmc.has_course) s_work.data.course_e2 = p->s.rmc.course_e2;
+            // ddmmyy, two-digit year
+            aid_note_utc(2000 + p->s.rmc.date % 100, p->s.rmc.date / 100 % 100,
+                         p->s.rmc.date / 10000, p->s.rmc.time_ms);
+            break;
+
+        case NMEA_VTG:
+            if (p->s.vtg.has_speed) s_work.data.speed_mm_s = p->s.vtg.speed_mm_s;
+            if (p->s.vtg.has_course) s_work.data.course_e2 = p->s.vtg.course_e2;
+            break;
+
+        case NMEA_GSA:
+            s_work.data.fix_type = p->s.gsa.fix_type;
+            break;
+
+        default:
+            break;
+    }
+    publish();
+}
+
+// UBX gpsFix -> GSA style fix type
+static uint8_t ubx_fix_type(uint8_t gps_fix) {
+    if (gps_fix == UBX_FIX_2D) return 2;
+    if (gps_fix == UBX_FIX_3D || gps_fix == UBX_FIX_GPS_DR) return 3;
+    return 1;
+}
+
+// Degrees * 1e5 (any sign) -> 0..35999 degrees * 100
+static uint16_t heading_e5_to_e2(int32_t heading_e5) {
+    int32_t h = heading_e5 % 36000000;
+    if (h < 0) h += 36000000;
+    return (uint16_t)(h / 1000);
+}
+
+static bool ubx_fix_ok(uint8_t gps_fix, uint8_t flags) {
+    return (flags & 0x01) && gps_fix >= UBX_FIX_2D && gps_fix <= UBX_FIX_GPS_DR;
+}
+
+// ACKs and CFG poll replies go to whoever is configuring the receiver
+static void post_cfg_reply(ubx_type_t type, const ubx_parser_t *p) {
+    cfg_reply_t r = {0};
+    if (type == UBX_OTHER) {
+        r.kind = CFG_REPLY_POLL;
+        r.cls = p->msg_class;
+        r.id = p->msg_id;
+        r.len = (uint8_t)(p->length < CFG_REPLY_MAX ? p->length : CFG_REPLY_MAX);
+        memcpy(r.payload, p->payload, r.len);
     } else {
-        memset(&result, 0, sizeof(result));
+        r.kind = (type == UBX_ACK) ? CFG_REPLY_ACK : CFG_REPLY_NAK;
+        r.cls = p->m.ack.cls;
+        r.id = p->m.ack.id;
     }
-    return result;
+    xQueueSend(s_cfg_replies, &r, 0);
 }
 
+static void handle_frame(ubx_type_t type, const ubx_parser_t *p) {
+    if (type == UBX_ACK || type == UBX_NAK ||
+        (type == UBX_OTHER && p->msg_class == UBX_CLASS_CFG)) {
+        post_cfg_reply(type, p);
+        return;
+    }
 
-static void parse_nmea_line(char *line) {
-    if (strstr(line, "GGA") == NULL) return;
+    switch (type) {
+        case UBX_POSLLH: s_posllh = p->m.posllh; break;
+        case UBX_SOL:    s_sol = p->m.sol; break;
+        case UBX_VELNED:
+        case UBX_PVT:    break;
+        default:         return;
+    }
 
-    char *token;
-    char *rest = line;
-    int field_index = 0;
-    
-    // Temporary storage for parsing
-    float lat_raw = 0.0;
-    float lon_raw = 0.0;
-    char lat_dir = 0; 
-    char lon_dir = 0;
-    int fix_quality = 0;
-    int sats = 0;
-
-    // Standard NMEA splitting by comma
-    while ((token = strtok_r(rest, ",", &rest))) {
-        switch (field_index) {
-            case 2: lat_raw = atof(token); break;
-            case 3: lat_dir = token[0]; break;
-            case 4: lon_raw = atof(token); break;
-            case 5: lon_dir = token[0]; break;
-            case 6: fix_quality = atoi(token); break;
-            case 7: sats = atoi(token); break;
+    switch (type) {
+        case UBX_POSLLH:
+        case UBX_SOL:
+            // NAV-SOL says whether the fix is usable, NAV-POSLLH carries it;
+            // the epoch is committed once both of the same iTOW are in
+            if (type == UBX_SOL) {
+                s_work.data.is_valid = ubx_fix_ok(s_sol.gps_fix, s_sol.flags);
+                s_work.data.fix_type = ubx_fix_type(s_sol.gps_fix);
+                s_work.data.satellites = s_sol.num_sv;
+            }
+            if (s_work.data.is_valid && s_posllh.itow_ms == s_sol.itow_ms &&
+                s_committed_itow != s_sol.itow_ms) {
+                commit_position(s_posllh.lat_e7, s_posllh.lon_e7, s_posllh.h_acc_mm, s_posllh.v_acc_mm);
+                s_committed_itow = s_sol.itow_ms;
+                // Week and TOW valid
+                if ((s_sol.flags & 0x0C) == 0x0C) {
+                    aid_note_time(s_sol.week * MS_PER_WEEK + s_sol.itow_ms);
+                }
+            }
+            break;
+
+        case UBX_VELNED:
+            s_work.data.speed_mm_s = p->m.velned.g_speed_cm_s * 10;
+            s_work.data.course_e2 = heading_e5_to_e2(p->m.velned.heading_e5);
+            break;
+
+        case UBX_PVT: {
+            const ubx_nav_pvt_t *pvt = &p->m.pvt;
+            s_work.data.is_valid = ubx_fix_ok(pvt->fix_type, pvt->flags);
+            s_work.data.fix_type = ubx_fix_type(pvt->fix_type);
+            s_work.data.satellites = pvt->num_sv;
+            s_work.data.speed_mm_s = pvt->g_speed_mm_s > 0 ? (uint32_t)pvt->g_speed_mm_s : 0;
+            s_work.data.course_e2 = heading_e5_to_e2(pvt->head_mot_e5);
+            if (s_work.data.is_valid) {
+                commit_position(pvt->lat_e7, pvt->lon_e7, pvt->h_acc_mm, pvt->v_acc_mm);
+                // UTC date and time valid
+                if ((pvt->valid & 0x03) == 0x03) {
+                    aid_note_utc(pvt->year, pvt->month, pvt->day,
+                                 ((pvt->hour * 60u + pvt->min) * 60u + pvt->sec) * 1000u);
+                }
+            }
+            break;
         }
-        field_index++;
+
+        default:
+            break;
     }
+    publish();
+}
+
+static void handle_message(void *ctx, const gps_stream_t *s, nmea_type_t nmea, ubx_type_t ubx) {
+    (void)ctx;
+    if (nmea != NMEA_NONE) handle_sentence(nmea, &s->nmea);
+    else handle_frame(ubx, &s->ubx);
+}
 
-    // Update global state safely
-    if (xSemaphoreTake(gps_mutex, 100 / portTICK_PERIOD_MS) == pdTRUE) {
-        current_gps_data.is_valid = (fix_quality > 0);
-        current_gps_data.satellites = (uint8_t)sats;
-        
-        if (current_gps_data.is_valid) {
-            current_gps_data.latitude = nmea_to_decimal(lat_raw, lat_dir);
-            current_gps_data.longitude = nmea_to_decimal(lon_raw, lon_dir);
+// --- Receiver configuration engine (caller holds s_cfg_mutex) ---
+
+// Sends a CFG message and waits for its ACK. With `poll` set the message is
+// a poll request; the module answers with the CFG message, then the ACK.
+static esp_err_t ubx_transact(uint8_t id, const void *payload, uint16_t len, cfg_reply_t *poll, int attempts) {
+    const TickType_t timeout = pdMS_TO_TICKS(GPS_ACK_TIMEOUT_MS);
+
+    for (int attempt = 0; attempt < attempts; attempt++) {
+        xQueueReset(s_cfg_replies);
+        send_ubx(UBX_CLASS_CFG, id, (uint8_t*)payload, len);
+
+        bool polled = false;
+        TickType_t start = xTaskGetTickCount();
+        cfg_reply_t r;
+        while (1) {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= timeout || xQueueReceive(s_cfg_replies, &r, timeout - elapsed) != pdTRUE) break;
+            if (r.cls != UBX_CLASS_CFG || r.id != id) continue;
+
+            if (r.kind == CFG_REPLY_POLL) {
+                if (poll != NULL) {
+                    *poll = r;
+                    polled = true;
+                }
+            } else if (r.kind == CFG_REPLY_NAK) {
+                return ESP_ERR_NOT_SUPPORTED;
+            } else if (poll == NULL || polled) {
+                return ESP_OK;
+            }
         }
-        xSemaphoreGive(gps_mutex);
     }
+    return ESP_ERR_TIMEOUT;
 }
 
-static float nmea_to_decimal(float nmea_coord, char quadrant) {
-    // DDMM.MMMM -> DD.DDDD
-    int degrees = (int)(nmea_coord / 100);
-    float minutes = nmea_coord - (degrees * 100);
-    float decimal = degrees + (minutes / 60.0f);
-    
-    if (quadrant == 'S' || quadrant == 'W') {
-        decimal *= -1.0f;
+static esp_err_t cfg_poll(uint8_t id, const void *request, uint16_t len, void *out, size_t out_len, int attempts) {
+    cfg_reply_t r;
+    esp_err_t err = ubx_transact(id, request, len, &r, attempts);
+    if (err != ESP_OK) return err;
+    if (r.len < out_len) return ESP_ERR_INVALID_SIZE;
+    memcpy(out, r.payload, out_len);
+    return ESP_OK;
+}
+
+static uint16_t out_proto_mask(const gps_receiver_config_t *cfg) {
+    return cfg->ubx_output ? UBX_PROTO_UBX : (UBX_PROTO_UBX | UBX_PROTO_NMEA);
+}
+
+static esp_err_t poll_port(ubx_cfg_prt_t *prt, int attempts) {
+    uint8_t port = UBX_PRT_UART1;
+    return cfg_poll(UBX_CFG_PRT, &port, sizeof(port), prt, sizeof(*prt), attempts);
+}
+
+// Finds the module's current baud with a CFG-PRT poll at each candidate
+static esp_err_t sync_baud(void) {
+    for (size_t i = 0; i < sizeof(s_baud_candidates) / sizeof(s_baud_candidates[0]); i++) {
+        uart_set_baudrate(GPS_UART_PORT, s_baud_candidates[i]);
+        s_uart_baud = s_baud_candidates[i];
+        vTaskDelay(pdMS_TO_TICKS(20));
+
+        ubx_cfg_prt_t prt;
+        if (poll_port(&prt, 1) == ESP_OK) {
+            // Still at our baud: the backup state survived. A module reset
+            // to its default rate has lost it (indistinguishable if the
+            // target is the default rate).
+            s_state_lost = prt.baud_rate != s_wanted.baud_rate;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+// Output protocol and baud on UART1. After a baud change the ACK may be
+// lost in the switch, so our UART follows and a poll at the new rate
+// confirms the result.
+static esp_err_t apply_port(const gps_receiver_config_t *cfg) {
+    ubx_cfg_prt_t prt = {
+        .port_id = UBX_PRT_UART1,
+        .mode = UBX_PRT_MODE_8N1,
+        .baud_rate = cfg->baud_rate,
+        .in_proto_mask = UBX_PROTO_UBX | UBX_PROTO_NMEA,
+        .out_proto_mask = out_proto_mask(cfg),
+    };
+
+    if (cfg->baud_rate == s_uart_baud) {
+        esp_err_t err = ubx_transact(UBX_CFG_PRT, &prt, sizeof(prt), NULL, GPS_CFG_ATTEMPTS);
+        if (err != ESP_OK) return err;
+    } else {
+        send_ubx(UBX_CLASS_CFG, UBX_CFG_PRT, (uint8_t*)&prt, sizeof(prt));
+        uart_wait_tx_done(GPS_UART_PORT, pdMS_TO_TICKS(200));
+        vTaskDelay(pdMS_TO_TICKS(50));
+        uart_set_baudrate(GPS_UART_PORT, cfg->baud_rate);
+        s_uart_baud = cfg->baud_rate;
+    }
+
+    ubx_cfg_prt_t now;
+    esp_err_t err = poll_port(&now, GPS_CFG_ATTEMPTS);
+    if (err != ESP_OK) return err;
+    if (now.baud_rate != cfg->baud_rate || now.out_proto_mask != prt.out_proto_mask) return ESP_ERR_INVALID_STATE;
+    return ESP_OK;
+}
+
+static esp_err_t apply_messages(const gps_receiver_config_t *cfg) {
+    for (size_t i = 0; i < sizeof(s_messages) / sizeof(s_messages[0]); i++) {
+        ubx_cfg_msg_t msg = {
+            .msg_class = s_messages[i].cls,
+            .msg_id = s_messages[i].id,
+            .rate = cfg->ubx_output ? s_messages[i].ubx_rate : s_messages[i].nmea_rate,
+        };
+        esp_err_t err = ubx_transact(UBX_CFG_MSG, &msg, sizeof(msg), NULL, GPS_CFG_ATTEMPTS);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "CFG-MSG %02X-%02X: %s", msg.msg_class, msg.msg_id, esp_err_to_name(err));
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t apply_rate(const gps_receiver_config_t *cfg) {
+    ubx_cfg_rate_t rate = {.meas_rate_ms = cfg->nav_rate_ms, .nav_rate = 1, .time_ref = 1};
+    esp_err_t err = ubx_transact(UBX_CFG_RATE, &rate, sizeof(rate), NULL, GPS_CFG_ATTEMPTS);
+    if (err != ESP_OK) return err;
+
+    ubx_cfg_rate_t now;
+    err = cfg_poll(UBX_CFG_RATE, NULL, 0, &now, sizeof(now), GPS_CFG_ATTEMPTS);
+    if (err == ESP_OK && now.meas_rate_ms != cfg->nav_rate_ms) err = ESP_ERR_INVALID_STATE;
+    return err;
+}
+
+// Power save: CFG-PM2 with the update period, then CFG-RXM switches the
+// mode. Continuous tracking only needs CFG-RXM.
+static esp_err_t apply_power(const gps_receiver_config_t *cfg) {
+    esp_err_t err;
+    if (cfg->psm_period_ms > 0) {
+        ubx_cfg_pm2_t pm2 = {
+            .version = 1,
+            .flags = UBX_PM2_UPDATE_RTC | UBX_PM2_UPDATE_EPH,
+            .update_period_ms = cfg->psm_period_ms,
+            .search_period_ms = GPS_PSM_SEARCH_MS,
+            .on_time_s = GPS_PSM_ON_TIME_S,
+        };
+        err = ubx_transact(UBX_CFG_PM2, &pm2, sizeof(pm2), NULL, GPS_CFG_ATTEMPTS);
+        if (err != ESP_OK) return err;
+
+        ubx_cfg_pm2_t now;
+        err = cfg_poll(UBX_CFG_PM2, NULL, 0, &now, sizeof(now), GPS_CFG_ATTEMPTS);
+        if (err == ESP_OK && now.update_period_ms != pm2.update_period_ms) return ESP_ERR_INVALID_STATE;
+        if (err != ESP_OK) return err;
+    }
+
+    ubx_cfg_rxm_t rxm = {
+        .reserved1 = 8,
+        .lp_mode = cfg->psm_period_ms > 0 ? UBX_RXM_POWER_SAVE : UBX_RXM_CONTINUOUS,
+    };
+    err = ubx_transact(UBX_CFG_RXM, &rxm, sizeof(rxm), NULL, GPS_CFG_ATTEMPTS);
+    if (err != ESP_OK) return err;
+
+    ubx_cfg_rxm_t now;
+    err = cfg_poll(UBX_CFG_RXM, NULL, 0, &now, sizeof(now), GPS_CFG_ATTEMPTS);
+    if (err == ESP_OK && now.lp_mode != rxm.lp_mode) err = ESP_ERR_INVALID_STATE;
+    return err;
+}
+
+static esp_err_t apply_nav5(const gps_receiver_config_t *cfg) {
+    ubx_cfg_nav5_t nav5 = {.mask = UBX_NAV5_MASK_DYN, .dyn_model = (uint8_t)cfg->dyn_model};
+    esp_err_t err = ubx_transact(UBX_CFG_NAV5, &nav5, sizeof(nav5), NULL, GPS_CFG_ATTEMPTS);
+    if (err != ESP_OK) return err;
+
+    ubx_cfg_nav5_t now;
+    err = cfg_poll(UBX_CFG_NAV5, NULL, 0, &now, sizeof(now), GPS_CFG_ATTEMPTS);
+    if (err == ESP_OK && now.dyn_model != nav5.dyn_model) err = ESP_ERR_INVALID_STATE;
+    return err;
+}
+
+// Brings the module to s_wanted. Only the parts that differ from the
+// confirmed configuration are sent; without one, the baud is searched first
+// and everything is applied.
+static esp_err_t apply_config(void) {
+    if (!s_awake) return ESP_OK;     // Applied on wake
+
+    const gps_receiver_config_t *cfg = &s_wanted;
+    const bool full = !s_applied_valid;
+    if (!full && s_applied.psm_period_ms > 0) psm_nudge();
+    s_cfg_active = true;
+    const char *step = "baud sync";
+    esp_err_t err = full ? sync_baud() : ESP_OK;
+
+    if (err == ESP_OK && (full || cfg->baud_rate != s_applied.baud_rate || cfg->ubx_output != s_applied.ubx_output)) {
+        step = "CFG-PRT";
+        err = apply_port(cfg);
+    }
+    if (err == ESP_OK && (full || cfg->ubx_output != s_applied.ubx_output)) {
+        step = "CFG-MSG";
+        err = apply_messages(cfg);
+    }
+    if (err == ESP_OK && (full || cfg->nav_rate_ms != s_applied.nav_rate_ms)) {
+        step = "CFG-RATE";
+        err = apply_rate(cfg);
+    }
+    if (err == ESP_OK && (full || cfg->dyn_model != s_applied.dyn_model)) {
+        step = "CFG-NAV5";
+        err = apply_nav5(cfg);
+    }
+    if (err == ESP_OK && (full || cfg->psm_period_ms != s_applied.psm_period_ms)) {
+        step = "CFG-RXM";
+        err = apply_power(cfg);
+    }
+
+    s_applied_valid = (err == ESP_OK);
+    s_cfg_active = false;
+    if (err == ESP_OK) {
+        s_applied = *cfg;
+        set_rx_lines(!cfg->ubx_output);
+    } else {
+        s_stats.cfg_errors++;
+        ESP_LOGE(TAG, "Receiver configuration failed at %s: %s", step, esp_err_to_name(err));
+    }
+    return err;
+}
+
+// Polls port, rate, dynamic model and power mode and compares them with
+// s_applied
+static bool verify_config(void) {
+    ubx_cfg_prt_t prt;
+    ubx_cfg_rate_t rate;
+    ubx_cfg_nav5_t nav5;
+    ubx_cfg_rxm_t rxm;
+
+    s_cfg_active = true;
+    bool ok = poll_port(&prt, GPS_CFG_ATTEMPTS) == ESP_OK &&
+           prt.baud_rate == s_applied.baud_rate && prt.out_proto_mask == out_proto_mask(&s_applied) &&
+           cfg_poll(UBX_CFG_RATE, NULL, 0, &rate, sizeof(rate), GPS_CFG_ATTEMPTS) == ESP_OK &&
+           rate.meas_rate_ms == s_applied.nav_rate_ms &&
+           cfg_poll(UBX_CFG_NAV5, NULL, 0, &nav5, sizeof(nav5), GPS_CFG_ATTEMPTS) == ESP_OK &&
+           nav5.dyn_model == (uint8_t)s_applied.dyn_model &&
+           cfg_poll(UBX_CFG_RXM, NULL, 0, &rxm, sizeof(rxm), GPS_CFG_ATTEMPTS) == ESP_OK &&
+           rxm.lp_mode == (s_applied.psm_period_ms > 0 ? UBX_RXM_POWER_SAVE : UBX_RXM_CONTINUOUS);
+    s_cfg_active = false;
+    return ok;
+}
+
+esp_err_t gps_configure(const gps_receiver_config_t *cfg) {
+    if (cfg == NULL || cfg->nav_rate_ms < 100) return ESP_ERR_INVALID_ARG;
+    if (cfg->psm_period_ms > 0 && (cfg->psm_period_ms < 1000 || cfg->psm_period_ms % cfg->nav_rate_ms != 0)) {
+        return ESP_ERR_INVALID_ARG;
     }
-    return decimal;
+    xSemaphoreTake(s_cfg_mutex, portMAX_DELAY);
+    s_wanted = *cfg;
+    esp_err_t err = apply_config();
+    xSemaphoreGive(s_cfg_mutex);
+    return err;
+}
+
+esp_err_t gps_set_nav_rate(uint16_t period_ms) {
+    xSemaphoreTake(s_cfg_mutex, portMAX_DELAY);
+    gps_receiver_config_t cfg = s_wanted;
+    xSemaphoreGive(s_cfg_mutex);
+    cfg.nav_rate_ms = period_ms;
+    return gps_configure(&cfg);
+}
+
+esp_err_t gps_set_power_save(uint32_t period_ms) {
+    xSemaphoreTake(s_cfg_mutex, portMAX_DELAY);
+    gps_receiver_config_t cfg = s_wanted;
+    xSemaphoreGive(s_cfg_mutex);
+    cfg.psm_period_ms = period_ms;
+    return gps_configure(&cfg);
+}
+
+void gps_get_config(gps_receiver_config_t *out) {
+    xSemaphoreTake(s_cfg_mutex, portMAX_DELAY);
+    *out = s_wanted;
+    xSemaphoreGive(s_cfg_mutex);
+}
+
+// In power save the receiver spends most of the time off and only wakes on
+// UART activity; the first bytes are lost, so send filler and let it start
+static void psm_nudge(void) {
+    uint8_t wake_bytes[] = {0xFF, 0xFF, 0xFF, 0xFF};
+    uart_write_bytes(GPS_UART_PORT, (const char*)wake_bytes, sizeof(wake_bytes));
+    uart_wait_tx_done(GPS_UART_PORT, pdMS_TO_TICKS(50));
+    vTaskDelay(pdMS_TO_TICKS(100));
 }
 
 static void send_ubx(uint8_t cls, uint8_t id, uint8_t *payload, uint16_t length) {
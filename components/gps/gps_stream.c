@@ -0,0 +1,34 @@
+#include "gps_stream.h"
+#include <string.h>
+
+void gps_stream_init(gps_stream_t *s) {
+    nmea_parser_init(&s->nmea);
+    ubx_parser_init(&s->ubx);
+}
+
+void gps_stream_feed(gps_stream_t *s, const uint8_t *data, size_t len, gps_stream_cb_t cb, void *ctx) {
+    size_t i = 0;
+    while (i < len) {
+        if (ubx_parser_in_frame(&s->ubx)) {
+            ubx_type_t type;
+            i += ubx_parser_feed_buf(&s->ubx, data + i, len - i, &type);
+            if (type != UBX_NONE) cb(ctx, s, NMEA_NONE, type);
+            continue;
+        }
+
+        // Text up to the next possible frame start
+        const uint8_t *sync = memchr(data + i, UBX_SYNC_1, len - i);
+        size_t end = sync ? (size_t)(sync - data) : len;
+        while (i < end) {
+            nmea_type_t type;
+            i += nmea_parser_feed_buf(&s->nmea, data + i, end - i, &type);
+            if (type != NMEA_NONE) cb(ctx, s, type, UBX_NONE);
+        }
+        if (i < len) {
+            // Not text: ends a sentence in progress and may start a frame
+            nmea_parser_feed(&s->nmea, data[i]);
+            ubx_parser_feed(&s->ubx, data[i]);
+            i++;
+        }
+    }
+}
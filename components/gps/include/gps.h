@@ -7,17 +7,88 @@
 #define GPS_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include "esp_err.h"
+
+// Position in 1e-7 degrees, negative = S / W. Same scale as UBX and as the
+// parsers produce it: 1 LSB is 1.1 cm of latitude, no float rounding.
+typedef struct {
+    int32_t lat_e7;
+    int32_t lon_e7;
+} gps_coord_t;
+
+#define GPS_COORD_STR_MAX   (13)    // "-179.1234567" + NUL
 
 
 // Data structure to hold parsed GPS information
 typedef struct {
-    float latitude;      // Decimal degrees (e.g., 48.8588)
-    float longitude;     // Decimal degrees (e.g., 2.2943)
+    gps_coord_t pos;     // Last valid position (e.g., 488588000, 22943000)
     bool is_valid;       // True only if GPS has a valid fix
     uint8_t satellites;  // Number of satellites currently tracked
+    uint8_t fix_type;    // 1 = none, 2 = 2D, 3 = 3D (GSA)
+    uint16_t hdop_x100;  // Horizontal dilution of precision * 100
+    uint16_t course_e2;  // Course over ground, degrees * 100
+    uint32_t speed_mm_s; // Speed over ground
+    uint32_t h_acc_mm;   // Estimated horizontal accuracy (UBX only, 0 = unknown)
+    uint32_t v_acc_mm;   // Estimated vertical accuracy (UBX only, 0 = unknown)
 } gps_data_t;
 
+// Published GPS state. fix_seq increases with every new valid position, so
+// a reader can tell whether the fix is new since its last read.
+typedef struct {
+    gps_data_t data;
+    uint32_t fix_seq;         // 0 = no fix since boot
+    int64_t fix_time_us;      // esp_timer time the current position arrived
+    int64_t update_time_us;   // esp_timer time of the last change of any field
+} gps_snapshot_t;
+
+// What the receiver started from on the last gps_wake()
+typedef enum {
+    GPS_START_NONE = 0,       // Not woken yet
+    GPS_START_HOT,            // Backup state kept, last fix recent (ephemeris valid)
+    GPS_START_WARM,           // Backup state kept, last fix older than the ephemeris
+    GPS_START_AIDED,          // State lost, last position and time injected (AID-INI)
+    GPS_START_AIDED_POS,      // State lost, only the last position injected
+    GPS_START_COLD,           // State lost, nothing known
+} gps_start_t;
+
+// UART ingestion counters since gps_init()
+typedef struct {
+    uint32_t rx_bytes;        // Bytes received from the module
+    uint32_t cpu_us;          // Time spent parsing and publishing
+    uint32_t fixes;           // Valid positions published
+    uint32_t nmea_sentences;  // Verified NMEA sentences
+    uint32_t ubx_frames;      // Verified UBX frames
+    uint32_t checksum_errors; // Both protocols
+    uint32_t cfg_errors;      // Receiver configurations that failed
+    uint32_t rx_events;       // UART driver events handled (task wake-ups)
+    uint32_t fifo_overflows;  // Hardware FIFO overrun, input discarded
+    uint32_t buffer_full;     // Driver ring buffer full, input discarded
+    uint32_t pattern_overflows; // '\n' positions lost, buffered input read whole
+    uint32_t line_errors;     // Framing, parity and break conditions
+    gps_start_t start;        // Start type of the last wake
+    uint32_t ttff_ms;         // Last wake to its first valid fix, 0 = no fix yet
+} gps_stats_t;
+
+// UBX-CFG-NAV5 dynamic platform models (u-blox 6)
+typedef enum {
+    GPS_DYN_PORTABLE = 0,
+    GPS_DYN_STATIONARY = 2,
+    GPS_DYN_PEDESTRIAN = 3,   // Up to 30 m/s, bike speeds
+    GPS_DYN_AUTOMOTIVE = 4,   // Up to 100 m/s
+} gps_dyn_model_t;
+
+// Declared receiver configuration, applied with UBX-CFG and verified by
+// ACK and read-back. Kept across sleep and re-applied on wake if lost.
+typedef struct {
+    uint32_t baud_rate;         // Module and ESP32 UART
+    uint16_t nav_rate_ms;       // Navigation solution period (>= 100)
+    gps_dyn_model_t dyn_model;
+    bool ubx_output;            // UBX-NAV messages instead of NMEA sentences
+    uint32_t psm_period_ms;     // Power save fix period (CFG-PM2), 0 = continuous tracking
+} gps_receiver_config_t;
+
 /**
  * @brief Initialize UART and start the background parsing task.
  * * @note Configures UART2 on GPIO 17 (TX) and GPIO 16 (RX) by default.
@@ -30,6 +101,58 @@ void gps_init(void);
  */
 gps_data_t gps_get_coordinates(void);
 
+/**
+ * @brief Format 1e-7 degrees as exact decimal degrees, trailing zeros
+ * dropped ("50.0619835", "19.5"). No floating point.
+ * @return Characters written (without NUL).
+ */
+size_t gps_coord_format(int32_t e7, char *buf, size_t len);
+
+/**
+ * @brief Copy the latest published state without locking; never blocks the
+ * parser and only retries if the state was republished twice meanwhile.
+ * @param last_fix_seq fix_seq seen by the previous read, updated; NULL to
+ *        only ask whether there is a fix at all.
+ * @return true if the position is new since *last_fix_seq.
+ */
+bool gps_read_snapshot(gps_snapshot_t *out, uint32_t *last_fix_seq);
+
+/**
+ * @brief Apply a receiver configuration: only what differs from the last
+ * confirmed one is sent, each change waits for ACK-ACK and is read back.
+ * While the module sleeps the configuration is stored and applied on wake.
+ * @return ESP_ERR_NOT_SUPPORTED on ACK-NAK, ESP_ERR_TIMEOUT without reply,
+ *         ESP_ERR_INVALID_STATE if the read-back differs.
+ */
+esp_err_t gps_configure(const gps_receiver_config_t *cfg);
+
+/**
+ * @brief Change only the navigation rate of the current configuration.
+ */
+esp_err_t gps_set_nav_rate(uint16_t period_ms);
+
+/**
+ * @brief Switch the receiver to power save mode (UBX-CFG-PM2/CFG-RXM) with
+ * one fix per period_ms, or back to continuous tracking with 0. Periods
+ * over 10 s run ON/OFF: the receiver wakes shortly before each fix and is
+ * off in between; shorter ones run cyclic tracking. The period must be a
+ * multiple of the navigation rate.
+ */
+esp_err_t gps_set_power_save(uint32_t period_ms);
+
+void gps_get_config(gps_receiver_config_t *out);
+
+/**
+ * @brief Copy the ingestion counters (bytes and CPU per fix = rx_bytes /
+ * fixes and cpu_us / fixes).
+ */
+void gps_get_stats(gps_stats_t *out);
+
+/**
+ * @brief Short name of a start type ("hot", "aided", ...).
+ */
+const char *gps_start_name(gps_start_t start);
+
 /**
  * @brief Send UBX command to put the module into low-power Backup Mode.
  * * @note Current consumption drops to ~500uA. 
@@ -37,7 +160,10 @@ gps_data_t gps_get_coordinates(void);
 void gps_sleep(void);
 
 /**
- * @brief Wake the module from sleep by generating UART activity.
+ * @brief Wake the module from sleep by generating UART activity. If the
+ * receiver lost its backup state, the last fix and the time carried by the
+ * RTC (or the position stored in NVS) are injected with UBX-AID-INI.
+ * Time to the first fix is reported in gps_stats_t.
  */
 void gps_wake(void);
 
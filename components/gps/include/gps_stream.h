@@ -0,0 +1,38 @@
+/*
+ * gps_stream.h
+ * Splits the receiver's UART stream between the NMEA and UBX parsers.
+ *
+ * While the module is being switched between protocols both kinds of output
+ * arrive interleaved. Text up to the next UBX sync byte goes to the NMEA
+ * parser, frames go to the UBX parser, and a sync byte in the middle of a
+ * sentence cuts that sentence off. No ESP-IDF dependencies.
+ */
+
+#ifndef GPS_STREAM_H
+#define GPS_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "nmea_parser.h"
+#include "ubx_parser.h"
+
+typedef struct {
+    nmea_parser_t nmea;
+    ubx_parser_t ubx;
+} gps_stream_t;
+
+/**
+ * @brief Called for every verified sentence or frame; exactly one of the
+ * two types is not NONE. The decoded fields are in s->nmea.s / s->ubx.m.
+ */
+typedef void (*gps_stream_cb_t)(void *ctx, const gps_stream_t *s, nmea_type_t nmea, ubx_type_t ubx);
+
+void gps_stream_init(gps_stream_t *s);
+
+/**
+ * @brief Feed a block of received bytes; messages split across blocks are
+ * completed by later calls.
+ */
+void gps_stream_feed(gps_stream_t *s, const uint8_t *data, size_t len, gps_stream_cb_t cb, void *ctx);
+
+#endif // GPS_STREAM_H
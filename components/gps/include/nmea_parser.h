@@ -0,0 +1,128 @@
+/*
+ * nmea_parser.h
+ * Byte-at-a-time NMEA 0183 parser.
+ *
+ * Fields are decoded as the bytes arrive, straight into the sentence struct:
+ * no line buffer, no string functions, no floating point. A sentence is only
+ * reported once its *hh checksum matched, so a corrupted line never reaches
+ * the caller. Empty fields keep their position (",,"), unlike strtok.
+ * No ESP-IDF dependencies - the same code runs in host tests and benchmarks.
+ */
+
+#ifndef NMEA_PARSER_H
+#define NMEA_PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NMEA_MAX_SENTENCE   (120)   // '$' to checksum; NMEA allows 82, u-blox PUBX runs longer
+
+typedef enum {
+    NMEA_NONE = 0,      // No complete sentence yet
+    NMEA_GGA,           // Fix data
+    NMEA_RMC,           // Recommended minimum
+    NMEA_VTG,           // Course and speed over ground
+    NMEA_GSA,           // DOP and active satellites
+    NMEA_OTHER,         // Valid checksum, type not decoded
+} nmea_type_t;
+
+// Coordinates in 1e-7 degrees (same scale as UBX), negative = S / W
+typedef struct {
+    uint32_t time_ms;       // UTC time of day
+    int32_t lat_e7;
+    int32_t lon_e7;
+    int32_t alt_mm;         // Above mean sea level
+    uint16_t hdop_x100;
+    uint8_t fix_quality;    // 0 = none, 1 = GPS, 2 = DGPS, 6 = dead reckoning
+    uint8_t satellites;
+    bool has_pos;
+    bool has_alt;
+} nmea_gga_t;
+
+typedef struct {
+    uint32_t time_ms;
+    uint32_t date;          // ddmmyy as a number
+    int32_t lat_e7;
+    int32_t lon_e7;
+    uint32_t speed_mm_s;
+    uint16_t course_e2;     // Degrees * 100, true north
+    bool active;            // Status 'A'
+    bool has_pos;
+    bool has_course;
+} nmea_rmc_t;
+
+typedef struct {
+    uint32_t speed_mm_s;
+    uint16_t course_e2;
+    bool has_speed;
+    bool has_course;
+} nmea_vtg_t;
+
+typedef struct {
+    uint16_t pdop_x100;
+    uint16_t hdop_x100;
+    uint16_t vdop_x100;
+    uint8_t fix_type;       // 1 = none, 2 = 2D, 3 = 3D
+    uint8_t sats_used;
+} nmea_gsa_t;
+
+typedef struct {
+    uint32_t sentences;     // Valid sentences of any type
+    uint32_t checksum_errors;
+    uint32_t overflows;     // Longer than NMEA_MAX_SENTENCE
+    uint32_t malformed;     // Missing checksum or bad characters
+} nmea_stats_t;
+
+// Field being accumulated (fixed point, up to 7 fraction digits)
+typedef struct {
+    uint32_t ip;
+    uint32_t frac;
+    uint8_t frac_digits;
+    char ch;                // First non-numeric character
+    bool dot;
+    bool neg;
+    bool empty;
+} nmea_field_t;
+
+typedef struct {
+    uint8_t state;
+    uint8_t len;
+    uint8_t field_index;
+    uint8_t checksum;
+    uint8_t rx_checksum;
+    uint8_t have;           // Position fields seen (internal)
+    uint8_t addr_len;
+    char addr[5];
+    nmea_type_t type;
+    nmea_field_t field;
+    union {
+        nmea_gga_t gga;
+        nmea_rmc_t rmc;
+        nmea_vtg_t vtg;
+        nmea_gsa_t gsa;
+    } s;                    // Valid after nmea_parser_feed() returned its type
+    nmea_stats_t stats;
+} nmea_parser_t;
+
+/**
+ * @brief Reset the parser (statistics included).
+ */
+void nmea_parser_init(nmea_parser_t *p);
+
+/**
+ * @brief Feed one received byte.
+ * @return Type of a sentence completed and verified by this byte, else
+ *         NMEA_NONE. The decoded fields are in p->s until the next '$'.
+ */
+nmea_type_t nmea_parser_feed(nmea_parser_t *p, uint8_t c);
+
+/**
+ * @brief Feed a block of received bytes, stopping after the first sentence
+ * that completes in it. Call again with the rest of the block.
+ * @param type Completed sentence type, NMEA_NONE if the whole block was used up.
+ * @return Bytes consumed.
+ */
+size_t nmea_parser_feed_buf(nmea_parser_t *p, const uint8_t *data, size_t len, nmea_type_t *type);
+
+#endif // NMEA_PARSER_H
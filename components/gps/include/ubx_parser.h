@@ -0,0 +1,170 @@
+/*
+ * ubx_parser.h
+ * Byte-at-a-time u-blox UBX frame parser and encoder.
+ *
+ * Frames are B5 62 | class | id | length (LE) | payload | CK_A CK_B, with
+ * the 8-bit Fletcher checksum over class..payload. Navigation payloads are
+ * decoded only after the checksum matched, straight into integer structs in
+ * the receiver's own units. Like nmea_parser, no ESP-IDF dependencies.
+ */
+
+#ifndef UBX_PARSER_H
+#define UBX_PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define UBX_SYNC_1          (0xB5)
+#define UBX_SYNC_2          (0x62)
+#define UBX_FRAME_OVERHEAD  (8)     // Sync, class, id, length, checksum
+#define UBX_MAX_PAYLOAD     (92)    // NAV-PVT; longer frames are only verified
+
+#define UBX_CLASS_NAV       (0x01)
+#define UBX_CLASS_RXM       (0x02)
+#define UBX_CLASS_ACK       (0x05)
+#define UBX_CLASS_CFG       (0x06)
+#define UBX_CLASS_AID       (0x0B)
+
+#define UBX_NAV_POSLLH      (0x02)
+#define UBX_NAV_SOL         (0x06)
+#define UBX_NAV_PVT         (0x07)  // u-blox 7 and later, not on the NEO-6
+#define UBX_NAV_VELNED      (0x12)
+#define UBX_ACK_NAK         (0x00)
+#define UBX_ACK_ACK         (0x01)
+
+typedef enum {
+    UBX_NONE = 0,       // No complete frame yet
+    UBX_POSLLH,
+    UBX_SOL,
+    UBX_PVT,
+    UBX_VELNED,
+    UBX_ACK,            // ACK-ACK
+    UBX_NAK,            // ACK-NAK
+    UBX_OTHER,          // Valid checksum, not decoded (see msg_class/msg_id)
+} ubx_type_t;
+
+// UBX gpsFix values (NAV-SOL, NAV-PVT)
+#define UBX_FIX_NONE        (0)
+#define UBX_FIX_DR          (1)
+#define UBX_FIX_2D          (2)
+#define UBX_FIX_3D          (3)
+#define UBX_FIX_GPS_DR      (4)
+#define UBX_FIX_TIME        (5)
+
+typedef struct {
+    uint32_t itow_ms;       // GPS time of week of the epoch
+    int32_t lon_e7;
+    int32_t lat_e7;
+    int32_t height_mm;      // Above the ellipsoid
+    int32_t hmsl_mm;        // Above mean sea level
+    uint32_t h_acc_mm;
+    uint32_t v_acc_mm;
+} ubx_nav_posllh_t;
+
+typedef struct {
+    uint32_t itow_ms;
+    uint16_t week;
+    uint8_t gps_fix;        // UBX_FIX_*
+    uint8_t flags;          // Bit 0 gpsFixOk, 2 week and 3 iTOW valid
+    uint32_t p_acc_cm;      // 3D position accuracy
+    uint32_t s_acc_cm_s;
+    uint16_t pdop_x100;
+    uint8_t num_sv;
+} ubx_nav_sol_t;
+
+typedef struct {
+    uint32_t itow_ms;
+    uint32_t g_speed_cm_s;  // Ground speed
+    int32_t heading_e5;     // Degrees * 1e5
+    uint32_t s_acc_cm_s;
+    uint32_t c_acc_e5;
+} ubx_nav_velned_t;
+
+typedef struct {
+    uint32_t itow_ms;
+    uint16_t year;          // UTC date and time
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t min;
+    uint8_t sec;
+    uint8_t valid;          // Bit 0 validDate, bit 1 validTime
+    uint8_t fix_type;       // UBX_FIX_*
+    uint8_t flags;          // Bit 0 gnssFixOK
+    uint8_t num_sv;
+    int32_t lon_e7;
+    int32_t lat_e7;
+    int32_t hmsl_mm;
+    uint32_t h_acc_mm;
+    uint32_t v_acc_mm;
+    int32_t g_speed_mm_s;
+    int32_t head_mot_e5;
+    uint16_t pdop_x100;
+} ubx_nav_pvt_t;
+
+typedef struct {
+    uint32_t frames;        // Valid frames of any class
+    uint32_t checksum_errors;
+    uint32_t overflows;     // Longer than UBX_MAX_PAYLOAD, verified but not decoded
+    uint32_t bad_length;    // Known message with an unexpected length
+} ubx_stats_t;
+
+typedef struct {
+    uint8_t state;
+    uint8_t msg_class;
+    uint8_t msg_id;
+    uint8_t ck_a;
+    uint8_t ck_b;
+    uint16_t length;
+    uint16_t pos;
+    uint8_t payload[UBX_MAX_PAYLOAD];
+    union {
+        ubx_nav_posllh_t posllh;
+        ubx_nav_sol_t sol;
+        ubx_nav_velned_t velned;
+        ubx_nav_pvt_t pvt;
+        struct {
+            uint8_t cls;    // Acknowledged message
+            uint8_t id;
+        } ack;
+    } m;                    // Valid after a feed returned its type
+    ubx_stats_t stats;
+} ubx_parser_t;
+
+/**
+ * @brief Reset the parser (statistics included).
+ */
+void ubx_parser_init(ubx_parser_t *p);
+
+/**
+ * @brief True from a sync byte until the frame ends or sync is lost; bytes
+ * in between belong to the UBX parser even if they look like text.
+ */
+static inline bool ubx_parser_in_frame(const ubx_parser_t *p) {
+    return p->state != 0;
+}
+
+/**
+ * @brief Feed one received byte.
+ * @return Type of a frame completed and verified by this byte, else UBX_NONE.
+ */
+ubx_type_t ubx_parser_feed(ubx_parser_t *p, uint8_t c);
+
+/**
+ * @brief Feed a block, stopping as soon as the parser is back to hunting for
+ * a sync byte: after a frame, a checksum error or a false sync. Bytes after
+ * that may be NMEA text and are left to the caller.
+ * @param type Completed frame type, else UBX_NONE.
+ * @return Bytes consumed.
+ */
+size_t ubx_parser_feed_buf(ubx_parser_t *p, const uint8_t *data, size_t len, ubx_type_t *type);
+
+/**
+ * @brief Build a complete frame (sync, header, payload, checksum).
+ * @return Frame length, or 0 if out_len is too small.
+ */
+size_t ubx_frame_encode(uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t length,
+                        uint8_t *out, size_t out_len);
+
+#endif // UBX_PARSER_H
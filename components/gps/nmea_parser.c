@@ -0,0 +1,378 @@
+#include "nmea_parser.h"
+#include <string.h>
+
+enum {
+    ST_IDLE,        // Waiting for '$'
+    ST_ADDR,        // Talker + sentence type
+    ST_FIELD,
+    ST_CK1,         // First checksum digit
+    ST_CK2,
+};
+
+// Position fields seen in the current sentence (nmea_parser_t.have)
+#define HAVE_LAT    (1u << 0)
+#define HAVE_NS     (1u << 1)
+#define HAVE_LON    (1u << 2)
+#define HAVE_EW     (1u << 3)
+#define HAVE_POS    (HAVE_LAT | HAVE_NS | HAVE_LON | HAVE_EW)
+
+static const uint32_t s_pow10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000,
+};
+
+static void field_reset(nmea_field_t *f) {
+    memset(f, 0, sizeof(*f));
+    f->empty = true;
+}
+
+void nmea_parser_init(nmea_parser_t *p) {
+    memset(p, 0, sizeof(*p));
+    p->state = ST_IDLE;
+}
+
+// --- Field conversion (no floating point) ---
+
+// Fraction part * 10^digits, extra digits truncated
+static uint32_t frac_scaled(const nmea_field_t *f, int digits) {
+    if (f->frac_digits <= digits) return f->frac * s_pow10[digits - f->frac_digits];
+    return f->frac / s_pow10[f->frac_digits - digits];
+}
+
+// Value * 10^digits
+static int64_t fixed(const nmea_field_t *f, int digits) {
+    int64_t v = (int64_t)f->ip * s_pow10[digits] + frac_scaled(f, digits);
+    return f->neg ? -v : v;
+}
+
+static uint16_t fixed_u16(const nmea_field_t *f, int digits) {
+    int64_t v = fixed(f, digits);
+    if (v < 0) return 0;
+    return v > UINT16_MAX ? UINT16_MAX : (uint16_t)v;
+}
+
+// (d)ddmm.mmmmmmm -> 1e-7 degrees, rounded
+static int32_t coord_e7(const nmea_field_t *f) {
+    uint32_t deg = f->ip / 100;
+    int64_t min_e7 = (int64_t)(f->ip % 100) * 10000000 + frac_scaled(f, 7);
+    return (int32_t)((int64_t)deg * 10000000 + (min_e7 + 30) / 60);
+}
+
+// hhmmss.sss -> ms of the day
+static uint32_t time_ms(const nmea_field_t *f) {
+    uint32_t hh = f->ip / 10000;
+    uint32_t mm = (f->ip / 100) % 100;
+    uint32_t ss = f->ip % 100;
+    return ((hh * 60 + mm) * 60 + ss) * 1000 + frac_scaled(f, 3);
+}
+
+// Knots * 1000 -> mm/s (1 kn = 1852 m/h)
+static uint32_t knots_to_mm_s(const nmea_field_t *f) {
+    int64_t v = fixed(f, 3);
+    return v <= 0 ? 0 : (uint32_t)((v * 1852 + 1800) / 3600);
+}
+
+// km/h * 1000 -> mm/s
+static uint32_t kmh_to_mm_s(const nmea_field_t *f) {
+    int64_t v = fixed(f, 3);
+    return v <= 0 ? 0 : (uint32_t)((v * 10 + 18) / 36);
+}
+
+// Latitude/longitude pairs share one layout in GGA and RMC
+static void position_field(nmea_parser_t *p, const nmea_field_t *f, int rel,
+                           int32_t *lat, int32_t *lon, bool *has_pos) {
+    if (f->empty) return;
+    switch (rel) {
+    case 0: *lat = coord_e7(f); p->have |= HAVE_LAT; break;
+    case 1:
+        if (f->ch == 'S') *lat = -*lat;
+        if (f->ch == 'N' || f->ch == 'S') p->have |= HAVE_NS;
+        break;
+    case 2: *lon = coord_e7(f); p->have |= HAVE_LON; break;
+    case 3:
+        if (f->ch == 'W') *lon = -*lon;
+        if (f->ch == 'E' || f->ch == 'W') p->have |= HAVE_EW;
+        *has_pos = (p->have & HAVE_POS) == HAVE_POS;
+        break;
+    }
+}
+
+// --- Per-sentence field handlers ---
+
+static void gga_field(nmea_parser_t *p, const nmea_field_t *f, uint8_t idx) {
+    nmea_gga_t *g = &p->s.gga;
+    if (idx >= 2 && idx <= 5) {
+        position_field(p, f, idx - 2, &g->lat_e7, &g->lon_e7, &g->has_pos);
+        return;
+    }
+    if (f->empty) return;
+    switch (idx) {
+    case 1: g->time_ms = time_ms(f); break;
+    case 6: g->fix_quality = (uint8_t)f->ip; break;
+    case 7: g->satellites = (uint8_t)f->ip; break;
+    case 8: g->hdop_x100 = fixed_u16(f, 2); break;
+    case 9: g->alt_mm = (int32_t)fixed(f, 3); g->has_alt = true; break;
+    default: break;
+    }
+}
+
+static void rmc_field(nmea_parser_t *p, const nmea_field_t *f, uint8_t idx) {
+    nmea_rmc_t *r = &p->s.rmc;
+    if (idx >= 3 && idx <= 6) {
+        position_field(p, f, idx - 3, &r->lat_e7, &r->lon_e7, &r->has_pos);
+        return;
+    }
+    if (f->empty) return;
+    switch (idx) {
+    case 1: r->time_ms = time_ms(f); break;
+    case 2: r->active = (f->ch == 'A'); break;
+    case 7: r->speed_mm_s = knots_to_mm_s(f); break;
+    case 8: r->course_e2 = fixed_u16(f, 2); r->has_course = true; break;
+    case 9: r->date = f->ip; break;
+    default: break;
+    }
+}
+
+static void vtg_field(nmea_parser_t *p, const nmea_field_t *f, uint8_t idx) {
+    nmea_vtg_t *v = &p->s.vtg;
+    if (f->empty) return;
+    switch (idx) {
+    case 1: v->course_e2 = fixed_u16(f, 2); v->has_course = true; break;
+    case 7: v->speed_mm_s = kmh_to_mm_s(f); v->has_speed = true; break;
+    default: break;
+    }
+}
+
+static void gsa_field(nmea_parser_t *p, const nmea_field_t *f, uint8_t idx) {
+    nmea_gsa_t *g = &p->s.gsa;
+    if (f->empty) return;
+    if (idx >= 3 && idx <= 14) {
+        g->sats_used++;
+        return;
+    }
+    switch (idx) {
+    case 2: g->fix_type = (uint8_t)f->ip; break;
+    case 15: g->pdop_x100 = fixed_u16(f, 2); break;
+    case 16: g->hdop_x100 = fixed_u16(f, 2); break;
+    case 17: g->vdop_x100 = fixed_u16(f, 2); break;
+    default: break;
+    }
+}
+
+static void field_commit(nmea_parser_t *p) {
+    const nmea_field_t *f = &p->field;
+    switch (p->type) {
+    case NMEA_GGA: gga_field(p, f, p->field_index); break;
+    case NMEA_RMC: rmc_field(p, f, p->field_index); break;
+    case NMEA_VTG: vtg_field(p, f, p->field_index); break;
+    case NMEA_GSA: gsa_field(p, f, p->field_index); break;
+    default: break;
+    }
+}
+
+// "GPGGA", "GNRMC", ... - any two-letter talker
+static nmea_type_t address_type(const nmea_parser_t *p) {
+    if (p->addr_len != 5) return NMEA_OTHER;
+    const char *t = &p->addr[2];
+    if (t[0] == 'G' && t[1] == 'G' && t[2] == 'A') return NMEA_GGA;
+    if (t[0] == 'R' && t[1] == 'M' && t[2] == 'C') return NMEA_RMC;
+    if (t[0] == 'V' && t[1] == 'T' && t[2] == 'G') return NMEA_VTG;
+    if (t[0] == 'G' && t[1] == 'S' && t[2] == 'A') return NMEA_GSA;
+    return NMEA_OTHER;
+}
+
+static void field_accumulate(nmea_field_t *f, char c) {
+    f->empty = false;
+    if (c >= '0' && c <= '9') {
+        uint32_t d = (uint32_t)(c - '0');
+        if (!f->dot) {
+            if (f->ip < 100000000u) f->ip = f->ip * 10 + d;
+        } else if (f->frac_digits < 7) {
+            f->frac = f->frac * 10 + d;
+            f->frac_digits++;
+        }
+    } else if (c == '.') {
+        f->dot = true;
+    } else if (c == '-' && f->ip == 0 && !f->dot) {
+        f->neg = true;
+    } else if (f->ch == 0) {
+        f->ch = c;
+    }
+}
+
+static int hex_value(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static void sentence_abort(nmea_parser_t *p, uint32_t *counter) {
+    (*counter)++;
+    p->state = ST_IDLE;
+}
+
+static inline nmea_type_t parse_byte(nmea_parser_t *p, uint8_t c) {
+    if (c == '$') {
+        // A new start inside a sentence means the previous one was cut off
+        if (p->state != ST_IDLE) p->stats.malformed++;
+        p->state = ST_ADDR;
+        p->len = 1;
+        p->checksum = 0;
+        p->field_index = 0;
+        p->addr_len = 0;
+        p->have = 0;
+        p->type = NMEA_NONE;
+        memset(&p->s, 0, sizeof(p->s));
+        return NMEA_NONE;
+    }
+    if (p->state == ST_IDLE) return NMEA_NONE;
+
+    if (++p->len > NMEA_MAX_SENTENCE) {
+        sentence_abort(p, &p->stats.overflows);
+        return NMEA_NONE;
+    }
+    if (c < 0x20 || c > 0x7E) {
+        // CR/LF before the checksum, binary noise, or a UBX frame in between
+        sentence_abort(p, &p->stats.malformed);
+        return NMEA_NONE;
+    }
+
+    switch (p->state) {
+    case ST_ADDR:
+        if (c == ',' || c == '*') {
+            p->type = address_type(p);
+            p->field_index = 1;
+            field_reset(&p->field);
+            if (c == ',') p->checksum ^= c;
+            p->state = (c == ',') ? ST_FIELD : ST_CK1;
+        } else if (p->addr_len < sizeof(p->addr)) {
+            p->addr[p->addr_len++] = (char)c;
+            p->checksum ^= c;
+        } else {
+            sentence_abort(p, &p->stats.malformed);
+        }
+        break;
+
+    case ST_FIELD:
+        // Types without a decoder only need the checksum
+        if (p->type == NMEA_OTHER) {
+            if (c == '*') p->state = ST_CK1;
+            else p->checksum ^= c;
+            break;
+        }
+        if (c == '*') {
+            field_commit(p);
+            p->state = ST_CK1;
+            break;
+        }
+        p->checksum ^= c;
+        if (c == ',') {
+            field_commit(p);
+            if (p->field_index < UINT8_MAX) p->field_index++;
+            field_reset(&p->field);
+        } else {
+            field_accumulate(&p->field, (char)c);
+        }
+        break;
+
+    case ST_CK1: {
+        int v = hex_value(c);
+        if (v < 0) {
+            sentence_abort(p, &p->stats.malformed);
+            break;
+        }
+        p->rx_checksum = (uint8_t)(v << 4);
+        p->state = ST_CK2;
+        break;
+    }
+
+    case ST_CK2: {
+        int v = hex_value(c);
+        p->state = ST_IDLE;
+        if (v < 0) {
+            p->stats.malformed++;
+            break;
+        }
+        if ((p->rx_checksum | v) != p->checksum) {
+            p->stats.checksum_errors++;
+            break;
+        }
+        p->stats.sentences++;
+        return p->type;
+    }
+
+    default:
+        p->state = ST_IDLE;
+        break;
+    }
+    return NMEA_NONE;
+}
+
+nmea_type_t nmea_parser_feed(nmea_parser_t *p, uint8_t c) {
+    return parse_byte(p, c);
+}
+
+// Sentence body with the running state in registers. Handles field bytes and
+// field separators; stops before '*', '$', a control character or the length
+// limit, all of which go through parse_byte().
+static size_t scan_fields(nmea_parser_t *p, const uint8_t *data, size_t n) {
+    size_t room = NMEA_MAX_SENTENCE - p->len;
+    if (n > room) n = room;
+
+    uint8_t ck = p->checksum;
+    size_t i = 0;
+    if (p->type == NMEA_OTHER) {
+        for (; i < n; i++) {
+            uint8_t c = data[i];
+            if (c == '*' || c == '$' || c < 0x20 || c > 0x7E) break;
+            ck ^= c;
+        }
+        p->checksum = ck;
+        p->len += (uint8_t)i;
+        return i;
+    }
+
+    nmea_field_t *f = &p->field;
+    for (; i < n; i++) {
+        uint8_t c = data[i];
+        uint8_t d = (uint8_t)(c - '0');
+        if (d < 10) {
+            f->empty = false;
+            if (!f->dot) {
+                if (f->ip < 100000000u) f->ip = f->ip * 10 + d;
+            } else if (f->frac_digits < 7) {
+                f->frac = f->frac * 10 + d;
+                f->frac_digits++;
+            }
+        } else if (c == ',') {
+            field_commit(p);
+            if (p->field_index < UINT8_MAX) p->field_index++;
+            field_reset(f);
+        } else if (c == '*' || c == '$' || c < 0x20 || c > 0x7E) {
+            break;
+        } else {
+            field_accumulate(f, (char)c);
+        }
+        ck ^= c;
+    }
+    p->checksum = ck;
+    p->len += (uint8_t)i;
+    return i;
+}
+
+size_t nmea_parser_feed_buf(nmea_parser_t *p, const uint8_t *data, size_t len, nmea_type_t *type) {
+    size_t i = 0;
+    while (i < len) {
+        if (p->state == ST_FIELD) {
+            i += scan_fields(p, data + i, len - i);
+            if (i == len) break;
+        }
+        nmea_type_t t = parse_byte(p, data[i++]);
+        if (t != NMEA_NONE) {
+            *type = t;
+            return i;
+        }
+    }
+    *type = NMEA_NONE;
+    return len;
+}
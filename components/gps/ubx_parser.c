@@ -0,0 +1,284 @@
+#include "ubx_parser.h"
+#include <string.h>
+
+enum {
+    ST_SYNC1,
+    ST_SYNC2,
+    ST_CLASS,
+    ST_ID,
+    ST_LEN1,
+    ST_LEN2,
+    ST_PAYLOAD,
+    ST_CK_A,
+    ST_CK_B,
+};
+
+// Payload lengths of the decoded messages
+#define LEN_POSLLH      (28)
+#define LEN_SOL         (52)
+#define LEN_VELNED      (36)
+#define LEN_PVT_7       (84)    // u-blox 7
+#define LEN_PVT_8       (92)    // u-blox 8 and later
+#define LEN_ACK         (2)
+
+void ubx_parser_init(ubx_parser_t *p) {
+    memset(p, 0, sizeof(*p));
+    p->state = ST_SYNC1;
+}
+
+// --- Little-endian payload access ---
+
+static uint16_t rd_u16(const uint8_t *b) {
+    return (uint16_t)(b[0] | (b[1] << 8));
+}
+
+static uint32_t rd_u32(const uint8_t *b) {
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+static int32_t rd_i32(const uint8_t *b) {
+    return (int32_t)rd_u32(b);
+}
+
+// --- Message decoders (payload verified, length checked) ---
+
+static void decode_posllh(ubx_nav_posllh_t *m, const uint8_t *b) {
+    m->itow_ms = rd_u32(b + 0);
+    m->lon_e7 = rd_i32(b + 4);
+    m->lat_e7 = rd_i32(b + 8);
+    m->height_mm = rd_i32(b + 12);
+    m->hmsl_mm = rd_i32(b + 16);
+    m->h_acc_mm = rd_u32(b + 20);
+    m->v_acc_mm = rd_u32(b + 24);
+}
+
+static void decode_sol(ubx_nav_sol_t *m, const uint8_t *b) {
+    m->itow_ms = rd_u32(b + 0);
+    m->week = rd_u16(b + 8);
+    m->gps_fix = b[10];
+    m->flags = b[11];
+    m->p_acc_cm = rd_u32(b + 24);
+    m->s_acc_cm_s = rd_u32(b + 40);
+    m->pdop_x100 = rd_u16(b + 44);
+    m->num_sv = b[47];
+}
+
+static void decode_velned(ubx_nav_velned_t *m, const uint8_t *b) {
+    m->itow_ms = rd_u32(b + 0);
+    m->g_speed_cm_s = rd_u32(b + 20);
+    m->heading_e5 = rd_i32(b + 24);
+    m->s_acc_cm_s = rd_u32(b + 28);
+    m->c_acc_e5 = rd_u32(b + 32);
+}
+
+static void decode_pvt(ubx_nav_pvt_t *m, const uint8_t *b) {
+    m->itow_ms = rd_u32(b + 0);
+    m->year = rd_u16(b + 4);
+    m->month = b[6];
+    m->day = b[7];
+    m->hour = b[8];
+    m->min = b[9];
+    m->sec = b[10];
+    m->valid = b[11];
+    m->fix_type = b[20];
+    m->flags = b[21];
+    m->num_sv = b[23];
+    m->lon_e7 = rd_i32(b + 24);
+    m->lat_e7 = rd_i32(b + 28);
+    m->hmsl_mm = rd_i32(b + 36);
+    m->h_acc_mm = rd_u32(b + 40);
+    m->v_acc_mm = rd_u32(b + 44);
+    m->g_speed_mm_s = rd_i32(b + 60);
+    m->head_mot_e5 = rd_i32(b + 64);
+    m->pdop_x100 = rd_u16(b + 76);
+}
+
+// Frame with a matching checksum: decode what we know
+static ubx_type_t frame_complete(ubx_parser_t *p) {
+    p->stats.frames++;
+    if (p->length > UBX_MAX_PAYLOAD) return UBX_OTHER;
+
+    const uint8_t *b = p->payload;
+    ubx_type_t type = UBX_OTHER;
+    uint16_t expected = 0;
+
+    if (p->msg_class == UBX_CLASS_NAV) {
+        switch (p->msg_id) {
+        case UBX_NAV_POSLLH: type = UBX_POSLLH; expected = LEN_POSLLH; break;
+        case UBX_NAV_SOL:    type = UBX_SOL;    expected = LEN_SOL; break;
+        case UBX_NAV_VELNED: type = UBX_VELNED; expected = LEN_VELNED; break;
+        case UBX_NAV_PVT:
+            type = UBX_PVT;
+            expected = (p->length == LEN_PVT_7) ? LEN_PVT_7 : LEN_PVT_8;
+            break;
+        default: break;
+        }
+    } else if (p->msg_class == UBX_CLASS_ACK &&
+               (p->msg_id == UBX_ACK_ACK || p->msg_id == UBX_ACK_NAK)) {
+        type = (p->msg_id == UBX_ACK_ACK) ? UBX_ACK : UBX_NAK;
+        expected = LEN_ACK;
+    }
+    if (type == UBX_OTHER) return UBX_OTHER;
+    if (p->length != expected) {
+        p->stats.bad_length++;
+        return UBX_OTHER;
+    }
+
+    switch (type) {
+    case UBX_POSLLH: decode_posllh(&p->m.posllh, b); break;
+    case UBX_SOL:    decode_sol(&p->m.sol, b); break;
+    case UBX_VELNED: decode_velned(&p->m.velned, b); break;
+    case UBX_PVT:    decode_pvt(&p->m.pvt, b); break;
+    default:
+        p->m.ack.cls = b[0];
+        p->m.ack.id = b[1];
+        break;
+    }
+    return type;
+}
+
+static inline void ck_add(ubx_parser_t *p, uint8_t c) {
+    p->ck_a += c;
+    p->ck_b += p->ck_a;
+}
+
+static inline ubx_type_t parse_byte(ubx_parser_t *p, uint8_t c) {
+    switch (p->state) {
+    case ST_SYNC1:
+        if (c == UBX_SYNC_1) p->state = ST_SYNC2;
+        break;
+
+    case ST_SYNC2:
+        // B5 B5 62 still syncs on the second B5
+        if (c == UBX_SYNC_2) {
+            p->state = ST_CLASS;
+            p->ck_a = 0;
+            p->ck_b = 0;
+        } else if (c != UBX_SYNC_1) {
+            p->state = ST_SYNC1;
+        }
+        break;
+
+    case ST_CLASS:
+        p->msg_class = c;
+        ck_add(p, c);
+        p->state = ST_ID;
+        break;
+
+    case ST_ID:
+        p->msg_id = c;
+        ck_add(p, c);
+        p->state = ST_LEN1;
+        break;
+
+    case ST_LEN1:
+        p->length = c;
+        ck_add(p, c);
+        p->state = ST_LEN2;
+        break;
+
+    case ST_LEN2:
+        p->length |= (uint16_t)(c << 8);
+        ck_add(p, c);
+        p->pos = 0;
+        if (p->length > UBX_MAX_PAYLOAD) p->stats.overflows++;
+        p->state = (p->length > 0) ? ST_PAYLOAD : ST_CK_A;
+        break;
+
+    case ST_PAYLOAD:
+        if (p->pos < UBX_MAX_PAYLOAD) p->payload[p->pos] = c;
+        ck_add(p, c);
+        if (++p->pos >= p->length) p->state = ST_CK_A;
+        break;
+
+    case ST_CK_A:
+        if (c != p->ck_a) {
+            p->stats.checksum_errors++;
+            p->state = (c == UBX_SYNC_1) ? ST_SYNC2 : ST_SYNC1;
+            break;
+        }
+        p->state = ST_CK_B;
+        break;
+
+    case ST_CK_B:
+        p->state = ST_SYNC1;
+        if (c != p->ck_b) {
+            p->stats.checksum_errors++;
+            if (c == UBX_SYNC_1) p->state = ST_SYNC2;
+            break;
+        }
+        return frame_complete(p);
+
+    default:
+        p->state = ST_SYNC1;
+        break;
+    }
+    return UBX_NONE;
+}
+
+ubx_type_t ubx_parser_feed(ubx_parser_t *p, uint8_t c) {
+    return parse_byte(p, c);
+}
+
+// Payload bytes with the checksum in registers
+static size_t scan_payload(ubx_parser_t *p, const uint8_t *data, size_t n) {
+    size_t left = (size_t)(p->length - p->pos);
+    if (n > left) n = left;
+
+    uint8_t a = p->ck_a, b = p->ck_b;
+    for (size_t i = 0; i < n; i++) {
+        a += data[i];
+        b += a;
+    }
+    p->ck_a = a;
+    p->ck_b = b;
+
+    if (p->pos < UBX_MAX_PAYLOAD) {
+        size_t room = UBX_MAX_PAYLOAD - p->pos;
+        memcpy(p->payload + p->pos, data, n < room ? n : room);
+    }
+    p->pos += (uint16_t)n;
+    if (p->pos >= p->length) p->state = ST_CK_A;
+    return n;
+}
+
+size_t ubx_parser_feed_buf(ubx_parser_t *p, const uint8_t *data, size_t len, ubx_type_t *type) {
+    size_t i = 0;
+    while (i < len) {
+        if (p->state == ST_PAYLOAD) {
+            i += scan_payload(p, data + i, len - i);
+            if (i == len) break;
+        }
+        ubx_type_t t = parse_byte(p, data[i++]);
+        if (p->state == ST_SYNC1) {
+            *type = t;
+            return i;
+        }
+    }
+    *type = UBX_NONE;
+    return len;
+}
+
+size_t ubx_frame_encode(uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t length,
+                        uint8_t *out, size_t out_len) {
+    size_t total = (size_t)length + UBX_FRAME_OVERHEAD;
+    if (out_len < total) return 0;
+
+    out[0] = UBX_SYNC_1;
+    out[1] = UBX_SYNC_2;
+    out[2] = cls;
+    out[3] = id;
+    out[4] = (uint8_t)(length & 0xFF);
+    out[5] = (uint8_t)(length >> 8);
+    if (length > 0) memcpy(out + 6, payload, length);
+
+    // Checksum over class, id, length and payload
+    uint8_t ck_a = 0, ck_b = 0;
+    for (size_t i = 2; i < total - 2; i++) {
+        ck_a += out[i];
+        ck_b += ck_a;
+    }
+    out[total - 2] = ck_a;
+    out[total - 1] = ck_b;
+    return total;
+}
@@ -0,0 +1,114 @@
+#include <string.h>
+#include <sys/time.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+
+#include "gps_standby.h"
+#include "gps.h"
+#include "arming_manager.h"
+#include "mpu_monitor.h"
+#include "config.h"
+
+static const char *TAG = "GPS_STANDBY";
+
+#define STANDBY_RTC_MAGIC (0x53544231)   // "STB1"
+
+typedef struct {
+    uint32_t magic;
+    standby_policy_t policy;
+} standby_rtc_state_t;
+
+static RTC_DATA_ATTR standby_rtc_state_t s_rtc;
+
+static volatile bool s_active = false;      // Session running (power manager input)
+static bool s_gps_on = false;               // Receiver woken by a session
+static bool s_handover = false;             // Session ended by an alarm, receiver awake
+static uint32_t s_activity_seen = 0;
+static uint32_t s_fix_seq = 0;
+
+// Survives deep sleep (RTC timer), unlike esp_timer
+static uint32_t rtc_time_s(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint32_t)tv.tv_sec;
+}
+
+void gps_standby_init(void)
+{
+    const standby_config_t cfg = {
+        .refresh_s = GPS_STANDBY_REFRESH_S,
+        .activity_gap_s = GPS_STANDBY_ACTIVITY_GAP_S,
+        .after_fix_s = GPS_STANDBY_AFTER_FIX_S,
+        .session_max_s = GPS_STANDBY_SESSION_MAX_S,
+        .budget_s = GPS_STANDBY_BUDGET_S,
+    };
+
+    if (s_rtc.magic != STANDBY_RTC_MAGIC) {
+        memset(&s_rtc, 0, sizeof(s_rtc));
+        s_rtc.magic = STANDBY_RTC_MAGIC;
+        standby_policy_init(&s_rtc.policy, &cfg, rtc_time_s());
+    } else {
+        // gps_init() put the receiver to sleep; no session outlives a boot
+        s_rtc.policy.cfg = cfg;
+        s_rtc.policy.on = false;
+    }
+    s_activity_seen = mpu_monitor_activity_count();
+}
+
+void gps_standby_poll(void)
+{
+    standby_policy_t *p = &s_rtc.policy;
+    gps_snapshot_t snap;
+    uint32_t activity = mpu_monitor_activity_count();
+
+    standby_inputs_t in = {
+        .armed = is_system_armed(),
+        .in_alarm = is_system_in_alarm(),
+        .activity = activity != s_activity_seen,
+        .fix = gps_read_snapshot(&snap, &s_fix_seq) && snap.data.is_valid,
+    };
+    s_activity_seen = activity;
+
+    bool was_on = p->on;
+    bool on = standby_policy_step(p, &in, rtc_time_s());
+
+    if (on && !was_on) {
+        ESP_LOGI(TAG, "Session #%lu (%s), budget left %lu s",
+                 (unsigned long)p->sessions, standby_reason_name(p->reason),
+                 (unsigned long)standby_policy_budget_left_s(p));
+        s_active = true;
+        gps_wake();
+        s_gps_on = true;
+    } else if (!on && was_on) {
+        ESP_LOGI(TAG, "Session ended (%s), fix: %s, used today %lu s",
+                 in.in_alarm ? "alarm" : standby_reason_name(p->reason),
+                 p->session_fix ? "yes" : "no", (unsigned long)p->used_s);
+        if (s_gps_on && in.in_alarm) {
+            s_handover = true;
+        } else if (s_gps_on) {
+            gps_sleep();
+        }
+        s_gps_on = false;
+        s_active = false;
+    }
+}
+
+bool gps_standby_handover(void)
+{
+    gps_standby_poll();
+    bool awake = s_handover;
+    s_handover = false;
+    return awake;
+}
+
+bool gps_standby_active(void)
+{
+    return s_active;
+}
+
+uint32_t gps_standby_next_refresh_s(void)
+{
+    if (s_rtc.magic != STANDBY_RTC_MAGIC) return UINT32_MAX;
+    return standby_policy_next_refresh_s(&s_rtc.policy, rtc_time_s());
+}
@@ -0,0 +1,30 @@
+#ifndef GPS_STANDBY_H
+#define GPS_STANDBY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "standby_policy.h"
+
+// Warm standby of the GPS receiver while armed (see standby_policy.h).
+// The policy state lives in RTC memory, so the daily budget and the age of
+// the last fix carry across deep sleep. All calls except the two queries
+// come from the task that owns GPS power (alarm_runner).
+
+// Restores the policy from RTC memory (or starts it on a cold boot)
+void gps_standby_init(void);
+
+// Periodic step: wakes the receiver for a session and puts it back to
+// sleep when the session ends. During an alarm it only tracks fixes.
+void gps_standby_poll(void);
+
+// Call when an alarm starts. Ends a running session; true if the receiver
+// was left awake for the alarm (no gps_wake() needed).
+bool gps_standby_handover(void);
+
+// Session running: keeps the device out of deep sleep
+bool gps_standby_active(void);
+
+// Seconds until the next refresh session is due, UINT32_MAX if none
+uint32_t gps_standby_next_refresh_s(void);
+
+#endif // GPS_STANDBY_H
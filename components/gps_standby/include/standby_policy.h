@@ -0,0 +1,82 @@
+#ifndef STANDBY_POLICY_H
+#define STANDBY_POLICY_H
+
+/*
+ * Decides when to run the GPS receiver while armed and not in alarm, so
+ * that an alarm finds it with fresh aiding data (ephemeris, time, position)
+ * and its first report already carries a fix. Pure logic with explicit time
+ * input (seconds on a clock that keeps counting through deep sleep) and no
+ * ESP-IDF dependencies, like power_fsm.
+ *
+ * A session starts on sub-threshold activity (motion the IMU verified and
+ * rejected) or when the last fix is older than refresh_s. It ends
+ * after_fix_s past its first fix (long enough to collect the ephemeris),
+ * after session_max_s without a fix, or when the daily budget is spent.
+ * An alarm ends it too; the receiver is then handed over awake.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    STANDBY_REASON_NONE,
+    STANDBY_REASON_ACTIVITY,     // Sub-threshold motion while armed
+    STANDBY_REASON_REFRESH,      // Last fix too old for a hot start
+} standby_reason_t;
+
+typedef struct {
+    uint32_t refresh_s;          // Max age of the last fix while armed (0 = no refresh)
+    uint32_t activity_gap_s;     // Activity wakes only if the last fix / session is older
+    uint32_t after_fix_s;        // Receiver kept on after the first fix
+    uint32_t session_max_s;      // Give up without a fix
+    uint32_t budget_s;           // Standby GPS-on seconds per day
+} standby_config_t;
+
+typedef struct {
+    bool armed;
+    bool in_alarm;
+    bool activity;               // Sub-threshold motion since the last step
+    bool fix;                    // New valid fix since the last step (any owner)
+} standby_inputs_t;
+
+typedef struct {
+    standby_config_t cfg;
+    bool on;                     // Session running
+    standby_reason_t reason;     // Of the running or last session
+    uint32_t session_start_s;
+    bool session_fix;
+    uint32_t session_fix_s;      // First fix of the running session
+    bool has_last;               // last_s is meaningful
+    uint32_t last_s;             // Last fix or end of the last session
+    uint32_t day_start_s;
+    uint32_t used_s;             // Standby GPS-on time since day_start_s
+    uint32_t last_step_s;
+    uint32_t sessions;
+    uint32_t denied;             // Activity wakes refused by the budget
+} standby_policy_t;
+
+/**
+ * @brief Reset the policy; the first armed step starts a refresh session.
+ */
+void standby_policy_init(standby_policy_t *p, const standby_config_t *cfg, uint32_t now_s);
+
+/**
+ * @brief Evaluate the inputs and account GPS-on time.
+ * @return true while a standby session wants the receiver on.
+ */
+bool standby_policy_step(standby_policy_t *p, const standby_inputs_t *in, uint32_t now_s);
+
+/**
+ * @brief Seconds until a refresh session is due (0 = now), for the deep
+ * sleep timer; UINT32_MAX without periodic refresh.
+ */
+uint32_t standby_policy_next_refresh_s(const standby_policy_t *p, uint32_t now_s);
+
+/**
+ * @brief Budget left today, seconds.
+ */
+uint32_t standby_policy_budget_left_s(const standby_policy_t *p);
+
+const char *standby_reason_name(standby_reason_t reason);
+
+#endif // STANDBY_POLICY_H
@@ -0,0 +1,89 @@
+#include "standby_policy.h"
+#include <string.h>
+
+#define DAY_S   (86400u)
+
+void standby_policy_init(standby_policy_t *p, const standby_config_t *cfg, uint32_t now_s) {
+    memset(p, 0, sizeof(*p));
+    p->cfg = *cfg;
+    p->day_start_s = now_s;
+    p->last_step_s = now_s;
+}
+
+static void end_session(standby_policy_t *p, uint32_t now_s) {
+    p->on = false;
+    p->has_last = true;
+    p->last_s = now_s;
+}
+
+bool standby_policy_step(standby_policy_t *p, const standby_inputs_t *in, uint32_t now_s) {
+    if (now_s - p->day_start_s >= DAY_S) {
+        p->day_start_s = now_s;
+        p->used_s = 0;
+    }
+    if (p->on) p->used_s += now_s - p->last_step_s;
+    p->last_step_s = now_s;
+
+    if (in->fix) {
+        p->has_last = true;
+        p->last_s = now_s;
+    }
+
+    if (p->on) {
+        if (in->fix && !p->session_fix) {
+            p->session_fix = true;
+            p->session_fix_s = now_s;
+        }
+        bool done = !in->armed || in->in_alarm ||
+                    (p->session_fix && now_s - p->session_fix_s >= p->cfg.after_fix_s) ||
+                    now_s - p->session_start_s >= p->cfg.session_max_s ||
+                    p->used_s >= p->cfg.budget_s;
+        if (done) end_session(p, now_s);
+        return p->on;
+    }
+    if (!in->armed || in->in_alarm) return false;
+
+    // Nothing known yet counts as stale: warm up right after arming
+    uint32_t age = p->has_last ? now_s - p->last_s : UINT32_MAX;
+    standby_reason_t want = STANDBY_REASON_NONE;
+    if (in->activity && age >= p->cfg.activity_gap_s) want = STANDBY_REASON_ACTIVITY;
+    else if (p->cfg.refresh_s > 0 && age >= p->cfg.refresh_s) want = STANDBY_REASON_REFRESH;
+    if (want == STANDBY_REASON_NONE) return false;
+
+    // A refused refresh simply waits for the next day's budget
+    if (p->used_s >= p->cfg.budget_s) {
+        if (want == STANDBY_REASON_ACTIVITY) p->denied++;
+        return false;
+    }
+
+    p->on = true;
+    p->reason = want;
+    p->session_start_s = now_s;
+    p->session_fix = false;
+    p->sessions++;
+    return true;
+}
+
+uint32_t standby_policy_next_refresh_s(const standby_policy_t *p, uint32_t now_s) {
+    if (p->cfg.refresh_s == 0) return UINT32_MAX;
+    if (!p->has_last) return 0;
+
+    uint32_t due = p->last_s + p->cfg.refresh_s;
+    if (p->used_s >= p->cfg.budget_s && due - p->day_start_s < DAY_S) {
+        due = p->day_start_s + DAY_S;
+    }
+    return (int32_t)(due - now_s) > 0 ? due - now_s : 0;
+}
+
+uint32_t standby_policy_budget_left_s(const standby_policy_t *p) {
+    return p->used_s < p->cfg.budget_s ? p->cfg.budget_s - p->used_s : 0;
+}
+
+const char *standby_reason_name(standby_reason_t reason) {
+    switch (reason) {
+    case STANDBY_REASON_NONE:     return "none";
+    case STANDBY_REASON_ACTIVITY: return "activity";
+    case STANDBY_REASON_REFRESH:  return "refresh";
+    default:                      return "?";
+    }
+}
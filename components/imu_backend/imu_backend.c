@@ -0,0 +1,12 @@
+#include "imu_backend.h"
+
+uint16_t imu_accel_lsb_per_g(uint8_t accel_range_g) {
+    switch (accel_range_g) {
+    case 2:  return 16384;
+    case 4:  return 8192;
+    case 8:  return 4096;
+    case 16: return 2048;
+    default: return 0;
+    }
+}
+
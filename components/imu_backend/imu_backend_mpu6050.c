@@ -0,0 +1,211 @@
+#include "imu_backend_mpu6050.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include <math.h>
+
+static const char *TAG = "IMU_HW";
+
+#define HW_RING_SAMPLES (64)
+
+typedef struct {
+    imu_mpu6050_config_t conf;
+    imu_int_cb_t on_int;
+    void *int_arg;
+    imu_config_t cur;
+    bool configured;
+    mpu6050_raw_sample_t ring_buf[HW_RING_SAMPLES];
+    mpu6050_ring_t ring;
+} hw_ctx_t;
+
+static hw_ctx_t s_hw;
+
+// INT pin ISR: the backend only forwards the edge, status is read in task context
+static void IRAM_ATTR hw_int_isr(void *arg)
+{
+    hw_ctx_t *hw = (hw_ctx_t *)arg;
+    if (hw->on_int) hw->on_int(hw->int_arg, true);
+}
+
+static esp_err_t hw_init(void *ctx, imu_int_cb_t on_int, void *int_arg)
+{
+    hw_ctx_t *hw = (hw_ctx_t *)ctx;
+    hw->on_int = on_int;
+    hw->int_arg = int_arg;
+    hw->configured = false;
+
+    esp_err_t err = mpu6050_init(&hw->conf.bus);
+    if (err != ESP_OK) return err;
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << hw->conf.int_pin),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_POSEDGE
+    };
+    err = gpio_config(&io_conf);
+    if (err != ESP_OK) return err;
+
+    // The ISR service may already be installed by another component
+    err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) return err;
+
+    err = gpio_isr_handler_add(hw->conf.int_pin, hw_int_isr, hw);
+    if (err != ESP_OK) return err;
+
+    // Stays disabled until motion mode is configured
+    return gpio_intr_disable(hw->conf.int_pin);
+}
+
+static mpu6050_accel_range_t to_accel_range(uint8_t range_g)
+{
+    switch (range_g) {
+    case 2:  return ACCEL_RANGE_2G;
+    case 8:  return ACCEL_RANGE_8G;
+    case 16: return ACCEL_RANGE_16G;
+    default: return ACCEL_RANGE_4G;
+    }
+}
+
+// Narrowest filter that still passes the requested bandwidth
+static mpu6050_dlpf_t to_dlpf(uint16_t hz)
+{
+    static const struct { uint16_t hz; mpu6050_dlpf_t dlpf; } table[] = {
+        {5, DLPF_5HZ}, {10, DLPF_10HZ}, {21, DLPF_21HZ}, {44, DLPF_44HZ},
+        {94, DLPF_94HZ}, {184, DLPF_184HZ},
+    };
+    if (hz == 0) return DLPF_260HZ;
+    for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+        if (hz <= table[i].hz) return table[i].dlpf;
+    }
+    return DLPF_260HZ;
+}
+
+static mpu6050_lp_wake_t to_lp_wake(uint8_t hz)
+{
+    if (hz >= 40) return LP_WAKE_40HZ;
+    if (hz >= 20) return LP_WAKE_20HZ;
+    if (hz >= 5) return LP_WAKE_5HZ;
+    return LP_WAKE_1_25HZ;
+}
+
+static bool sensing_differs(const imu_config_t *a, const imu_config_t *b)
+{
+    return a->mode != b->mode || a->accel_range_g != b->accel_range_g ||
+           a->dlpf_hz != b->dlpf_hz || a->lp_wake_hz != b->lp_wake_hz ||
+           a->gyro_standby != b->gyro_standby || a->temp_disable != b->temp_disable;
+}
+
+static esp_err_t hw_configure(void *ctx, const imu_config_t *cfg)
+{
+    hw_ctx_t *hw = (hw_ctx_t *)ctx;
+    const imu_config_t *cur = &hw->cur;
+    bool first = !hw->configured;
+    bool mode_changed = first || cfg->mode != cur->mode;
+    bool sensing_changed = first || sensing_differs(cfg, cur);
+    esp_err_t err = ESP_OK;
+
+    // The FIFO fills at the wake rate in cycle mode - not a usable stream
+    if (cfg->lp_wake_hz && cfg->stream_odr_hz) return ESP_ERR_INVALID_ARG;
+
+    // Streams are restarted around a reconfiguration
+    bool stream_changed = sensing_changed || cfg->stream_odr_hz != cur->stream_odr_hz;
+    if (stream_changed && !first && cur->stream_odr_hz) {
+        mpu6050_fifo_stop();
+    }
+
+    if (sensing_changed) {
+        if (mode_changed && cfg->mode != IMU_MODE_MOTION) {
+            gpio_intr_disable(hw->conf.int_pin);
+        }
+        mpu6050_sensing_t sensing = {
+            .accel_range = to_accel_range(cfg->accel_range_g),
+            .dlpf = to_dlpf(cfg->dlpf_hz),
+            .cycle = cfg->lp_wake_hz != 0,
+            .lp_wake = to_lp_wake(cfg->lp_wake_hz),
+            .gyro_standby = cfg->gyro_standby,
+            .temp_disable = cfg->temp_disable,
+            .motion_int = cfg->mode == IMU_MODE_MOTION,
+            .motion_threshold = cfg->motion_threshold,
+            .motion_duration = cfg->motion_duration,
+        };
+        err = mpu6050_apply_sensing(&sensing);
+    }
+    else if (cfg->mode == IMU_MODE_MOTION &&
+             (cfg->motion_threshold != cur->motion_threshold || cfg->motion_duration != cur->motion_duration)) {
+        err = mpu6050_set_motion_threshold(cfg->motion_threshold, cfg->motion_duration);
+    }
+    if (err != ESP_OK) return err;
+
+    hw->configured = true;
+    hw->cur = *cfg;
+
+    if (stream_changed && cfg->stream_odr_hz) {
+        mpu6050_ring_init(&hw->ring, hw->ring_buf, HW_RING_SAMPLES);
+        err = mpu6050_fifo_start(MPU6050_FIFO_ACCEL, cfg->stream_odr_hz);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "FIFO start failed: %s", esp_err_to_name(err));
+            hw->cur.stream_odr_hz = 0;
+        }
+    }
+
+    if (mode_changed && cfg->mode == IMU_MODE_MOTION) {
+        gpio_intr_enable(hw->conf.int_pin);
+    }
+    return err;
+}
+
+static esp_err_t hw_read_batch(void *ctx, mpu6050_raw_sample_t *out, uint16_t max, uint16_t *read)
+{
+    hw_ctx_t *hw = (hw_ctx_t *)ctx;
+    uint16_t n = 0;
+    esp_err_t err = ESP_OK;
+
+    if (hw->cur.stream_odr_hz) {
+        // ESP_ERR_INVALID_SIZE: sensor FIFO overflowed, what was read is still valid
+        err = mpu6050_fifo_drain(&hw->ring, max, NULL);
+        while (n < max && mpu6050_ring_pop(&hw->ring, &out[n])) {
+            n++;
+        }
+    }
+    else if (max > 0) {
+        err = mpu6050_get_raw_data(&out[0]);
+        if (err == ESP_OK) n = 1;
+    }
+
+    if (read) *read = n;
+    return err;
+}
+
+static esp_err_t hw_read_int_status(void *ctx, uint8_t *status)
+{
+    *status = mpu6050_get_int_status();
+    return ESP_OK;
+}
+
+static esp_err_t hw_read_temp(void *ctx, int16_t *temp_centi)
+{
+    hw_ctx_t *hw = (hw_ctx_t *)ctx;
+    if (hw->cur.temp_disable) return ESP_ERR_INVALID_STATE;
+
+    float temp;
+    esp_err_t err = mpu6050_get_temperature(&temp);
+    if (err == ESP_OK) *temp_centi = (int16_t)lrintf(temp * 100.0f);
+    return err;
+}
+
+static const imu_backend_ops_t s_hw_ops = {
+    .name = "mpu6050",
+    .init = hw_init,
+    .configure = hw_configure,
+    .read_batch = hw_read_batch,
+    .read_int_status = hw_read_int_status,
+    .read_temp = hw_read_temp,
+};
+
+imu_backend_t imu_backend_mpu6050(const imu_mpu6050_config_t *conf)
+{
+    s_hw.conf = *conf;
+    imu_backend_t b = { .ops = &s_hw_ops, .ctx = &s_hw };
+    return b;
+}
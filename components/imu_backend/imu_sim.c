@@ -0,0 +1,331 @@
+#include "imu_sim.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Trace files ---
+
+esp_err_t imu_trace_load_csv(FILE *f, imu_trace_sample_t *buf, size_t capacity, size_t *count) {
+    char line[160];
+    size_t n = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        if (!isdigit((unsigned char)line[0])) continue;   // Header / comment
+        if (n == capacity) return ESP_ERR_NO_MEM;
+
+        long v[8] = {0};
+        int fields = sscanf(line, "%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld",
+                            &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]);
+        if (fields < 4) return ESP_ERR_INVALID_ARG;
+
+        imu_trace_sample_t *s = &buf[n++];
+        s->t_ms = (uint32_t)v[0];
+        s->ax = (int16_t)v[1];
+        s->ay = (int16_t)v[2];
+        s->az = (int16_t)v[3];
+        s->gx = (int16_t)v[4];
+        s->gy = (int16_t)v[5];
+        s->gz = (int16_t)v[6];
+        s->flags = (fields >= 8 && v[7]) ? IMU_TRACE_FLAG_INT : 0;
+    }
+
+    *count = n;
+    return ESP_OK;
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int16_t get_i16(const uint8_t *p) {
+    return (int16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static void put_i16(uint8_t *p, int16_t v) {
+    p[0] = (uint16_t)v;
+    p[1] = (uint16_t)v >> 8;
+}
+
+esp_err_t imu_trace_load_bin(FILE *f, imu_trace_sample_t *buf, size_t capacity, size_t *count, uint8_t *range_g) {
+    uint8_t hdr[12];
+    if (fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr)) return ESP_ERR_INVALID_SIZE;
+    if (get_u32(hdr) != IMU_TRACE_MAGIC || hdr[4] != IMU_TRACE_VERSION) return ESP_ERR_INVALID_VERSION;
+
+    uint32_t n = get_u32(&hdr[8]);
+    if (n > capacity) return ESP_ERR_NO_MEM;
+    if (range_g) *range_g = hdr[6];
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint8_t r[IMU_TRACE_RECORD_SIZE];
+        if (fread(r, 1, sizeof(r), f) != sizeof(r)) return ESP_ERR_INVALID_SIZE;
+
+        imu_trace_sample_t *s = &buf[i];
+        s->t_ms = get_u32(r);
+        s->ax = get_i16(&r[4]);
+        s->ay = get_i16(&r[6]);
+        s->az = get_i16(&r[8]);
+        s->gx = get_i16(&r[10]);
+        s->gy = get_i16(&r[12]);
+        s->gz = get_i16(&r[14]);
+        s->flags = r[16];
+    }
+
+    *count = n;
+    return ESP_OK;
+}
+
+esp_err_t imu_trace_save_bin(FILE *f, const imu_trace_sample_t *trace, size_t count, uint8_t range_g) {
+    uint8_t hdr[12] = {0};
+    put_u32(hdr, IMU_TRACE_MAGIC);
+    hdr[4] = IMU_TRACE_VERSION;
+    hdr[6] = range_g;
+    put_u32(&hdr[8], (uint32_t)count);
+    if (fwrite(hdr, 1, sizeof(hdr), f) != sizeof(hdr)) return ESP_FAIL;
+
+    for (size_t i = 0; i < count; i++) {
+        const imu_trace_sample_t *s = &trace[i];
+        uint8_t r[IMU_TRACE_RECORD_SIZE] = {0};
+        put_u32(r, s->t_ms);
+        put_i16(&r[4], s->ax);
+        put_i16(&r[6], s->ay);
+        put_i16(&r[8], s->az);
+        put_i16(&r[10], s->gx);
+        put_i16(&r[12], s->gy);
+        put_i16(&r[14], s->gz);
+        r[16] = s->flags;
+        if (fwrite(r, 1, sizeof(r), f) != sizeof(r)) return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t imu_trace_load(const char *path, imu_trace_sample_t *buf, size_t capacity,
+                         size_t *count, uint8_t *range_g) {
+    size_t len = strlen(path);
+    bool csv = len > 4 && strcmp(path + len - 4, ".csv") == 0;
+
+    FILE *f = fopen(path, csv ? "r" : "rb");
+    if (!f) return ESP_ERR_NOT_FOUND;
+
+    esp_err_t err = csv ? imu_trace_load_csv(f, buf, capacity, count)
+                        : imu_trace_load_bin(f, buf, capacity, count, range_g);
+    fclose(f);
+    return err;
+}
+
+// --- Replay ---
+
+static uint32_t elapsed_ms(const imu_sim_t *sim) {
+    int64_t us = sim->cfg.clock(sim->cfg.clock_arg) - sim->t0_us;
+    return us > 0 ? (uint32_t)(us / 1000) : 0;
+}
+
+static int16_t rescale(const imu_sim_t *sim, int16_t v) {
+    uint8_t to = sim->imu.accel_range_g ? sim->imu.accel_range_g : sim->cfg.trace_range_g;
+    int32_t r = (int32_t)v * sim->cfg.trace_range_g / to;
+    if (r > INT16_MAX) r = INT16_MAX;
+    if (r < INT16_MIN) r = INT16_MIN;
+    return (int16_t)r;
+}
+
+static void raise_int(imu_sim_t *sim, bool injected) {
+    if (sim->imu.mode != IMU_MODE_MOTION) return;
+
+    if (injected) sim->stats.ints_injected++;
+    else sim->stats.ints_emulated++;
+
+    // Latched: only a new assertion produces an edge
+    if (!(sim->int_status & IMU_INT_STATUS_MOTION)) {
+        sim->int_status |= IMU_INT_STATUS_MOTION;
+        if (sim->on_int) sim->on_int(sim->int_arg, false);
+    }
+}
+
+// Sample-to-sample change stands in for the sensor's high-pass filtered
+// accel; the duration counter runs in ms like MOT_DUR
+static void emulate_motion(imu_sim_t *sim, const mpu6050_raw_sample_t *r, uint32_t t_ms) {
+    if (sim->has_prev) {
+        int32_t d = abs(r->ax - sim->prev[0]);
+        int32_t dy = abs(r->ay - sim->prev[1]);
+        int32_t dz = abs(r->az - sim->prev[2]);
+        if (dy > d) d = dy;
+        if (dz > d) d = dz;
+
+        uint16_t lsb = imu_accel_lsb_per_g(sim->imu.accel_range_g);
+        uint32_t d_mg = lsb ? (uint32_t)d * 1000 / lsb : 0;
+        if (d_mg > (uint32_t)sim->imu.motion_threshold * 2) {
+            uint32_t dt = t_ms - sim->prev_t_ms;
+            sim->motion_ms += dt ? dt : 1;
+            if (sim->motion_ms >= sim->imu.motion_duration) raise_int(sim, false);
+        } else {
+            sim->motion_ms = 0;
+        }
+    }
+    sim->prev[0] = r->ax;
+    sim->prev[1] = r->ay;
+    sim->prev[2] = r->az;
+    sim->prev_t_ms = t_ms;
+    sim->has_prev = true;
+}
+
+static void fifo_push(imu_sim_t *sim, const mpu6050_raw_sample_t *r) {
+    mpu6050_raw_sample_t *slot = &sim->fifo[sim->head];
+    memset(slot, 0, sizeof(*slot));
+    slot->ax = r->ax;   // Accel-only frames, as configured on the hardware
+    slot->ay = r->ay;
+    slot->az = r->az;
+
+    sim->head = (sim->head + 1) % IMU_SIM_FIFO_SAMPLES;
+    if (sim->count < IMU_SIM_FIFO_SAMPLES) sim->count++;
+    else sim->stats.fifo_overflows++;    // Oldest frame overwritten
+    sim->stats.streamed++;
+}
+
+static void replay_sample(imu_sim_t *sim, const imu_trace_sample_t *s, uint32_t t_ms) {
+    mpu6050_raw_sample_t r = {0};
+    r.ax = rescale(sim, s->ax);
+    r.ay = rescale(sim, s->ay);
+    r.az = rescale(sim, s->az);
+    if (!sim->imu.gyro_standby) {
+        r.gx = s->gx;
+        r.gy = s->gy;
+        r.gz = s->gz;
+    }
+    if (!sim->imu.temp_disable) {
+        r.temp = (int16_t)(((int32_t)sim->cfg.temp_centi - 3653) * 17 / 5);
+    }
+    sim->latest = r;
+    sim->has_latest = true;
+    sim->stats.replayed++;
+
+    // In cycle mode the sensor only sees one sample per wake-up
+    if (sim->imu.mode == IMU_MODE_MOTION &&
+        (sim->imu.lp_wake_hz == 0 || t_ms - sim->prev_t_ms >= 1000u / sim->imu.lp_wake_hz || !sim->has_prev)) {
+        emulate_motion(sim, &r, t_ms);
+    }
+    if (s->flags & IMU_TRACE_FLAG_INT) raise_int(sim, true);
+
+    uint16_t odr = sim->imu.stream_odr_hz;
+    if (odr && t_ms >= sim->next_emit_ms) {
+        fifo_push(sim, &r);
+        uint32_t period = 1000 / odr;
+        sim->next_emit_ms += period;
+        if (sim->next_emit_ms <= t_ms) sim->next_emit_ms = t_ms + period;
+    }
+}
+
+void imu_sim_init(imu_sim_t *sim, const imu_sim_config_t *cfg) {
+    memset(sim, 0, sizeof(*sim));
+    sim->cfg = *cfg;
+    if (sim->cfg.trace_range_g == 0) sim->cfg.trace_range_g = 4;
+    sim->t0_us = cfg->clock(cfg->clock_arg);
+}
+
+void imu_sim_advance(imu_sim_t *sim) {
+    const imu_trace_sample_t *trace = sim->cfg.trace;
+    size_t count = sim->cfg.count;
+    if (count == 0) return;
+
+    uint32_t now_ms = elapsed_ms(sim);
+    while (1) {
+        if (sim->next >= count) {
+            if (!sim->cfg.loop) break;
+            // Next loop starts one sample period after the last sample
+            uint32_t span = trace[count - 1].t_ms - trace[0].t_ms;
+            uint32_t period = count > 1 ? span / (uint32_t)(count - 1) : 1;
+            sim->loop_offset_ms += span + (period ? period : 1);
+            sim->next = 0;
+        }
+
+        const imu_trace_sample_t *s = &trace[sim->next];
+        uint32_t t_ms = s->t_ms - trace[0].t_ms + sim->loop_offset_ms;
+        if (t_ms > now_ms) break;
+
+        replay_sample(sim, s, t_ms);
+        sim->next++;
+    }
+}
+
+bool imu_sim_done(const imu_sim_t *sim) {
+    return !sim->cfg.loop && sim->next >= sim->cfg.count;
+}
+
+// --- Backend interface ---
+
+static esp_err_t sim_init(void *ctx, imu_int_cb_t on_int, void *int_arg) {
+    imu_sim_t *sim = (imu_sim_t *)ctx;
+    sim->on_int = on_int;
+    sim->int_arg = int_arg;
+    return ESP_OK;
+}
+
+static esp_err_t sim_configure(void *ctx, const imu_config_t *cfg) {
+    imu_sim_t *sim = (imu_sim_t *)ctx;
+    if (imu_accel_lsb_per_g(cfg->accel_range_g) == 0) return ESP_ERR_INVALID_ARG;
+    if (cfg->lp_wake_hz && cfg->stream_odr_hz) return ESP_ERR_INVALID_ARG;
+
+    imu_sim_advance(sim);
+    if (cfg->mode != sim->imu.mode || cfg->stream_odr_hz != sim->imu.stream_odr_hz) {
+        sim->head = 0;
+        sim->count = 0;
+        sim->next_emit_ms = elapsed_ms(sim);
+        sim->motion_ms = 0;
+    }
+    sim->imu = *cfg;
+    return ESP_OK;
+}
+
+static esp_err_t sim_read_batch(void *ctx, mpu6050_raw_sample_t *out, uint16_t max, uint16_t *read) {
+    imu_sim_t *sim = (imu_sim_t *)ctx;
+    uint16_t n = 0;
+
+    imu_sim_advance(sim);
+    if (sim->imu.stream_odr_hz) {
+        while (n < max && sim->count > 0) {
+            uint16_t tail = (sim->head + IMU_SIM_FIFO_SAMPLES - sim->count) % IMU_SIM_FIFO_SAMPLES;
+            out[n++] = sim->fifo[tail];
+            sim->count--;
+        }
+    }
+    else if (max > 0 && sim->has_latest) {
+        out[n++] = sim->latest;
+    }
+
+    if (read) *read = n;
+    return ESP_OK;
+}
+
+static esp_err_t sim_read_int_status(void *ctx, uint8_t *status) {
+    imu_sim_t *sim = (imu_sim_t *)ctx;
+    imu_sim_advance(sim);
+    *status = sim->int_status;
+    sim->int_status = 0;
+    return ESP_OK;
+}
+
+static esp_err_t sim_read_temp(void *ctx, int16_t *temp_centi) {
+    imu_sim_t *sim = (imu_sim_t *)ctx;
+    if (sim->imu.temp_disable) return ESP_ERR_INVALID_STATE;
+    *temp_centi = sim->cfg.temp_centi;
+    return ESP_OK;
+}
+
+static const imu_backend_ops_t s_sim_ops = {
+    .name = "sim",
+    .init = sim_init,
+    .configure = sim_configure,
+    .read_batch = sim_read_batch,
+    .read_int_status = sim_read_int_status,
+    .read_temp = sim_read_temp,
+};
+
+imu_backend_t imu_sim_backend(imu_sim_t *sim) {
+    imu_backend_t b = { .ops = &s_sim_ops, .ctx = sim };
+    return b;
+}
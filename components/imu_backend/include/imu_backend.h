@@ -0,0 +1,87 @@
+#ifndef IMU_BACKEND_H
+#define IMU_BACKEND_H
+
+/*
+ * IMU backend interface. mpu_monitor talks to the sensor only through this
+ * table, so the detection path runs unchanged on the real MPU-6050 or on a
+ * simulated backend replaying recorded traces on the host (imu_sim.h).
+ * No ESP-IDF dependencies beyond esp_err_t.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "mpu6050_convert.h"
+
+#define IMU_INT_STATUS_MOTION (0x40)   // Same bit as the MPU-6050 INT_STATUS
+
+typedef enum {
+    IMU_MODE_NORMAL,         // All sensors on, INT disabled
+    IMU_MODE_MOTION,         // Low-power accel, gyro in standby, motion INT enabled
+} imu_mode_t;
+
+typedef struct {
+    imu_mode_t mode;
+    uint8_t accel_range_g;   // 2, 4, 8 or 16
+    uint8_t motion_threshold;// 1 LSB = 2 mg (IMU_MODE_MOTION)
+    uint8_t motion_duration; // ms (IMU_MODE_MOTION)
+    uint16_t stream_odr_hz;  // Accel sample stream for read_batch; 0 = off
+    uint16_t dlpf_hz;        // Low-pass bandwidth, rounded up to a supported one; 0 = widest
+    uint8_t lp_wake_hz;      // 0 = continuous, else accel cycles at 1 (1.25), 5, 20 or 40 Hz.
+                             // No stream in cycle mode.
+    bool gyro_standby;
+    bool temp_disable;
+} imu_config_t;
+
+/**
+ * Interrupt callback. The hardware backend calls it from the GPIO ISR
+ * (in_isr = true), the simulator from the thread that advances it.
+ */
+typedef void (*imu_int_cb_t)(void *arg, bool in_isr);
+
+typedef struct {
+    const char *name;
+    esp_err_t (*init)(void *ctx, imu_int_cb_t on_int, void *int_arg);
+    // Applies a whole configuration; only what changed is written.
+    // ESP_ERR_INVALID_ARG for a stream in cycle mode.
+    esp_err_t (*configure)(void *ctx, const imu_config_t *cfg);
+    // Streaming: queued samples (up to max). Otherwise one fresh sample.
+    esp_err_t (*read_batch)(void *ctx, mpu6050_raw_sample_t *out, uint16_t max, uint16_t *read);
+    // Reads and clears the latched interrupt status
+    esp_err_t (*read_int_status)(void *ctx, uint8_t *status);
+    // Die temperature (0.01 C). ESP_ERR_INVALID_STATE while temp_disable is set.
+    esp_err_t (*read_temp)(void *ctx, int16_t *temp_centi);
+} imu_backend_ops_t;
+
+typedef struct {
+    const imu_backend_ops_t *ops;
+    void *ctx;
+} imu_backend_t;
+
+static inline esp_err_t imu_backend_init(const imu_backend_t *b, imu_int_cb_t on_int, void *arg) {
+    return b->ops->init(b->ctx, on_int, arg);
+}
+
+static inline esp_err_t imu_backend_configure(const imu_backend_t *b, const imu_config_t *cfg) {
+    return b->ops->configure(b->ctx, cfg);
+}
+
+static inline esp_err_t imu_backend_read_batch(const imu_backend_t *b, mpu6050_raw_sample_t *out,
+                                               uint16_t max, uint16_t *read) {
+    return b->ops->read_batch(b->ctx, out, max, read);
+}
+
+static inline esp_err_t imu_backend_read_int_status(const imu_backend_t *b, uint8_t *status) {
+    return b->ops->read_int_status(b->ctx, status);
+}
+
+static inline esp_err_t imu_backend_read_temp(const imu_backend_t *b, int16_t *temp_centi) {
+    return b->ops->read_temp(b->ctx, temp_centi);
+}
+
+/**
+ * @brief Accel sensitivity for a range (LSB per g).
+ */
+uint16_t imu_accel_lsb_per_g(uint8_t accel_range_g);
+
+#endif // IMU_BACKEND_H
@@ -0,0 +1,16 @@
+#ifndef IMU_BACKEND_MPU6050_H
+#define IMU_BACKEND_MPU6050_H
+
+#include "driver/gpio.h"
+#include "mpu6050.h"
+#include "imu_backend.h"
+
+typedef struct {
+    mpu6050_config_t bus;
+    gpio_num_t int_pin;      // MPU INT output (active high, latched)
+} imu_mpu6050_config_t;
+
+// Hardware backend on top of the mpu6050 driver (single instance)
+imu_backend_t imu_backend_mpu6050(const imu_mpu6050_config_t *conf);
+
+#endif // IMU_BACKEND_MPU6050_H
@@ -0,0 +1,103 @@
+#ifndef IMU_SIM_H
+#define IMU_SIM_H
+
+/*
+ * Simulated IMU backend replaying a recorded trace against a caller-supplied
+ * clock. Samples become visible when the clock passes their timestamp, the
+ * accel stream is resampled to the configured ODR through a FIFO of the
+ * same size as the MPU-6050 one, and the motion interrupt is emulated from
+ * the trace (plus events injected by the trace itself). Pure C + stdio,
+ * built only by the host tools, not by the firmware.
+ *
+ * INT events are raised from imu_sim_advance(), which the caller invokes
+ * while stepping its virtual clock (see tools/motion_bench).
+ */
+
+#include <stdio.h>
+#include "imu_backend.h"
+
+#define IMU_SIM_FIFO_SAMPLES (170)        // 1024 B FIFO / 6 B accel frame
+#define IMU_TRACE_FLAG_INT   (0x01)       // Force a motion interrupt at this sample
+
+// Binary trace: header followed by 'count' little-endian records
+#define IMU_TRACE_MAGIC      0x54554D49u  // "IMUT"
+#define IMU_TRACE_VERSION    1
+#define IMU_TRACE_RECORD_SIZE (18)        // u32 t_ms, 6 x i16, u8 flags, u8 pad
+
+typedef struct {
+    uint32_t t_ms;
+    int16_t ax, ay, az;      // Raw LSB at the trace's accel range
+    int16_t gx, gy, gz;
+    uint8_t flags;
+} imu_trace_sample_t;
+
+typedef int64_t (*imu_sim_clock_t)(void *arg);
+
+typedef struct {
+    const imu_trace_sample_t *trace;
+    size_t count;
+    uint8_t trace_range_g;   // Accel range the trace was recorded at
+    bool loop;               // Restart the trace when it ends
+    int16_t temp_centi;      // Reported die temperature (traces carry none), 0.01 C
+    imu_sim_clock_t clock;   // Microseconds, monotonic
+    void *clock_arg;
+} imu_sim_config_t;
+
+typedef struct {
+    uint32_t replayed;       // Trace samples consumed
+    uint32_t streamed;       // Samples pushed to the FIFO
+    uint32_t fifo_overflows; // Samples lost because nobody drained in time
+    uint32_t ints_emulated;  // Interrupts raised by the motion emulation
+    uint32_t ints_injected;  // Interrupts forced by IMU_TRACE_FLAG_INT
+} imu_sim_stats_t;
+
+typedef struct {
+    imu_sim_config_t cfg;
+    imu_config_t imu;
+    imu_int_cb_t on_int;
+    void *int_arg;
+    int64_t t0_us;           // Clock time of the first trace sample
+    uint32_t loop_offset_ms; // Added to trace time after each loop
+    size_t next;
+    uint32_t next_emit_ms;
+    mpu6050_raw_sample_t fifo[IMU_SIM_FIFO_SAMPLES];
+    uint16_t head;
+    uint16_t count;
+    mpu6050_raw_sample_t latest;
+    bool has_latest;
+    int16_t prev[3];
+    uint32_t prev_t_ms;
+    bool has_prev;
+    uint32_t motion_ms;      // Time above the motion threshold
+    uint8_t int_status;      // Latched until read
+    imu_sim_stats_t stats;
+} imu_sim_t;
+
+/**
+ * @brief Load a trace, CSV or binary (chosen by the ".csv" extension).
+ * CSV: one sample per line "t_ms,ax,ay,az[,gx,gy,gz[,int]]"; lines that
+ * do not start with a digit are skipped.
+ * @param range_g Set from the binary header; left untouched for CSV.
+ */
+esp_err_t imu_trace_load(const char *path, imu_trace_sample_t *buf, size_t capacity,
+                         size_t *count, uint8_t *range_g);
+esp_err_t imu_trace_load_csv(FILE *f, imu_trace_sample_t *buf, size_t capacity, size_t *count);
+esp_err_t imu_trace_load_bin(FILE *f, imu_trace_sample_t *buf, size_t capacity, size_t *count, uint8_t *range_g);
+esp_err_t imu_trace_save_bin(FILE *f, const imu_trace_sample_t *trace, size_t count, uint8_t range_g);
+
+void imu_sim_init(imu_sim_t *sim, const imu_sim_config_t *cfg);
+
+/**
+ * @brief Replay every trace sample up to the current clock time.
+ * Raises the INT callback (in_isr = false) on a new latched interrupt.
+ */
+void imu_sim_advance(imu_sim_t *sim);
+
+/**
+ * @brief True once a non-looping trace has been fully replayed.
+ */
+bool imu_sim_done(const imu_sim_t *sim);
+
+imu_backend_t imu_sim_backend(imu_sim_t *sim);
+
+#endif // IMU_SIM_H
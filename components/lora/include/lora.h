@@ -2,8 +2,17 @@
 #define LORA_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "esp_err.h"
 
+// Tryby pracy E32 (M1 M0)
+typedef enum {
+    LORA_MODE_NORMAL = 0,       // 0 0 - nadawanie i odbiór
+    LORA_MODE_WAKEUP = 1,       // 0 1 - nadawanie z preambułą budzącą
+    LORA_MODE_POWER_SAVING = 2, // 1 0 - odbiór cykliczny (tylko ramki z preambułą)
+    LORA_MODE_SLEEP = 3,        // 1 1 - uśpienie / konfiguracja
+} lora_mode_t;
+
 // Inicjalizacja sprzętu (UART + GPIO)
 esp_err_t lora_init(void);
 
@@ -15,4 +24,10 @@ int lora_receive(uint8_t* buffer, uint32_t size, uint32_t timeout_ms);
 
 void lora_receiver_task(void *pvParameters);
 
+// Przełączenie trybu modułu (czeka na gotowość AUX)
+void lora_set_mode(lora_mode_t mode);
+
+// Moduł zajęty (nadaje / wysyła odebrane dane na UART)
+bool lora_is_busy(void);
+
 #endif
\ No newline at end of file
@@ -7,11 +7,13 @@
 #include "esp_log.h"
 #include "nvs_store.h"
 #include "arming_manager.h"
-#include "mpu6050.h"
+#include "mpu_monitor.h"
+#include "pretrigger.h"
 #include "freertos/semphr.h"
 
 static const char *TAG = "LORA";
 static SemaphoreHandle_t lora_uart_mutex = NULL;
+static uint8_t s_dump_buf[PRETRIGGER_RECORD_SIZE(PRETRIGGER_SAMPLES)];
 
 // Pomocnicza funkcja czekająca, aż moduł skończy pracę
 static void wait_for_aux() {
@@ -66,6 +68,17 @@ esp_err_t lora_init(void) {
     return ESP_OK;
 }
 
+void lora_set_mode(lora_mode_t mode) {
+    wait_for_aux(); // Zmiana trybu w trakcie nadawania gubi ramkę
+    gpio_set_level(LORA_M0_PIN, mode & 0x01);
+    gpio_set_level(LORA_M1_PIN, (mode >> 1) & 0x01);
+    wait_for_aux();
+}
+
+bool lora_is_busy(void) {
+    return gpio_get_level(LORA_AUX_PIN) == LORA_AUX_BUSY_LEVEL;
+}
+
 int lora_send(const uint8_t* data, uint32_t len) {
     ESP_LOGI(TAG, "Waiting for send");
     wait_for_aux(); 
@@ -90,6 +103,39 @@ int lora_receive(uint8_t* buffer, uint32_t size, uint32_t timeout_ms) {
     return 0;
 }
 
+// Wysyła zapis sprzed ostatniego alarmu w ramkach <.../pretrigger=idx/total:hex>
+static void send_pretrigger_dump(const char *user, const char *device) {
+    static const char hex[] = "0123456789ABCDEF";
+    char message[64 + 2 * LORA_DUMP_CHUNK_BYTES + 128];
+    size_t len = sizeof(s_dump_buf);
+
+    esp_err_t err = nvs_load_pretrigger(s_dump_buf, &len);
+    if (err != ESP_OK || !pretrigger_record_valid(s_dump_buf, len)) {
+        ESP_LOGW(TAG, "No valid pre-trigger capture (%s)", esp_err_to_name(err));
+        int n = snprintf(message, sizeof(message),
+                         "<system_iot/%s/%s/pretrigger={\"state\":\"EMPTY\"}>", user, device);
+        lora_send((uint8_t*)message, n);
+        return;
+    }
+
+    unsigned total = (len + LORA_DUMP_CHUNK_BYTES - 1) / LORA_DUMP_CHUNK_BYTES;
+    ESP_LOGI(TAG, "Sending pre-trigger capture: %u B in %u frames", (unsigned)len, total);
+
+    for (unsigned idx = 0; idx < total; idx++) {
+        int n = snprintf(message, sizeof(message), "<system_iot/%s/%s/pretrigger=%u/%u:",
+                         user, device, idx, total);
+        size_t off = (size_t)idx * LORA_DUMP_CHUNK_BYTES;
+        size_t chunk = (len - off < LORA_DUMP_CHUNK_BYTES) ? len - off : LORA_DUMP_CHUNK_BYTES;
+        for (size_t i = 0; i < chunk; i++) {
+            message[n++] = hex[s_dump_buf[off + i] >> 4];
+            message[n++] = hex[s_dump_buf[off + i] & 0x0F];
+        }
+        message[n++] = '>';
+        lora_send((uint8_t*)message, n);
+        vTaskDelay(pdMS_TO_TICKS(LORA_DUMP_GAP_MS));
+    }
+}
+
 void process_lora_frame(char *raw_data, int len) {
     // 1. Szukamy ograniczników < oraz >
     char *start = strchr(raw_data, '<');
@@ -140,7 +186,26 @@ void process_lora_frame(char *raw_data, int len) {
             } else if (strcmp(command, "threshold") == 0) {
                 ESP_LOGI(TAG, "Received LORA -> Topic: %s | Data: %s", topic, data);
                 int threshold = atoi(data);
-                mpu6050_enable_motion_detection(threshold, 1);
+                if (threshold < 1 || threshold > 255) {
+                    ESP_LOGW(TAG, "Threshold out of range: %d", threshold);
+                    return;
+                }
+                // Czujnik należy do mpu_monitor - zmiana trafia do jego kolejki
+                mpu_monitor_set_threshold((uint8_t)threshold);
+            } else if (strcmp(command, "profile") == 0) {
+                ESP_LOGI(TAG, "Received LORA -> Topic: %s | Data: %s", topic, data);
+                mpu_sensing_id_t sensing = mpu_sensing_from_name(data);
+                if (sensing == MPU_SENSING_COUNT) {
+                    ESP_LOGW(TAG, "Unknown sensing profile: %s", data);
+                    return;
+                }
+                // Profil dla stanu uzbrojenia - kasuje nadpisany próg
+                mpu_monitor_select_sensing(sensing);
+            } else if (strcmp(command, "pretrigger") == 0) {
+                ESP_LOGI(TAG, "Received LORA -> Topic: %s | Data: %s", topic, data);
+                if (strcmp(data, "GET") == 0) {
+                    send_pretrigger_dump(username, device);
+                }
             } else {
                 ESP_LOGI(TAG, "Unknown CMD: %s", command);
             }
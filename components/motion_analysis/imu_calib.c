@@ -0,0 +1,135 @@
+#include "imu_calib.h"
+#include <stddef.h>
+#include <string.h>
+
+// FNV-1a over the record up to (excluding) the checksum field
+static uint32_t record_checksum(const imu_calib_record_t *rec) {
+    const uint8_t *p = (const uint8_t *)rec;
+    uint32_t h = 2166136261u;
+
+    for (size_t i = 0; i < offsetof(imu_calib_record_t, checksum); i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void imu_calib_record_seal(imu_calib_record_t *rec) {
+    rec->magic = IMU_CALIB_MAGIC;
+    rec->version = IMU_CALIB_VERSION;
+    rec->checksum = record_checksum(rec);
+}
+
+bool imu_calib_record_valid(const imu_calib_record_t *rec) {
+    return rec->magic == IMU_CALIB_MAGIC &&
+           rec->version == IMU_CALIB_VERSION &&
+           rec->accel_lsb_per_g != 0 &&
+           rec->checksum == record_checksum(rec);
+}
+
+mpu6050_offsets_t imu_calib_record_offsets(const imu_calib_record_t *rec, uint16_t accel_lsb_per_g) {
+    mpu6050_offsets_t o = rec->offsets;
+
+    // Accel offsets are in LSB of the range used at calibration time
+    if (accel_lsb_per_g != rec->accel_lsb_per_g && rec->accel_lsb_per_g != 0) {
+        o.accel_x = (int16_t)((int32_t)o.accel_x * accel_lsb_per_g / rec->accel_lsb_per_g);
+        o.accel_y = (int16_t)((int32_t)o.accel_y * accel_lsb_per_g / rec->accel_lsb_per_g);
+        o.accel_z = (int16_t)((int32_t)o.accel_z * accel_lsb_per_g / rec->accel_lsb_per_g);
+    }
+    return o;
+}
+
+static void window_reset(imu_recal_t *rc) {
+    memset(rc->sum, 0, sizeof(rc->sum));
+    for (int i = 0; i < 6; i++) {
+        rc->min[i] = INT16_MAX;
+        rc->max[i] = INT16_MIN;
+    }
+    rc->temp_sum = 0;
+    rc->n = 0;
+}
+
+void imu_recal_init(imu_recal_t *rc, const imu_recal_config_t *cfg, const mpu6050_offsets_t *start) {
+    memset(rc, 0, sizeof(*rc));
+    rc->cfg = *cfg;
+    if (rc->cfg.window_samples == 0) rc->cfg.window_samples = 1;
+    rc->offsets = *start;
+    window_reset(rc);
+}
+
+static int16_t blend(int16_t current, int32_t target, uint8_t shift) {
+    return (int16_t)(current + ((target - current) >> shift));
+}
+
+static bool abs_within(int32_t v, int32_t limit) {
+    return v <= limit && v >= -limit;
+}
+
+bool imu_recal_update(imu_recal_t *rc, const mpu6050_raw_sample_t *s, bool has_gyro) {
+    const int16_t v[6] = { s->ax, s->ay, s->az, s->gx, s->gy, s->gz };
+    const int axes = has_gyro ? 6 : 3;
+
+    for (int i = 0; i < axes; i++) {
+        rc->sum[i] += v[i];
+        if (v[i] < rc->min[i]) rc->min[i] = v[i];
+        if (v[i] > rc->max[i]) rc->max[i] = v[i];
+    }
+    rc->temp_sum += s->temp;
+    rc->n++;
+
+    if (rc->n < rc->cfg.window_samples) return false;
+
+    // Window complete: still if every axis stayed inside its band
+    bool still = true;
+    for (int i = 0; i < axes; i++) {
+        int32_t band = (i < 3) ? rc->cfg.accel_band_lsb : rc->cfg.gyro_band_lsb;
+        if ((int32_t)rc->max[i] - rc->min[i] > band) {
+            still = false;
+            break;
+        }
+    }
+
+    bool changed = false;
+    if (still) {
+        int32_t mean[6];
+        for (int i = 0; i < axes; i++) mean[i] = rc->sum[i] / rc->n;
+
+        mpu6050_offsets_t prev = rc->offsets;
+        uint8_t shift = rc->cfg.blend_shift;
+        rc->observed_axes = 0;
+
+        if (has_gyro) {
+            rc->observed.gyro_x = (int16_t)mean[3];
+            rc->observed.gyro_y = (int16_t)mean[4];
+            rc->observed.gyro_z = (int16_t)mean[5];
+            rc->observed_axes |= 0x38;
+            rc->offsets.gyro_x = blend(rc->offsets.gyro_x, mean[3], shift);
+            rc->offsets.gyro_y = blend(rc->offsets.gyro_y, mean[4], shift);
+            rc->offsets.gyro_z = blend(rc->offsets.gyro_z, mean[5], shift);
+        }
+
+        // Same assumption as mpu6050_calibrate(): flat, gravity on +Z
+        int32_t one_g = rc->cfg.accel_lsb_per_g;
+        int32_t tol = rc->cfg.flat_tolerance_lsb;
+        if (one_g != 0 &&
+            abs_within(mean[0] - rc->offsets.accel_x, tol) &&
+            abs_within(mean[1] - rc->offsets.accel_y, tol) &&
+            abs_within(mean[2] - one_g - rc->offsets.accel_z, tol)) {
+            rc->observed.accel_x = (int16_t)mean[0];
+            rc->observed.accel_y = (int16_t)mean[1];
+            rc->observed.accel_z = (int16_t)(mean[2] - one_g);
+            rc->observed_axes |= 0x07;
+            rc->offsets.accel_x = blend(rc->offsets.accel_x, mean[0], shift);
+            rc->offsets.accel_y = blend(rc->offsets.accel_y, mean[1], shift);
+            rc->offsets.accel_z = blend(rc->offsets.accel_z, mean[2] - one_g, shift);
+        }
+
+        rc->windows++;
+        int32_t temp_raw = rc->temp_sum / rc->n;
+        rc->temp_centi = (int16_t)(temp_raw * 5 / 17 + 3653);
+        changed = (memcmp(&prev, &rc->offsets, sizeof(prev)) != 0);
+    }
+
+    window_reset(rc);
+    return changed;
+}
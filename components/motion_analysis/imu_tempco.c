@@ -0,0 +1,147 @@
+#include "imu_tempco.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// FNV-1a over the record up to (excluding) the checksum field
+static uint32_t record_checksum(const imu_tempco_record_t *rec) {
+    const uint8_t *p = (const uint8_t *)rec;
+    uint32_t h = 2166136261u;
+
+    for (size_t i = 0; i < offsetof(imu_tempco_record_t, checksum); i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void imu_tempco_init(imu_tempco_t *tc, const imu_tempco_config_t *cfg) {
+    memset(tc, 0, sizeof(*tc));
+    tc->cfg = *cfg;
+    if (tc->cfg.same_temp_every == 0) tc->cfg.same_temp_every = 1;
+}
+
+static void scale_accel(imu_tempco_axis_t axis[6], float ratio) {
+    for (int i = 0; i < 3; i++) {
+        axis[i].offset_mean *= ratio;
+        axis[i].s_to *= ratio;
+    }
+}
+
+bool imu_tempco_load(imu_tempco_t *tc, const imu_tempco_record_t *rec) {
+    if (rec->magic != IMU_TEMPCO_MAGIC || rec->version != IMU_TEMPCO_VERSION ||
+        rec->accel_lsb_per_g == 0 || rec->checksum != record_checksum(rec)) {
+        return false;
+    }
+
+    memcpy(tc->axis, rec->axis, sizeof(tc->axis));
+    if (tc->cfg.accel_lsb_per_g != 0 && tc->cfg.accel_lsb_per_g != rec->accel_lsb_per_g) {
+        scale_accel(tc->axis, (float)tc->cfg.accel_lsb_per_g / rec->accel_lsb_per_g);
+    }
+    tc->has_last = false;
+    tc->skipped = 0;
+    return true;
+}
+
+void imu_tempco_store(const imu_tempco_t *tc, imu_tempco_record_t *rec) {
+    memset(rec, 0, sizeof(*rec));
+    rec->magic = IMU_TEMPCO_MAGIC;
+    rec->version = IMU_TEMPCO_VERSION;
+    rec->accel_lsb_per_g = tc->cfg.accel_lsb_per_g;
+    memcpy(rec->axis, tc->axis, sizeof(rec->axis));
+    rec->checksum = record_checksum(rec);
+}
+
+void imu_tempco_set_accel_range(imu_tempco_t *tc, uint16_t accel_lsb_per_g) {
+    if (accel_lsb_per_g == 0 || accel_lsb_per_g == tc->cfg.accel_lsb_per_g) return;
+    if (tc->cfg.accel_lsb_per_g != 0) {
+        scale_accel(tc->axis, (float)accel_lsb_per_g / tc->cfg.accel_lsb_per_g);
+    }
+    tc->cfg.accel_lsb_per_g = accel_lsb_per_g;
+}
+
+// Weighted incremental (West) update of means and co-moments, old points decayed first
+static void axis_add(imu_tempco_axis_t *a, float t, float o, float w, float keep) {
+    a->weight = a->weight * keep + w;
+    a->s_tt *= keep;
+    a->s_to *= keep;
+
+    float dt = t - a->temp_mean;
+    a->temp_mean += dt * w / a->weight;
+    a->offset_mean += (o - a->offset_mean) * w / a->weight;
+    a->s_tt += w * dt * (t - a->temp_mean);
+    a->s_to += w * dt * (o - a->offset_mean);
+}
+
+bool imu_tempco_add(imu_tempco_t *tc, const mpu6050_offsets_t *offsets, uint8_t axes,
+                    int16_t temp_centi, float weight) {
+    if (axes == 0 || weight <= 0.0f) return false;
+
+    // Long still periods at one temperature would otherwise flood the fit
+    // and forget the points that give it its slope
+    if (tc->has_last && weight <= 1.0f &&
+        abs(temp_centi - tc->last_temp_centi) < tc->cfg.min_step_centi &&
+        ++tc->skipped < tc->cfg.same_temp_every) {
+        return false;
+    }
+    tc->skipped = 0;
+    tc->last_temp_centi = temp_centi;
+    tc->has_last = true;
+
+    const int16_t v[6] = { offsets->accel_x, offsets->accel_y, offsets->accel_z,
+                           offsets->gyro_x, offsets->gyro_y, offsets->gyro_z };
+    const float keep = tc->cfg.memory_points ? 1.0f - 1.0f / tc->cfg.memory_points : 1.0f;
+    const float t = temp_centi * 0.01f;
+
+    for (int i = 0; i < 6; i++) {
+        if (axes & (1u << i)) axis_add(&tc->axis[i], t, (float)v[i], weight, keep);
+    }
+    return true;
+}
+
+static int16_t clamp_i16(float v) {
+    if (v > 32767.0f) return 32767;
+    if (v < -32768.0f) return -32768;
+    return (int16_t)lrintf(v);
+}
+
+int imu_tempco_model(const imu_tempco_t *tc, const mpu6050_offsets_t *fallback,
+                     mpu6050_tempco_t *out) {
+    const int16_t fb[6] = { fallback->accel_x, fallback->accel_y, fallback->accel_z,
+                            fallback->gyro_x, fallback->gyro_y, fallback->gyro_z };
+    const float span = tc->cfg.min_span_centi * 0.01f;
+    const float ref = IMU_TEMPCO_REF_CENTI * 0.01f;
+    int16_t base[6];
+    int modelled = 0;
+
+    memset(out, 0, sizeof(*out));
+    out->ref_temp_centi = IMU_TEMPCO_REF_CENTI;
+
+    for (int i = 0; i < 6; i++) {
+        const imu_tempco_axis_t *a = &tc->axis[i];
+        float max_slope = i < 3 ? tc->cfg.max_accel_slope_g * tc->cfg.accel_lsb_per_g
+                                : tc->cfg.max_gyro_slope_dps * tc->cfg.gyro_lsb_per_dps;
+
+        if (a->weight < tc->cfg.min_points || a->s_tt < span * span * a->weight) {
+            base[i] = fb[i];
+            continue;
+        }
+
+        float slope = a->s_to / a->s_tt;
+        if (slope > max_slope) slope = max_slope;
+        if (slope < -max_slope) slope = -max_slope;
+
+        base[i] = clamp_i16(a->offset_mean + slope * (ref - a->temp_mean));
+        out->slope_q8[i] = clamp_i16(slope * 256.0f);
+        modelled++;
+    }
+
+    out->base.accel_x = base[0];
+    out->base.accel_y = base[1];
+    out->base.accel_z = base[2];
+    out->base.gyro_x = base[3];
+    out->base.gyro_y = base[4];
+    out->base.gyro_z = base[5];
+    return modelled;
+}
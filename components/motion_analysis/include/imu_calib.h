@@ -0,0 +1,79 @@
+#ifndef IMU_CALIB_H
+#define IMU_CALIB_H
+
+/*
+ * IMU calibration record (persisted) and background recalibration.
+ * Recalibration accumulates raw samples into fixed-length windows; a window
+ * in which every axis stayed within a small band counts as "still" and is
+ * blended into the offsets. O(1) per sample, no blocking, no ESP-IDF deps.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mpu6050_convert.h"
+
+#define IMU_CALIB_MAGIC    0x494D5543u   // "IMUC"
+#define IMU_CALIB_VERSION  1
+
+// Persisted calibration (NVS blob)
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t accel_lsb_per_g;    // Accel range the offsets are expressed in
+    mpu6050_offsets_t offsets;
+    int16_t temp_centi;          // Temperature at calibration (0.01 C)
+    uint16_t windows;            // Stillness windows merged since the last full calibration
+    uint32_t checksum;
+} imu_calib_record_t;
+
+typedef struct {
+    uint16_t window_samples;     // Samples per stillness window
+    uint16_t accel_band_lsb;     // Max peak-to-peak per accel axis inside a still window
+    uint16_t gyro_band_lsb;      // Max peak-to-peak per gyro axis inside a still window
+    uint16_t accel_lsb_per_g;    // 1 g in LSB (current range); 0 = never touch accel offsets
+    uint16_t flat_tolerance_lsb; // Accel offsets are only learnt while lying flat (Z up)
+    uint8_t blend_shift;         // offset += (window_mean - offset) >> blend_shift
+} imu_recal_config_t;
+
+typedef struct {
+    imu_recal_config_t cfg;
+    mpu6050_offsets_t offsets;   // Current estimate
+    int32_t sum[6];
+    int16_t min[6];
+    int16_t max[6];
+    int32_t temp_sum;
+    uint16_t n;
+    uint16_t windows;            // Accepted windows
+    int16_t temp_centi;          // Mean temperature of the last accepted window
+    mpu6050_offsets_t observed;  // Raw offsets measured by the last accepted window
+    uint8_t observed_axes;       // Bit i set: axis i (ax..gz) of 'observed' is valid
+} imu_recal_t;
+
+/**
+ * @brief Fill in magic, version and checksum.
+ */
+void imu_calib_record_seal(imu_calib_record_t *rec);
+
+/**
+ * @brief Check magic, version and checksum.
+ */
+bool imu_calib_record_valid(const imu_calib_record_t *rec);
+
+/**
+ * @brief Offsets of a record expressed for another accel range.
+ */
+mpu6050_offsets_t imu_calib_record_offsets(const imu_calib_record_t *rec, uint16_t accel_lsb_per_g);
+
+/**
+ * @brief Start background recalibration from the given offsets.
+ */
+void imu_recal_init(imu_recal_t *rc, const imu_recal_config_t *cfg, const mpu6050_offsets_t *start);
+
+/**
+ * @brief Feed one raw sample.
+ * @param has_gyro false for accel-only sources (gyro offsets are left alone).
+ * @return true when a still window was accepted and the offsets changed.
+ */
+bool imu_recal_update(imu_recal_t *rc, const mpu6050_raw_sample_t *s, bool has_gyro);
+
+#endif // IMU_CALIB_H
@@ -0,0 +1,97 @@
+#ifndef IMU_TEMPCO_H
+#define IMU_TEMPCO_H
+
+/*
+ * Offset-vs-temperature model, one straight line per axis, learnt from the
+ * stillness windows found by imu_recal. Each window contributes a (mean
+ * temperature, measured offset) point to a weighted least-squares fit with
+ * exponential forgetting, so the model follows ageing and remounting. A
+ * slope is only used once the points span enough temperature; until then the
+ * plain recalibrated offsets apply. No ESP-IDF dependencies.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mpu6050_convert.h"
+
+#define IMU_TEMPCO_MAGIC    0x494D5443u   // "IMTC"
+#define IMU_TEMPCO_VERSION  1
+#define IMU_TEMPCO_REF_CENTI 2500         // Reference temperature of the produced model
+
+// Running fit of one axis (units: C and LSB)
+typedef struct {
+    float weight;                // Decayed number of points
+    float temp_mean;
+    float offset_mean;
+    float s_tt;                  // Weighted sum of squared temperature deviations
+    float s_to;                  // Weighted temperature/offset co-deviation
+} imu_tempco_axis_t;
+
+typedef struct {
+    uint16_t accel_lsb_per_g;    // Range the accel axes are expressed in
+    uint16_t gyro_lsb_per_dps;
+    uint16_t memory_points;      // Forgetting: older points fade by (1 - 1/memory); 0 = never
+    uint16_t min_points;         // Points per axis before its slope is trusted
+    uint16_t min_span_centi;     // Temperature spread (1 sigma) needed for a slope
+    uint16_t min_step_centi;     // Points closer than this to the previous one...
+    uint16_t same_temp_every;    // ...are only taken every Nth window
+    float max_accel_slope_g;     // Plausibility clamp (g per C)
+    float max_gyro_slope_dps;    // Plausibility clamp (deg/s per C)
+} imu_tempco_config_t;
+
+typedef struct {
+    imu_tempco_config_t cfg;
+    imu_tempco_axis_t axis[6];   // ax, ay, az, gx, gy, gz
+    int16_t last_temp_centi;
+    uint16_t skipped;
+    bool has_last;
+} imu_tempco_t;
+
+// Persisted fit (NVS blob)
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t accel_lsb_per_g;
+    imu_tempco_axis_t axis[6];
+    uint32_t checksum;
+} imu_tempco_record_t;
+
+/**
+ * @brief Start with an empty fit.
+ */
+void imu_tempco_init(imu_tempco_t *tc, const imu_tempco_config_t *cfg);
+
+/**
+ * @brief Replace the fit with a persisted one (accel rescaled to cfg range).
+ * @return false if the record is not valid; the fit is left untouched.
+ */
+bool imu_tempco_load(imu_tempco_t *tc, const imu_tempco_record_t *rec);
+
+/**
+ * @brief Export the fit as a sealed record.
+ */
+void imu_tempco_store(const imu_tempco_t *tc, imu_tempco_record_t *rec);
+
+/**
+ * @brief Re-express the accel axes for another accel range.
+ */
+void imu_tempco_set_accel_range(imu_tempco_t *tc, uint16_t accel_lsb_per_g);
+
+/**
+ * @brief Add a measured offset point.
+ * @param axes Bit i set: axis i (ax..gz) of 'offsets' is valid.
+ * @param weight 1 for a stillness window, more for a full calibration.
+ * @return true if the point was used (not thinned out).
+ */
+bool imu_tempco_add(imu_tempco_t *tc, const mpu6050_offsets_t *offsets, uint8_t axes,
+                    int16_t temp_centi, float weight);
+
+/**
+ * @brief Build the conversion model. Axes without a trusted slope take the
+ * offset from 'fallback' with zero slope.
+ * @return Number of axes with a temperature slope.
+ */
+int imu_tempco_model(const imu_tempco_t *tc, const mpu6050_offsets_t *fallback,
+                     mpu6050_tempco_t *out);
+
+#endif // IMU_TEMPCO_H
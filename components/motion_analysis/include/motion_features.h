@@ -0,0 +1,89 @@
+#ifndef MOTION_FEATURES_H
+#define MOTION_FEATURES_H
+
+/*
+ * Streaming motion features over the accelerometer sample stream.
+ * Every update is O(1): windowed statistics are kept as running sums over
+ * fixed-size rings, so the cost per sample does not depend on the window length.
+ * No ESP-IDF dependencies - the engine can be replayed on a host.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mpu6050_convert.h"
+
+#define MOTION_FEATURES_MAX_WINDOW 128   // Max samples per analysis window
+
+// Decision rule: when does a hardware motion interrupt escalate to an alarm
+typedef struct {
+    uint16_t sample_rate_hz;    // Rate of the samples fed to the engine
+    uint16_t window_samples;    // RMS / jerk / variance window (<= MOTION_FEATURES_MAX_WINDOW)
+    uint16_t active_mg;         // Dynamic accel above which a sample counts as "moving"
+    uint16_t gap_ms;            // Quiet time tolerated inside one sustained motion
+    uint16_t sustained_ms;      // Required continuous motion before escalating
+    uint16_t rms_mg;            // Windowed RMS of dynamic accel that qualifies
+    uint32_t jerk_mg_s;         // Windowed RMS jerk that qualifies (0 = unused)
+    uint32_t min_variance_mg2;  // Min variance of |a| over the window (0 = unused)
+} motion_rule_t;
+
+// Snapshot of the current features
+typedef struct {
+    uint16_t rms_mg;            // RMS of dynamic (gravity-removed) accel over the window
+    uint32_t jerk_mg_s;         // RMS jerk over the window
+    uint32_t variance_mg2;      // Variance of the accel magnitude over the window
+    uint32_t sustained_ms;      // Duration of the current motion episode
+    uint32_t samples;           // Samples processed since reset
+} motion_features_t;
+
+// Engine state. Caller owns the memory (typically static).
+typedef struct {
+    motion_rule_t rule;
+    uint16_t window;            // Effective window length
+    uint16_t pos;               // Next ring slot
+    uint16_t filled;            // Valid ring entries
+
+    uint32_t energy[MOTION_FEATURES_MAX_WINDOW];   // |dyn|^2 (mg^2)
+    uint32_t jerk_sq[MOTION_FEATURES_MAX_WINDOW];  // |d dyn|^2 (mg^2 per sample^2)
+    int32_t magnitude[MOTION_FEATURES_MAX_WINDOW]; // |a| (mg)
+
+    uint64_t energy_sum;
+    uint64_t jerk_sq_sum;
+    int64_t mag_sum;
+    uint64_t mag_sq_sum;
+
+    int32_t gravity[3];         // Slow EMA of each axis (mg, Q4)
+    int32_t prev_dyn[3];        // Previous dynamic accel (mg)
+    bool primed;                // Gravity estimate initialised
+
+    uint32_t active_samples;    // Length of the current motion episode (samples)
+    uint32_t quiet_samples;     // Quiet samples since last active one
+    uint32_t samples;
+} motion_features_state_t;
+
+/**
+ * @brief Reset the engine and apply a rule.
+ */
+void motion_features_init(motion_features_state_t *st, const motion_rule_t *rule);
+
+/**
+ * @brief Feed one accel sample (Q16 g, as produced by mpu6050_convert_q16()).
+ */
+void motion_features_update(motion_features_state_t *st, int32_t ax_q16, int32_t ay_q16, int32_t az_q16);
+
+/**
+ * @brief Feed a batch of converted samples.
+ */
+void motion_features_update_batch(motion_features_state_t *st, const mpu6050_fixed_data_t *samples, uint16_t n);
+
+/**
+ * @brief Compute the current features (one integer sqrt per field).
+ */
+motion_features_t motion_features_get(const motion_features_state_t *st);
+
+/**
+ * @brief Evaluate the rule against the current features.
+ * @return true if the motion should escalate to an alarm.
+ */
+bool motion_features_should_escalate(const motion_features_state_t *st, motion_features_t *out);
+
+#endif // MOTION_FEATURES_H
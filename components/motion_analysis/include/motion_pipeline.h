@@ -0,0 +1,65 @@
+#ifndef MOTION_PIPELINE_H
+#define MOTION_PIPELINE_H
+
+/*
+ * Armed detection path: motion interrupt -> verification over the sample
+ * stream -> alarm or rejection, plus the tilt check on every sample.
+ * Extracted from mpu_monitor so that the same code runs on the target and
+ * in host replays. Time is passed in explicitly; no ESP-IDF dependencies.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "motion_features.h"
+#include "tilt_detector.h"
+
+typedef enum {
+    MOTION_EVENT_NONE,
+    MOTION_EVENT_VERIFYING,      // Interrupt accepted, verification started
+    MOTION_EVENT_ALARM_MOTION,   // Verified sustained motion
+    MOTION_EVENT_ALARM_TILT,     // Orientation left the armed reference
+    MOTION_EVENT_REJECTED,       // Verification window ran out
+} motion_event_t;
+
+typedef struct {
+    motion_rule_t rule;
+    tilt_config_t tilt;
+    uint32_t verify_ms;          // Verification window after the last interrupt
+} motion_pipeline_config_t;
+
+typedef struct {
+    motion_pipeline_config_t cfg;
+    motion_features_state_t features;
+    tilt_detector_t tilt;
+    bool verifying;
+    int64_t verify_start_us;
+    int64_t verify_deadline_us;
+    motion_features_t last;      // Features at the last decision
+} motion_pipeline_t;
+
+/**
+ * @brief Reset features and tilt reference (arming).
+ */
+void motion_pipeline_init(motion_pipeline_t *p, const motion_pipeline_config_t *cfg);
+
+/**
+ * @brief Reset features and verification for a new sample stream. The tilt
+ * reference and filter are kept: a stream started by the motion itself
+ * must not take the moved pose as the armed orientation.
+ */
+void motion_pipeline_restart(motion_pipeline_t *p);
+
+/**
+ * @brief A motion interrupt at int_us; starts or extends verification.
+ * @return MOTION_EVENT_VERIFYING if verification started, NONE if extended.
+ */
+motion_event_t motion_pipeline_interrupt(motion_pipeline_t *p, int64_t int_us);
+
+/**
+ * @brief Feed converted accel samples (gyro unused - it is in standby while armed).
+ * @return Alarm, rejection or NONE.
+ */
+motion_event_t motion_pipeline_samples(motion_pipeline_t *p, const mpu6050_fixed_data_t *samples,
+                                       uint16_t n, int64_t now_us);
+
+#endif // MOTION_PIPELINE_H
@@ -0,0 +1,116 @@
+#ifndef PRETRIGGER_H
+#define PRETRIGGER_H
+
+/*
+ * Pre-trigger capture: a fixed ring of compact raw accel samples kept while
+ * armed. On an alarm the ring is frozen in place (rotated oldest-first) and
+ * the header is filled in, so the storage itself is the record that gets
+ * persisted - no allocation and no second copy. No ESP-IDF dependencies.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mpu6050_convert.h"
+
+#define PRETRIGGER_MAGIC    0x50524554u   // "PRET"
+#define PRETRIGGER_VERSION  2
+
+// Header flags
+#define PRETRIGGER_FLAG_WOKE_FROM_SLEEP 0x01  // Trigger woke the chip: no history from before it
+
+typedef enum {
+    PRETRIGGER_REASON_MOTION = 1,         // Verified motion
+    PRETRIGGER_REASON_TILT = 2,
+    PRETRIGGER_REASON_UNVERIFIED = 3,     // Interrupt without a sample stream
+} pretrigger_reason_t;
+
+// Raw accel, offsets not applied (6 B per sample)
+typedef struct {
+    int16_t ax, ay, az;
+} pretrigger_sample_t;
+
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t reason;              // pretrigger_reason_t
+    uint16_t odr_hz;             // Rate of the stored samples (after decimation)
+    uint16_t accel_lsb_per_g;
+    uint16_t count;              // Valid samples, oldest first
+    uint32_t uptime_ms;          // When the alarm fired
+    int16_t offset_ax, offset_ay, offset_az;
+    uint16_t pre_count;          // Samples before the trigger, the rest are from verification
+    uint8_t flags;               // PRETRIGGER_FLAG_*
+    uint8_t reserved[3];
+    uint32_t checksum;           // FNV-1a over header (checksum = 0) and samples
+} pretrigger_header_t;
+
+typedef struct {
+    pretrigger_header_t hdr;
+    pretrigger_sample_t samples[];
+} pretrigger_record_t;
+
+// Bytes of storage for a ring of n samples (header included)
+#define PRETRIGGER_RECORD_SIZE(n) (sizeof(pretrigger_header_t) + (size_t)(n) * sizeof(pretrigger_sample_t))
+
+typedef struct {
+    pretrigger_record_t *rec;
+    uint16_t capacity;
+    uint16_t head;               // Next write position
+    uint16_t count;
+    uint16_t input_hz;
+    uint8_t decimation;          // Keep every n-th input sample
+    uint8_t phase;
+    bool frozen;
+    bool marked;
+    uint8_t flags;
+    uint32_t pushed;             // Samples stored since the reset
+    uint32_t mark;               // pushed at the trigger
+} pretrigger_t;
+
+/**
+ * @brief Attach caller-owned storage of PRETRIGGER_RECORD_SIZE(capacity) bytes
+ * (4-byte aligned) and reset the ring.
+ */
+void pretrigger_init(pretrigger_t *pt, void *storage, uint16_t capacity, uint16_t input_hz, uint8_t decimation);
+
+/**
+ * @brief Empty the ring (also un-freezes it).
+ */
+void pretrigger_reset(pretrigger_t *pt);
+
+/**
+ * @brief Append raw samples; ignored while frozen. O(1) per sample.
+ */
+void pretrigger_push_batch(pretrigger_t *pt, const mpu6050_raw_sample_t *samples, uint16_t n);
+
+/**
+ * @brief Mark the trigger (start of a verification): samples pushed from now
+ * on count as post-trigger in the record, flags go into its header.
+ */
+void pretrigger_mark(pretrigger_t *pt, uint8_t flags);
+
+/**
+ * @brief Drop the mark (verification rejected); also done by reset.
+ */
+void pretrigger_unmark(pretrigger_t *pt);
+
+/**
+ * @brief Rotate the ring oldest-first and seal the header. Without a mark
+ * the alarm itself is the trigger and all samples are pre-trigger.
+ * @return Size of the record (bytes) starting at the storage address.
+ */
+size_t pretrigger_freeze(pretrigger_t *pt, pretrigger_reason_t reason, uint32_t uptime_ms,
+                         uint16_t accel_lsb_per_g, const mpu6050_offsets_t *offsets);
+
+/**
+ * @brief Check magic, version, size and checksum of a stored record.
+ */
+bool pretrigger_record_valid(const void *data, size_t len);
+
+/**
+ * @brief Seconds of history the ring holds when full.
+ */
+float pretrigger_span_s(const pretrigger_t *pt);
+
+#endif // PRETRIGGER_H
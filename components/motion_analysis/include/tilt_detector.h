@@ -0,0 +1,58 @@
+#ifndef TILT_DETECTOR_H
+#define TILT_DETECTOR_H
+
+/*
+ * Incremental attitude (gravity direction) estimator with a tilt alarm.
+ * Complementary filter: the gravity vector is propagated with the gyro and
+ * pulled towards the measured accel direction. Without gyro data it reduces
+ * to a low-pass filter on the accel direction. Fixed cost per sample
+ * (one sqrt, no trigonometry); no ESP-IDF dependencies.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    float threshold_deg;     // Deviation from the reference that raises a tilt event
+    float accel_weight;      // Complementary filter weight of the accel (0..1)
+    float accel_gate_g;      // Ignore accel when ||a| - 1g| exceeds this (shocks)
+    uint16_t sample_rate_hz; // Rate of the samples fed to the filter
+    uint16_t settle_samples; // Samples before the reference is captured
+} tilt_config_t;
+
+typedef struct {
+    tilt_config_t cfg;
+    float cos_threshold;
+    float dt;
+    float g[3];              // Estimated gravity direction (unit vector, body frame)
+    float ref[3];            // Reference direction captured at arm time
+    bool primed;
+    bool has_ref;
+    uint32_t samples;
+} tilt_detector_t;
+
+/**
+ * @brief Reset the estimator. The reference is captured automatically
+ * after cfg->settle_samples samples.
+ */
+void tilt_detector_init(tilt_detector_t *td, const tilt_config_t *cfg);
+
+/**
+ * @brief Feed one sample (accel in g, gyro in deg/s).
+ * @param has_gyro false when the gyro is in standby (accel-only stream).
+ * @return true if the orientation deviates from the reference beyond the threshold.
+ */
+bool tilt_detector_update(tilt_detector_t *td, float ax, float ay, float az,
+                          float gx, float gy, float gz, bool has_gyro);
+
+/**
+ * @brief Capture the current estimate as the new reference.
+ */
+void tilt_detector_capture_reference(tilt_detector_t *td);
+
+/**
+ * @brief Current deviation from the reference in degrees (0 if no reference).
+ */
+float tilt_detector_get_angle_deg(const tilt_detector_t *td);
+
+#endif // TILT_DETECTOR_H
@@ -0,0 +1,150 @@
+#include "motion_features.h"
+#include <string.h>
+
+// Gravity tracker: EMA with alpha = 1/32 (~0.6 s time constant at 50 Hz)
+#define GRAVITY_SHIFT    5
+#define GRAVITY_FRAC     4
+
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t res = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > v) bit >>= 2;
+    while (bit != 0) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)res;
+}
+
+static inline int32_t q16_to_mg(int32_t q16) {
+    // 1000 / 65536 = 125 / 8192
+    return (q16 * 125) >> 13;
+}
+
+static inline int32_t clamp16(int32_t v) {
+    if (v > 32767) return 32767;
+    if (v < -32767) return -32767;
+    return v;
+}
+
+void motion_features_init(motion_features_state_t *st, const motion_rule_t *rule) {
+    memset(st, 0, sizeof(*st));
+    st->rule = *rule;
+
+    st->window = rule->window_samples;
+    if (st->window == 0) st->window = 1;
+    if (st->window > MOTION_FEATURES_MAX_WINDOW) st->window = MOTION_FEATURES_MAX_WINDOW;
+    if (st->rule.sample_rate_hz == 0) st->rule.sample_rate_hz = 1;
+}
+
+void motion_features_update(motion_features_state_t *st, int32_t ax_q16, int32_t ay_q16, int32_t az_q16) {
+    int32_t a[3] = { q16_to_mg(ax_q16), q16_to_mg(ay_q16), q16_to_mg(az_q16) };
+    int32_t dyn[3];
+
+    if (!st->primed) {
+        for (int i = 0; i < 3; i++) {
+            st->gravity[i] = a[i] << GRAVITY_FRAC;
+            st->prev_dyn[i] = 0;
+        }
+        st->primed = true;
+    }
+
+    uint32_t energy = 0;
+    uint32_t jerk_sq = 0;
+    uint32_t mag_sq = 0;
+
+    for (int i = 0; i < 3; i++) {
+        st->gravity[i] += ((a[i] << GRAVITY_FRAC) - st->gravity[i]) >> GRAVITY_SHIFT;
+        dyn[i] = clamp16(a[i] - (st->gravity[i] >> GRAVITY_FRAC));
+
+        int32_t d = clamp16(dyn[i] - st->prev_dyn[i]);
+        st->prev_dyn[i] = dyn[i];
+
+        int32_t ac = clamp16(a[i]);
+        energy += (uint32_t)(dyn[i] * dyn[i]);
+        jerk_sq += (uint32_t)(d * d);
+        mag_sq += (uint32_t)(ac * ac);
+    }
+
+    int32_t magnitude = (int32_t)isqrt64(mag_sq);
+
+    // Running sums: drop the slot being overwritten, add the new sample
+    if (st->filled == st->window) {
+        st->energy_sum -= st->energy[st->pos];
+        st->jerk_sq_sum -= st->jerk_sq[st->pos];
+        st->mag_sum -= st->magnitude[st->pos];
+        st->mag_sq_sum -= (uint64_t)((int64_t)st->magnitude[st->pos] * st->magnitude[st->pos]);
+    } else {
+        st->filled++;
+    }
+
+    st->energy[st->pos] = energy;
+    st->jerk_sq[st->pos] = jerk_sq;
+    st->magnitude[st->pos] = magnitude;
+
+    st->energy_sum += energy;
+    st->jerk_sq_sum += jerk_sq;
+    st->mag_sum += magnitude;
+    st->mag_sq_sum += (uint64_t)((int64_t)magnitude * magnitude);
+
+    st->pos = (st->pos + 1) % st->window;
+    st->samples++;
+
+    // Sustained motion episode with a tolerated quiet gap
+    uint32_t active_sq = (uint32_t)st->rule.active_mg * st->rule.active_mg;
+    uint32_t gap_samples = (uint32_t)st->rule.gap_ms * st->rule.sample_rate_hz / 1000;
+
+    if (energy > active_sq) {
+        st->active_samples += 1 + st->quiet_samples;
+        st->quiet_samples = 0;
+    } else if (st->active_samples > 0) {
+        st->quiet_samples++;
+        if (st->quiet_samples > gap_samples) {
+            st->active_samples = 0;
+            st->quiet_samples = 0;
+        }
+    }
+}
+
+void motion_features_update_batch(motion_features_state_t *st, const mpu6050_fixed_data_t *samples, uint16_t n) {
+    for (uint16_t i = 0; i < n; i++) {
+        motion_features_update(st, samples[i].ax, samples[i].ay, samples[i].az);
+    }
+}
+
+motion_features_t motion_features_get(const motion_features_state_t *st) {
+    motion_features_t f = {0};
+    f.samples = st->samples;
+    if (st->filled == 0) return f;
+
+    uint32_t n = st->filled;
+    f.rms_mg = (uint16_t)isqrt64(st->energy_sum / n);
+    f.jerk_mg_s = isqrt64(st->jerk_sq_sum / n) * st->rule.sample_rate_hz;
+
+    int64_t mean = st->mag_sum / n;
+    int64_t var = (int64_t)(st->mag_sq_sum / n) - mean * mean;
+    f.variance_mg2 = (var > 0) ? (uint32_t)var : 0;
+
+    f.sustained_ms = st->active_samples * 1000 / st->rule.sample_rate_hz;
+    return f;
+}
+
+bool motion_features_should_escalate(const motion_features_state_t *st, motion_features_t *out) {
+    motion_features_t f = motion_features_get(st);
+    if (out) *out = f;
+
+    const motion_rule_t *r = &st->rule;
+
+    if (f.sustained_ms < r->sustained_ms) return false;
+    if (r->min_variance_mg2 > 0 && f.variance_mg2 < r->min_variance_mg2) return false;
+
+    bool strong = (f.rms_mg >= r->rms_mg);
+    bool jerky = (r->jerk_mg_s > 0 && f.jerk_mg_s >= r->jerk_mg_s);
+    return strong || jerky;
+}
@@ -0,0 +1,61 @@
+#include "motion_pipeline.h"
+#include <string.h>
+
+void motion_pipeline_init(motion_pipeline_t *p, const motion_pipeline_config_t *cfg) {
+    memset(p, 0, sizeof(*p));
+    p->cfg = *cfg;
+    motion_features_init(&p->features, &cfg->rule);
+    tilt_detector_init(&p->tilt, &cfg->tilt);
+}
+
+void motion_pipeline_restart(motion_pipeline_t *p) {
+    motion_features_init(&p->features, &p->cfg.rule);
+    p->verifying = false;
+    p->verify_start_us = 0;
+    p->verify_deadline_us = 0;
+    memset(&p->last, 0, sizeof(p->last));
+}
+
+motion_event_t motion_pipeline_interrupt(motion_pipeline_t *p, int64_t int_us) {
+    motion_event_t ev = MOTION_EVENT_NONE;
+    if (!p->verifying) {
+        p->verifying = true;
+        p->verify_start_us = int_us;
+        ev = MOTION_EVENT_VERIFYING;
+    }
+    p->verify_deadline_us = int_us + (int64_t)p->cfg.verify_ms * 1000;
+    return ev;
+}
+
+motion_event_t motion_pipeline_samples(motion_pipeline_t *p, const mpu6050_fixed_data_t *samples,
+                                       uint16_t n, int64_t now_us) {
+    if (n > 0) {
+        motion_features_update_batch(&p->features, samples, n);
+
+        const float q16_to_g = 1.0f / 65536.0f;
+        bool tilted = false;
+        for (uint16_t i = 0; i < n; i++) {
+            tilted |= tilt_detector_update(&p->tilt,
+                                           samples[i].ax * q16_to_g,
+                                           samples[i].ay * q16_to_g,
+                                           samples[i].az * q16_to_g,
+                                           0.0f, 0.0f, 0.0f, false);
+        }
+        if (tilted) {
+            p->verifying = false;
+            return MOTION_EVENT_ALARM_TILT;
+        }
+    }
+
+    if (!p->verifying) return MOTION_EVENT_NONE;
+
+    if (motion_features_should_escalate(&p->features, &p->last)) {
+        p->verifying = false;
+        return MOTION_EVENT_ALARM_MOTION;
+    }
+    if (now_us >= p->verify_deadline_us) {
+        p->verifying = false;
+        return MOTION_EVENT_REJECTED;
+    }
+    return MOTION_EVENT_NONE;
+}
@@ -0,0 +1,124 @@
+#include "pretrigger.h"
+#include <string.h>
+
+static uint32_t fnv1a(uint32_t h, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static uint32_t record_checksum(const pretrigger_record_t *rec) {
+    pretrigger_header_t hdr = rec->hdr;
+    hdr.checksum = 0;
+    uint32_t h = fnv1a(2166136261u, &hdr, sizeof(hdr));
+    return fnv1a(h, rec->samples, (size_t)rec->hdr.count * sizeof(pretrigger_sample_t));
+}
+
+static void reverse(pretrigger_sample_t *s, uint16_t from, uint16_t to) {
+    while (from < to) {
+        pretrigger_sample_t t = s[from];
+        s[from] = s[to];
+        s[to] = t;
+        from++;
+        to--;
+    }
+}
+
+void pretrigger_init(pretrigger_t *pt, void *storage, uint16_t capacity, uint16_t input_hz, uint8_t decimation) {
+    memset(pt, 0, sizeof(*pt));
+    pt->rec = (pretrigger_record_t *)storage;
+    pt->capacity = capacity;
+    pt->input_hz = input_hz;
+    pt->decimation = decimation ? decimation : 1;
+}
+
+void pretrigger_reset(pretrigger_t *pt) {
+    pt->head = 0;
+    pt->count = 0;
+    pt->phase = 0;
+    pt->frozen = false;
+    pt->pushed = 0;
+    pretrigger_unmark(pt);
+}
+
+void pretrigger_push_batch(pretrigger_t *pt, const mpu6050_raw_sample_t *samples, uint16_t n) {
+    if (pt->frozen || pt->capacity == 0) return;
+
+    pretrigger_sample_t *ring = pt->rec->samples;
+    for (uint16_t i = 0; i < n; i++) {
+        if (++pt->phase < pt->decimation) continue;
+        pt->phase = 0;
+
+        ring[pt->head].ax = samples[i].ax;
+        ring[pt->head].ay = samples[i].ay;
+        ring[pt->head].az = samples[i].az;
+        if (++pt->head == pt->capacity) pt->head = 0;
+        if (pt->count < pt->capacity) pt->count++;
+        pt->pushed++;
+    }
+}
+
+void pretrigger_mark(pretrigger_t *pt, uint8_t flags) {
+    if (pt->frozen) return;
+    pt->marked = true;
+    pt->mark = pt->pushed;
+    pt->flags = flags;
+}
+
+void pretrigger_unmark(pretrigger_t *pt) {
+    pt->marked = false;
+    pt->mark = 0;
+    pt->flags = 0;
+}
+
+size_t pretrigger_freeze(pretrigger_t *pt, pretrigger_reason_t reason, uint32_t uptime_ms,
+                         uint16_t accel_lsb_per_g, const mpu6050_offsets_t *offsets) {
+    pretrigger_record_t *rec = pt->rec;
+
+    // Oldest sample sits at head once the ring has wrapped; rotate left by
+    // head with three reversals so it ends up at index 0
+    if (pt->count == pt->capacity && pt->head != 0) {
+        reverse(rec->samples, 0, pt->head - 1);
+        reverse(rec->samples, pt->head, pt->capacity - 1);
+        reverse(rec->samples, 0, pt->capacity - 1);
+    }
+    pt->head = 0;
+    pt->frozen = true;
+
+    // Samples after the mark are the newest ones in the ring
+    uint32_t post = pt->marked ? pt->pushed - pt->mark : 0;
+
+    memset(&rec->hdr, 0, sizeof(rec->hdr));
+    rec->hdr.magic = PRETRIGGER_MAGIC;
+    rec->hdr.version = PRETRIGGER_VERSION;
+    rec->hdr.reason = (uint8_t)reason;
+    rec->hdr.odr_hz = pt->input_hz / pt->decimation;
+    rec->hdr.accel_lsb_per_g = accel_lsb_per_g;
+    rec->hdr.count = pt->count;
+    rec->hdr.uptime_ms = uptime_ms;
+    rec->hdr.offset_ax = offsets->accel_x;
+    rec->hdr.offset_ay = offsets->accel_y;
+    rec->hdr.offset_az = offsets->accel_z;
+    rec->hdr.pre_count = post < pt->count ? (uint16_t)(pt->count - post) : 0;
+    rec->hdr.flags = pt->flags;
+    rec->hdr.checksum = record_checksum(rec);
+
+    return PRETRIGGER_RECORD_SIZE(pt->count);
+}
+
+bool pretrigger_record_valid(const void *data, size_t len) {
+    const pretrigger_record_t *rec = (const pretrigger_record_t *)data;
+
+    if (len < sizeof(pretrigger_header_t)) return false;
+    if (rec->hdr.magic != PRETRIGGER_MAGIC || rec->hdr.version != PRETRIGGER_VERSION) return false;
+    if (PRETRIGGER_RECORD_SIZE(rec->hdr.count) != len) return false;
+    return rec->hdr.checksum == record_checksum(rec);
+}
+
+float pretrigger_span_s(const pretrigger_t *pt) {
+    if (pt->input_hz == 0) return 0.0f;
+    return (float)pt->capacity * pt->decimation / pt->input_hz;
+}
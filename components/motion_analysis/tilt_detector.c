@@ -0,0 +1,84 @@
+#include "tilt_detector.h"
+#include <math.h>
+#include <string.h>
+
+#define DEG_TO_RAD (0.017453292f)
+
+static void normalize(float v[3]) {
+    float n = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (n > 1e-6f) {
+        float inv = 1.0f / n;
+        v[0] *= inv;
+        v[1] *= inv;
+        v[2] *= inv;
+    }
+}
+
+void tilt_detector_init(tilt_detector_t *td, const tilt_config_t *cfg) {
+    memset(td, 0, sizeof(*td));
+    td->cfg = *cfg;
+    td->cos_threshold = cosf(cfg->threshold_deg * DEG_TO_RAD);
+    td->dt = (cfg->sample_rate_hz > 0) ? 1.0f / cfg->sample_rate_hz : 0.0f;
+}
+
+void tilt_detector_capture_reference(tilt_detector_t *td) {
+    memcpy(td->ref, td->g, sizeof(td->ref));
+    td->has_ref = td->primed;
+}
+
+bool tilt_detector_update(tilt_detector_t *td, float ax, float ay, float az,
+                          float gx, float gy, float gz, bool has_gyro) {
+    float a_sq = ax * ax + ay * ay + az * az;
+
+    if (!td->primed) {
+        if (a_sq < 1e-6f) return false;
+        td->g[0] = ax;
+        td->g[1] = ay;
+        td->g[2] = az;
+        normalize(td->g);
+        td->primed = true;
+    }
+
+    // 1. Prediction: a world-fixed vector seen from the body rotates by -w x g
+    if (has_gyro) {
+        float wx = gx * DEG_TO_RAD * td->dt;
+        float wy = gy * DEG_TO_RAD * td->dt;
+        float wz = gz * DEG_TO_RAD * td->dt;
+        float g0 = td->g[0], g1 = td->g[1], g2 = td->g[2];
+
+        td->g[0] = g0 - (wy * g2 - wz * g1);
+        td->g[1] = g1 - (wz * g0 - wx * g2);
+        td->g[2] = g2 - (wx * g1 - wy * g0);
+    }
+
+    // 2. Correction towards the accel direction, skipped during shocks
+    float a_norm = sqrtf(a_sq);
+    if (fabsf(a_norm - 1.0f) <= td->cfg.accel_gate_g && a_norm > 1e-6f) {
+        float w = td->cfg.accel_weight / a_norm;
+        float k = 1.0f - td->cfg.accel_weight;
+        td->g[0] = k * td->g[0] + w * ax;
+        td->g[1] = k * td->g[1] + w * ay;
+        td->g[2] = k * td->g[2] + w * az;
+    }
+    normalize(td->g);
+
+    td->samples++;
+    if (!td->has_ref) {
+        if (td->samples >= td->cfg.settle_samples) {
+            tilt_detector_capture_reference(td);
+        }
+        return false;
+    }
+
+    float dot = td->g[0] * td->ref[0] + td->g[1] * td->ref[1] + td->g[2] * td->ref[2];
+    return dot < td->cos_threshold;
+}
+
+float tilt_detector_get_angle_deg(const tilt_detector_t *td) {
+    if (!td->has_ref) return 0.0f;
+
+    float dot = td->g[0] * td->ref[0] + td->g[1] * td->ref[1] + td->g[2] * td->ref[2];
+    if (dot > 1.0f) dot = 1.0f;
+    if (dot < -1.0f) dot = -1.0f;
+    return acosf(dot) / DEG_TO_RAD;
+}
@@ -4,6 +4,7 @@
 #include "esp_err.h"
 #include <stdbool.h>
 #include <stdint.h>
+#include "mpu6050_convert.h"
 
 // --- Konfiguracja I2C ---
 #define I2C_MASTER_SCL_IO           22      // GPIO dla zegara (SCL)
@@ -62,26 +63,79 @@ typedef enum {
     DLPF_5HZ   = 6, // Bardzo mocne filtrowanie (bardzo gładkie dane, wolniejsza reakcja) 
 } mpu6050_dlpf_t;
 
-/** Struktura przechowująca pełny zestaw danych */
+/** Częstotliwość wybudzeń akcelerometru w trybie cyklicznym (LP_WAKE_CTRL) */
+typedef enum {
+    LP_WAKE_1_25HZ = 0,
+    LP_WAKE_5HZ    = 1,
+    LP_WAKE_20HZ   = 2,
+    LP_WAKE_40HZ   = 3,
+} mpu6050_lp_wake_t;
+
+/** Pełny zestaw ustawień zasilania i detekcji - zapisywany jedną paczką */
+typedef struct {
+    mpu6050_accel_range_t accel_range;
+    mpu6050_dlpf_t dlpf;
+    bool cycle;                   // Tryb cykliczny: akcelerometr budzi się z częstotliwością lp_wake
+    mpu6050_lp_wake_t lp_wake;
+    bool gyro_standby;            // Żyroskop w standby (zegar z oscylatora wewnętrznego)
+    bool temp_disable;            // Wyłączony termometr
+    bool motion_int;              // Przerwanie detekcji ruchu na pinie INT (zatrzaśnięte)
+    uint8_t motion_threshold;     // 1 LSB = 2 mg
+    uint8_t motion_duration;      // ms (w trybie cyklicznym: liczba wybudzeń)
+} mpu6050_sensing_t;
+
+// --- FIFO (strumieniowanie próbek) ---
+
+/** Tryb FIFO - które dane czujnik odkłada do kolejki */
+typedef enum {
+    MPU6050_FIFO_ACCEL      = 0, // Tylko akcelerometr (6 bajtów na próbkę)
+    MPU6050_FIFO_ACCEL_GYRO = 1, // Akcelerometr + żyroskop (12 bajtów na próbkę)
+} mpu6050_fifo_mode_t;
+
+/** Bufor cykliczny na próbki - pamięć dostarcza wywołujący */
+typedef struct {
+    mpu6050_raw_sample_t *buf;
+    uint16_t capacity;
+    uint16_t head;   // Indeks następnego zapisu
+    uint16_t count;  // Liczba próbek w buforze
+} mpu6050_ring_t;
+
+/** Liczniki przepustowości FIFO (benchmark) */
 typedef struct {
-    float ax;    // Akcelerometr X (g)
-    float ay;    // Akcelerometr Y (g)
-    float az;    // Akcelerometr Z (g)
-    float gx;    // Żyroskop X (deg/s)
-    float gy;    // Żyroskop Y (deg/s)
-    float gz;    // Żyroskop Z (deg/s)
-    float temp;  // Temperatura (C)
-} mpu6050_data_t;
-
-// --- Struktura offsetów ---
+    uint32_t samples;     // Próbki odczytane od mpu6050_fifo_start()
+    uint32_t i2c_bytes;   // Bajty na magistrali (adresy + rejestry + dane)
+    uint32_t bursts;      // Liczba odczytów burst
+    uint32_t overflows;   // Przepełnienia FIFO czujnika (dane utracone)
+    uint32_t ring_drops;  // Próbki nadpisane w buforze cyklicznym
+    int64_t start_us;     // Czas startu FIFO
+} mpu6050_fifo_stats_t;
+
+// --- Transakcje I2C ---
+
+#define MPU6050_BATCH_MAX 8   // Maks. liczba zapisów w jednej paczce
+
+/** Pojedynczy zapis rejestru w paczce */
 typedef struct {
-    int16_t accel_x;
-    int16_t accel_y;
-    int16_t accel_z;
-    int16_t gyro_x;
-    int16_t gyro_y;
-    int16_t gyro_z;
-} mpu6050_offsets_t;
+    uint8_t reg;
+    uint8_t value;
+} mpu6050_reg_write_t;
+
+/**
+ * Callback odczytu asynchronicznego.
+ * UWAGA: wywoływany w kontekście przerwania - tylko krótkie operacje (np. powiadomienie zadania).
+ */
+typedef void (*mpu6050_read_cb_t)(esp_err_t result, uint8_t reg_addr, uint8_t *data, size_t len, void *arg);
+
+/** Liczniki czasu transakcji I2C (debug) */
+typedef struct {
+    uint32_t transactions;  // Liczba transakcji (zapisy w paczce liczone osobno)
+    uint32_t batches;       // Liczba paczek zapisów
+    uint32_t async_reads;   // Liczba odczytów asynchronicznych
+    uint32_t errors;        // Transakcje/paczki zakończone błędem
+    uint32_t last_us;       // Czas ostatniej transakcji lub paczki
+    uint32_t max_us;        // Najdłuższa transakcja lub paczka
+    uint64_t total_us;      // Suma czasów (średnia = total_us / transactions)
+} mpu6050_i2c_stats_t;
 
 // --- Funkcje sterownika ---
 
@@ -131,6 +185,17 @@ esp_err_t mpu6050_get_temperature(float *temp);
  */
 esp_err_t mpu6050_get_data(mpu6050_data_t *data);
 
+/**
+ * @brief Odczytuje pełną próbkę (14 bajtów) bez konwersji.
+ * Do przetwarzania wsadowego przez mpu6050_convert_float() / mpu6050_convert_q16().
+ */
+esp_err_t mpu6050_get_raw_data(mpu6050_raw_sample_t *raw);
+
+/**
+ * @brief Zwraca aktualne parametry konwersji (zakresy + offsety).
+ */
+mpu6050_scale_t mpu6050_get_scale(void);
+
 /**
  * @brief Wykonuje automatyczną kaibrację czujnika.
  * UWAGA: Podczas tej operacji czujnik musi leżeć płasko i nieruchomo.
@@ -142,16 +207,44 @@ esp_err_t mpu6050_calibrate(uint16_t iterations);
 /**
  * @brief Konfiguruje sprzętowe wykrywanie ruchu (Motion Detection).
  * Czujnik wyśle sygnał przerwania, gdy wykryje ruch powyżej progu.
+ * Pin INT pozostaje wysoki aż do odczytu mpu6050_get_int_status().
  * * @param threshold Próg siły ruchu (1-255). 1 = 2mg, 255 = 510mg.
  * * @param duration Czas trwania ruchu (1-255ms). Jak długo musi trwać ruch.
 */
 esp_err_t mpu6050_enable_motion_detection(uint8_t threshold, uint8_t duration);
 
+/**
+ * @brief Zapisuje cały profil pracy (zakres, DLPF, zasilanie, detekcja ruchu)
+ * jedną paczką. Zasilanie jest zapisywane na końcu, więc tryb cykliczny
+ * startuje z kompletną konfiguracją. FIFO nie jest ruszane.
+ * @return ESP_OK lub pierwszy napotkany błąd.
+*/
+esp_err_t mpu6050_apply_sensing(const mpu6050_sensing_t *sensing);
+
+/**
+ * @brief Zmienia tylko próg i czas trwania detekcji ruchu.
+ * Nie rusza zasilania, filtra ani FIFO - bezpieczne podczas strumienia próbek.
+ * * @param threshold Próg siły ruchu (1-255). 1 = 2mg, 255 = 510mg.
+ * * @param duration Czas trwania ruchu (1-255ms).
+*/
+esp_err_t mpu6050_set_motion_threshold(uint8_t threshold, uint8_t duration);
+
 /**
  * @brief Pobiera aktualnie używane offsety.
 */
 mpu6050_offsets_t mpu6050_get_offsets(void);
 
+/**
+ * @brief Ustawia offsety (np. wczytane z NVS lub z rekalibracji w tle).
+ * Offsety akcelerometru muszą odpowiadać aktualnemu zakresowi.
+*/
+void mpu6050_set_offsets(const mpu6050_offsets_t *offsets);
+
+/**
+ * @brief Zwraca czułość akcelerometru dla aktualnego zakresu (LSB na 1 g).
+*/
+uint16_t mpu6050_get_accel_lsb_per_g(void);
+
 /**
  * @brief Odczytuje wartość rejestru statusu przerwań.
  * @return Wartość rejestru. Bit 6 (0x40) oznacza wykrycie ruchu.
@@ -165,6 +258,77 @@ uint8_t mpu6050_get_int_status(void);
  */
 esp_err_t mpu6050_set_normal_mode(void);
 
+/**
+ * @brief Zapisuje kilka rejestrów jedną zakolejkowaną sekwencją.
+ * Wszystkie zapisy trafiają do kolejki sterownika, funkcja czeka na całość.
+ * @param count Liczba zapisów (maks. MPU6050_BATCH_MAX).
+ * @return ESP_OK lub pierwszy napotkany błąd.
+ */
+esp_err_t mpu6050_write_batch(const mpu6050_reg_write_t *writes, size_t count);
+
+/**
+ * @brief Rozpoczyna odczyt w tle - wynik przychodzi przez callback.
+ * Bufor 'data' musi być ważny do wywołania callbacku. Maks. jeden odczyt naraz.
+ * @return ESP_ERR_INVALID_STATE gdy poprzedni odczyt trwa,
+ *         ESP_ERR_NOT_SUPPORTED gdy magistrala działa synchronicznie.
+ */
+esp_err_t mpu6050_read_async(uint8_t reg_addr, uint8_t *data, size_t len, mpu6050_read_cb_t cb, void *arg);
+
+/**
+ * @brief Zwraca liczniki czasu transakcji I2C.
+ */
+mpu6050_i2c_stats_t mpu6050_get_i2c_stats(void);
+
+/**
+ * @brief Zeruje liczniki transakcji I2C.
+ */
+void mpu6050_reset_i2c_stats(void);
+
+/**
+ * @brief Inicjalizuje bufor cykliczny na próbki.
+ * @param buf Tablica o rozmiarze co najmniej 'capacity' próbek.
+ */
+void mpu6050_ring_init(mpu6050_ring_t *ring, mpu6050_raw_sample_t *buf, uint16_t capacity);
+
+/**
+ * @brief Pobiera najstarszą próbkę z bufora.
+ * @return false jeśli bufor jest pusty.
+ */
+bool mpu6050_ring_pop(mpu6050_ring_t *ring, mpu6050_raw_sample_t *out);
+
+/**
+ * @brief Włącza FIFO czujnika z zadaną częstotliwością próbkowania.
+ * Częstotliwość jest zaokrąglana do 1000 / (1 + divider) (DLPF włączony).
+ * UWAGA: w trybie wykrywania ruchu żyroskop jest w standby - używaj MPU6050_FIFO_ACCEL.
+ * @param odr_hz Częstotliwość próbkowania (4-1000 Hz).
+ * @return ESP_ERR_INVALID_ARG dla 0 lub powyżej częstotliwości bazowej.
+ */
+esp_err_t mpu6050_fifo_start(mpu6050_fifo_mode_t mode, uint16_t odr_hz);
+
+/**
+ * @brief Wyłącza FIFO i czyści jego zawartość.
+ */
+esp_err_t mpu6050_fifo_stop(void);
+
+/**
+ * @brief Odczytuje do 'max_samples' próbek z FIFO odczytami burst i dopisuje je do bufora.
+ * Gdy bufor jest pełny, najstarsze próbki są nadpisywane (licznik ring_drops).
+ * @param read Liczba odczytanych próbek (może być NULL).
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE gdy FIFO czujnika się przepełniło
+ *         (FIFO zostaje zresetowane, część danych utracona), lub błąd I2C.
+ */
+esp_err_t mpu6050_fifo_drain(mpu6050_ring_t *ring, uint16_t max_samples, uint16_t *read);
+
+/**
+ * @brief Zwraca liczniki przepustowości FIFO.
+ */
+mpu6050_fifo_stats_t mpu6050_fifo_get_stats(void);
+
+/**
+ * @brief Loguje przepustowość FIFO: próbki/s oraz bajty I2C na próbkę.
+ */
+void mpu6050_fifo_log_stats(void);
+
 /**
  * @brief Pomocnicza funkcja do odczytu pojedynczego rejestru.
  * @param reg_addr Adres rejestru do odczytu.
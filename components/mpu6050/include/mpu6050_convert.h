@@ -0,0 +1,102 @@
+#ifndef MPU6050_CONVERT_H
+#define MPU6050_CONVERT_H
+
+// Konwersja surowych próbek MPU-6050 na jednostki fizyczne.
+// Plik nie zależy od ESP-IDF - kernele można zbudować i zmierzyć na hoście.
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Struktura przechowująca pełny zestaw danych */
+typedef struct {
+    float ax;    // Akcelerometr X (g)
+    float ay;    // Akcelerometr Y (g)
+    float az;    // Akcelerometr Z (g)
+    float gx;    // Żyroskop X (deg/s)
+    float gy;    // Żyroskop Y (deg/s)
+    float gz;    // Żyroskop Z (deg/s)
+    float temp;  // Temperatura (C)
+} mpu6050_data_t;
+
+/** Pełny zestaw danych w stałym przecinku */
+typedef struct {
+    int32_t ax;     // Akcelerometr (g, Q16: 65536 = 1 g)
+    int32_t ay;
+    int32_t az;
+    int32_t gx;     // Żyroskop (deg/s, Q16)
+    int32_t gy;
+    int32_t gz;
+    int32_t temp;   // Temperatura (0.01 C)
+} mpu6050_fixed_data_t;
+
+// --- Struktura offsetów ---
+typedef struct {
+    int16_t accel_x;
+    int16_t accel_y;
+    int16_t accel_z;
+    int16_t gyro_x;
+    int16_t gyro_y;
+    int16_t gyro_z;
+} mpu6050_offsets_t;
+
+/** Surowa próbka (jednostki rejestrów, bez offsetów) */
+typedef struct {
+    int16_t ax;
+    int16_t ay;
+    int16_t az;
+    int16_t gx;    // 0 gdy źródło nie zawiera żyroskopu (FIFO accel)
+    int16_t gy;
+    int16_t gz;
+    int16_t temp;  // 0 gdy źródło nie zawiera temperatury (FIFO)
+} mpu6050_raw_sample_t;
+
+/** Parametry konwersji - przeliczane tylko przy zmianie zakresu lub offsetów */
+typedef struct {
+    mpu6050_offsets_t offsets;
+    float accel_inv;        // 1 / (LSB na g)
+    float gyro_inv;         // 1 / (LSB na deg/s)
+    int32_t accel_mul_q32;  // 2^32 / (LSB na g) -> wynik w Q16
+    int32_t gyro_mul_q32;   // 2^32 / (LSB na deg/s) -> wynik w Q16
+} mpu6050_scale_t;
+
+/** Liniowy model dryfu offsetów z temperaturą: offset(T) = base + slope * (T - ref) */
+typedef struct {
+    mpu6050_offsets_t base;    // Offsety w temperaturze odniesienia
+    int16_t ref_temp_centi;    // Temperatura odniesienia (0.01 C)
+    int16_t slope_q8[6];       // Nachylenie na oś ax..gz (LSB/C, Q8); 0 = brak kompensacji
+} mpu6050_tempco_t;
+
+/**
+ * @brief Wylicza odwrotności i mnożniki stałoprzecinkowe dla danego zakresu.
+ * @param accel_lsb_per_g Czułość akcelerometru (np. 16384 dla +/- 2g).
+ * @param gyro_lsb_per_dps Czułość żyroskopu (np. 131 dla +/- 250 deg/s).
+ */
+void mpu6050_scale_init(mpu6050_scale_t *scale, float accel_lsb_per_g, float gyro_lsb_per_dps,
+                        const mpu6050_offsets_t *offsets);
+
+/**
+ * @brief Ustawia w scale offsety wyliczone z modelu dla bieżącej temperatury.
+ * Temperatura zmienia się w skali minut, więc model liczony jest raz na odczyt
+ * temperatury, a kernele dalej odejmują stałe offsety (próbki z FIFO i tak nie
+ * niosą temperatury).
+ */
+void mpu6050_scale_set_temp(mpu6050_scale_t *scale, const mpu6050_tempco_t *tc, int16_t temp_centi);
+
+/**
+ * @brief Składa surową próbkę z 14 bajtów rejestrów 0x3B..0x48.
+ */
+void mpu6050_unpack_raw(const uint8_t raw_data[14], mpu6050_raw_sample_t *out);
+
+/**
+ * @brief Konwersja tablicy próbek na float (mnożenie przez odwrotność zamiast dzielenia).
+ */
+void mpu6050_convert_float(const mpu6050_scale_t *scale, const mpu6050_raw_sample_t *in,
+                           mpu6050_data_t *out, size_t n);
+
+/**
+ * @brief Konwersja tablicy próbek na Q16 (bez operacji zmiennoprzecinkowych).
+ */
+void mpu6050_convert_q16(const mpu6050_scale_t *scale, const mpu6050_raw_sample_t *in,
+                         mpu6050_fixed_data_t *out, size_t n);
+
+#endif
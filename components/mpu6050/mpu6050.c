@@ -1,7 +1,12 @@
 #include "mpu6050.h"
-#include "driver/i2c.h"
+#include "driver/i2c_master.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include <math.h>
+#include <string.h>
 
 // --- Adresy MPU-6050 ---
 #define MPU6050_ADDR                0x68    // Adres urządzenia (gdy AD0 = GND) 
@@ -9,6 +14,7 @@
 #define REG_CONFIG                  0x1A    // Rejestr filtru DLPF
 #define REG_GYRO_CONFIG             0x1B    // Rejestr czułości Żyroskopu
 #define REG_ACCEL_CONFIG            0x1C    // Rejestr czułości Akcelerometru
+#define REG_INT_PIN_CFG             0x37    // Konfiguracja pinu INT (poziom, zatrzask)
 #define REG_INT_ENABLE              0x38    // Rejestr włączania przerwań (np. Data Ready, Motion)
 #define REG_INT_STATUS              0x3A    // Rejestr statusu przerwań
 #define REG_ACCEL_XOUT_H            0x3B    // Pierwszy rejestr danych akcelerometru
@@ -21,13 +27,57 @@
 #define REG_MOT_THR                 0x1F    // Motion Detection Threshold
 #define REG_MOT_DUR                 0x20    // Motion Detection Duration
 
-#define I2C_MASTER_TX_BUF_DISABLE   0       // I2C master nie potrzebuje bufora
-#define I2C_MASTER_RX_BUF_DISABLE   0
+#define REG_FIFO_EN                 0x23    // Wybór danych zapisywanych do FIFO
+#define REG_USER_CTRL               0x6A    // Sterowanie FIFO / I2C master
+#define REG_FIFO_COUNTH             0x72    // Liczba bajtów w FIFO (H, potem L)
+#define REG_FIFO_R_W                0x74    // Port odczytu FIFO
+
+#define FIFO_EN_ACCEL               0x08
+#define FIFO_EN_GYRO_XYZ            0x70
+#define USER_CTRL_FIFO_EN           0x40
+#define USER_CTRL_FIFO_RESET        0x04
+
+#define MPU6050_FIFO_SIZE           1024    // Rozmiar FIFO czujnika w bajtach
+#define MPU6050_FIFO_BURST_BYTES    240     // Maks. bajtów na jeden odczyt burst (wielokrotność 6 i 12)
+#define I2C_READ_OVERHEAD_BYTES     3       // Adres(W) + rejestr + adres(R)
+
+#define MPU6050_I2C_TIMEOUT_MS      50      // Limit czasu pojedynczej transakcji
+#define MPU6050_I2C_QUEUE_DEPTH     (MPU6050_BATCH_MAX + 1)  // Paczka + trwający odczyt asynchroniczny
+#define ASYNC_TAG_RING_SIZE         16      // Potęga 2, >= MPU6050_I2C_QUEUE_DEPTH + 1
 
 static const char *TAG = "MPU6050";
 
-static uint8_t s_device_addr = 0x68;
-static int s_i2c_port = 0;
+static i2c_master_bus_handle_t s_bus = NULL;
+static i2c_master_dev_handle_t s_dev = NULL;
+static bool s_async_ok = false;         // Magistrala obsługuje transakcje w tle
+
+// Każda transakcja w kolejce ma znacznik - callback wie, czy to odczyt asynchroniczny
+typedef enum {
+    ASYNC_TAG_SYNC = 0,
+    ASYNC_TAG_READ = 1,
+} async_tag_t;
+
+static volatile uint8_t s_tag_ring[ASYNC_TAG_RING_SIZE];
+static volatile uint8_t s_tag_head = 0;
+static volatile uint8_t s_tag_tail = 0;
+static volatile bool s_async_error = false;
+
+// Aktywny odczyt asynchroniczny (maks. jeden naraz)
+static volatile bool s_read_pending = false;
+static uint8_t s_read_reg;
+static uint8_t *s_read_buf;
+static size_t s_read_len;
+static mpu6050_read_cb_t s_read_cb;
+static void *s_read_arg;
+
+// Bufory transakcji w kolejce - muszą żyć do ich zakończenia, także gdy
+// oczekiwanie przekroczy limit czasu
+static uint8_t s_batch_buf[MPU6050_BATCH_MAX][2];
+static uint8_t s_sync_tx[2];
+static uint8_t s_sync_rx[MPU6050_FIFO_BURST_BYTES];
+static bool s_queue_stale = false;      // Transakcje po przekroczeniu czasu wciąż w kolejce
+
+static mpu6050_i2c_stats_t s_i2c_stats = {0};
 
 // Zmienne statyczne przechowujące aktualny dzielnik (skalę)
 static float s_accel_scale = 16384.0f;
@@ -35,75 +85,215 @@ static float s_gyro_scale = 131.0f;
 
 static mpu6050_offsets_t s_offsets = {0, 0, 0, 0, 0, 0};
 
+// Odwrotności skal i mnożniki Q16 - przeliczane przy zmianie zakresu/offsetów
+static mpu6050_scale_t s_scale;
+
+// Aktualny tryb DLPF - decyduje o bazowej częstotliwości próbkowania (1 kHz / 8 kHz)
+static uint8_t s_dlpf_cfg = 0;
+
+// Stan FIFO
+static uint8_t s_fifo_frame_size = 0;   // 0 = FIFO wyłączone
+static mpu6050_fifo_stats_t s_fifo_stats = {0};
+
+static void update_scale(void) {
+    mpu6050_scale_init(&s_scale, s_accel_scale, s_gyro_scale, &s_offsets);
+}
+
+static void stats_record(int64_t start_us, uint32_t transactions, esp_err_t ret) {
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start_us);
+
+    s_i2c_stats.transactions += transactions;
+    s_i2c_stats.total_us += elapsed;
+    s_i2c_stats.last_us = elapsed;
+    if (elapsed > s_i2c_stats.max_us) s_i2c_stats.max_us = elapsed;
+    if (ret != ESP_OK) s_i2c_stats.errors++;
+}
+
+// Callback zakończenia transakcji (kontekst przerwania)
+static bool IRAM_ATTR i2c_trans_done_cb(i2c_master_dev_handle_t dev, const i2c_master_event_data_t *evt, void *arg) {
+    uint8_t tag = ASYNC_TAG_SYNC;
+    if (s_tag_tail != s_tag_head) {
+        tag = s_tag_ring[s_tag_tail];
+        s_tag_tail = (s_tag_tail + 1) & (ASYNC_TAG_RING_SIZE - 1);
+    }
+
+    esp_err_t result = (evt->event == I2C_EVENT_DONE) ? ESP_OK : ESP_FAIL;
+
+    if (tag == ASYNC_TAG_READ) {
+        s_read_pending = false;
+        if (s_read_cb) s_read_cb(result, s_read_reg, s_read_buf, s_read_len, s_read_arg);
+    } else if (result != ESP_OK) {
+        s_async_error = true;
+    }
+    return false;
+}
+
+static void tag_push(uint8_t tag) {
+    s_tag_ring[s_tag_head] = tag;
+    s_tag_head = (s_tag_head + 1) & (ASYNC_TAG_RING_SIZE - 1);
+}
+
+// Cofa znacznik transakcji, której nie udało się zlecić - nie będzie dla niej
+// zakończenia, a kolejne zakończenia muszą trafić na swoje znaczniki
+static void tag_rollback(esp_err_t submit_ret) {
+    if (!s_async_ok || submit_ret == ESP_OK) return;
+    s_tag_head = (s_tag_head - 1) & (ASYNC_TAG_RING_SIZE - 1);
+}
+
+// Czeka na zakończenie wszystkich transakcji w kolejce i zwraca zbiorczy wynik
+static esp_err_t wait_queued(esp_err_t submit_ret) {
+    if (!s_async_ok) return submit_ret;
+
+    esp_err_t ret = i2c_master_bus_wait_all_done(s_bus, MPU6050_I2C_TIMEOUT_MS * MPU6050_BATCH_MAX);
+    s_queue_stale = (ret != ESP_OK);
+    if (submit_ret != ESP_OK) return submit_ret;
+    if (ret != ESP_OK) return ret;
+    return s_async_error ? ESP_FAIL : ESP_OK;
+}
+
+// Bufory statyczne można użyć ponownie dopiero, gdy sterownik skończył
+// transakcje, których nie doczekało poprzednie wywołanie
+static esp_err_t wait_stale(void) {
+    if (!s_queue_stale) return ESP_OK;
+    esp_err_t ret = i2c_master_bus_wait_all_done(s_bus, MPU6050_I2C_TIMEOUT_MS * MPU6050_BATCH_MAX);
+    if (ret == ESP_OK) s_queue_stale = false;
+    return ret;
+}
+
 static esp_err_t mpu6050_write_byte(uint8_t reg_addr, uint8_t data) {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-
-    // Start komunikacji
-    i2c_master_start(cmd);
-    // Adres urządzenia + bit zapisu (0)
-    i2c_master_write_byte(cmd, (s_device_addr << 1) | I2C_MASTER_WRITE, true);
-    // Adres rejestru, do którego chcemy pisać
-    i2c_master_write_byte(cmd, reg_addr, true);
-    // Dane do zapisania
-    i2c_master_write_byte(cmd, data, true);
-    // Stop komunikacji
-    i2c_master_stop(cmd);
-
-    // Wykonanie komendy
-    esp_err_t ret = i2c_master_cmd_begin(s_i2c_port, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    esp_err_t ret = wait_stale();
+    if (ret != ESP_OK) return ret;
 
+    // Adres rejestru + dane w jednej transakcji
+    s_sync_tx[0] = reg_addr;
+    s_sync_tx[1] = data;
+    int64_t start = esp_timer_get_time();
+
+    s_async_error = false;
+    if (s_async_ok) tag_push(ASYNC_TAG_SYNC);
+    ret = i2c_master_transmit(s_dev, s_sync_tx, 2, MPU6050_I2C_TIMEOUT_MS);
+    tag_rollback(ret);
+    ret = wait_queued(ret);
+
+    stats_record(start, 1, ret);
     return ret;
 }
 
 static esp_err_t mpu6050_read_bytes(uint8_t reg_addr, uint8_t *data, size_t len) {
     if (len == 0) return ESP_OK;
+    if (len > sizeof(s_sync_rx)) return ESP_ERR_INVALID_SIZE;
+    esp_err_t ret = wait_stale();
+    if (ret != ESP_OK) return ret;
 
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    // Zapis adresu rejestru, restart i odczyt 'len' bajtów
+    s_sync_tx[0] = reg_addr;
+    int64_t start = esp_timer_get_time();
 
-    // KROK 1: Wskazanie rejestru, od którego chcemy czytać
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (s_device_addr << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, reg_addr, true);
+    s_async_error = false;
+    if (s_async_ok) tag_push(ASYNC_TAG_SYNC);
+    ret = i2c_master_transmit_receive(s_dev, s_sync_tx, 1, s_sync_rx, len, MPU6050_I2C_TIMEOUT_MS);
+    tag_rollback(ret);
+    ret = wait_queued(ret);
+    if (ret == ESP_OK) memcpy(data, s_sync_rx, len);
 
-    // KROK 2: Restart i faktyczny odczyt
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (s_device_addr << 1) | I2C_MASTER_READ, true);
+    stats_record(start, 1, ret);
+    return ret;
+}
 
-    // Czytamy len-1 bajtów z ACK, ostatni bajt z NACK (koniec transmisji)
-    if (len > 1) {
-        i2c_master_read(cmd, data, len - 1, I2C_MASTER_ACK);
-    }
+esp_err_t mpu6050_write_batch(const mpu6050_reg_write_t *writes, size_t count) {
+    if (count == 0) return ESP_OK;
+    if (count > MPU6050_BATCH_MAX) return ESP_ERR_INVALID_SIZE;
 
-    i2c_master_read_byte(cmd, data + len - 1, I2C_MASTER_NACK);
-    
-    i2c_master_stop(cmd);
+    esp_err_t ret = wait_stale();
+    if (ret != ESP_OK) return ret;
+
+    int64_t start = esp_timer_get_time();
+    s_async_error = false;
 
-    esp_err_t ret = i2c_master_cmd_begin(s_i2c_port, cmd, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd);
+    for (size_t i = 0; i < count; i++) {
+        s_batch_buf[i][0] = writes[i].reg;
+        s_batch_buf[i][1] = writes[i].value;
 
+        // W trybie asynchronicznym zapisy trafiają do kolejki bez czekania
+        if (s_async_ok) tag_push(ASYNC_TAG_SYNC);
+        ret = i2c_master_transmit(s_dev, s_batch_buf[i], 2, MPU6050_I2C_TIMEOUT_MS);
+        if (ret != ESP_OK) {
+            tag_rollback(ret);
+            break;
+        }
+    }
+    ret = wait_queued(ret);
+
+    stats_record(start, count, ret);
+    s_i2c_stats.batches++;
+    return ret;
+}
+
+esp_err_t mpu6050_read_async(uint8_t reg_addr, uint8_t *data, size_t len, mpu6050_read_cb_t cb, void *arg) {
+    if (!s_async_ok) return ESP_ERR_NOT_SUPPORTED;
+    if (len == 0 || data == NULL) return ESP_ERR_INVALID_ARG;
+    if (s_read_pending) return ESP_ERR_INVALID_STATE;
+
+    s_read_reg = reg_addr;
+    s_read_buf = data;
+    s_read_len = len;
+    s_read_cb = cb;
+    s_read_arg = arg;
+    s_read_pending = true;
+
+    tag_push(ASYNC_TAG_READ);
+    esp_err_t ret = i2c_master_transmit_receive(s_dev, &s_read_reg, 1, data, len, MPU6050_I2C_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        tag_rollback(ret);
+        s_read_pending = false;
+        return ret;
+    }
+    s_i2c_stats.async_reads++;
     return ret;
 }
 
+mpu6050_i2c_stats_t mpu6050_get_i2c_stats(void) {
+    return s_i2c_stats;
+}
+
+void mpu6050_reset_i2c_stats(void) {
+    memset(&s_i2c_stats, 0, sizeof(s_i2c_stats));
+}
+
 esp_err_t mpu6050_init(const mpu6050_config_t *conf) {
-    s_device_addr = conf->device_addr;
-    s_i2c_port = conf->i2c_port;
+    update_scale();
 
-    i2c_config_t i2c_conf = {
-        .mode = I2C_MODE_MASTER,
+    i2c_master_bus_config_t bus_conf = {
+        .i2c_port = conf->i2c_port,
         .sda_io_num = conf->sda_io,
         .scl_io_num = conf->scl_io,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE, // Wewnętrzne pull-upy
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = I2C_MASTER_FREQ_HZ
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .trans_queue_depth = MPU6050_I2C_QUEUE_DEPTH,
+        .flags.enable_internal_pullup = true, // Wewnętrzne pull-upy
     };
 
-    esp_err_t err = i2c_param_config(s_i2c_port, &i2c_conf);
+    esp_err_t err = i2c_new_master_bus(&bus_conf, &s_bus);
     if(err != ESP_OK) return err;
 
-    err = i2c_driver_install(s_i2c_port, i2c_conf.mode, I2C_MASTER_RX_BUF_DISABLE, I2C_MASTER_TX_BUF_DISABLE, 0);
+    i2c_device_config_t dev_conf = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = conf->device_addr,
+        .scl_speed_hz = I2C_MASTER_FREQ_HZ,
+    };
+
+    err = i2c_master_bus_add_device(s_bus, &dev_conf, &s_dev);
     if(err != ESP_OK) return err;
 
+    // Callback zakończenia przełącza urządzenie w tryb transakcji w tle
+    i2c_master_event_callbacks_t cbs = {
+        .on_trans_done = i2c_trans_done_cb,
+    };
+    s_async_ok = (i2c_master_register_event_callbacks(s_dev, &cbs, NULL) == ESP_OK);
+    if (!s_async_ok) {
+        ESP_LOGW(TAG, "Transakcje asynchroniczne niedostępne - tryb synchroniczny");
+    }
+
     ESP_LOGI(TAG, "I2C zainicjowane. Wybudzanie MPU...");
 
     return mpu6050_write_byte(REG_PWR_MGMT_1, 0);
@@ -126,6 +316,7 @@ esp_err_t mpu6050_set_accel_range(mpu6050_accel_range_t range) {
         case ACCEL_RANGE_16G: s_accel_scale = 2048.0f; break;
         default: return ESP_ERR_INVALID_ARG;
     }
+    update_scale();
 
     // Zapisujemy bity do rejestru (bit 3 i 4)
     return mpu6050_write_byte(REG_ACCEL_CONFIG, range << 3);
@@ -139,12 +330,14 @@ esp_err_t mpu6050_set_gyro_range(mpu6050_gyro_range_t range) {
         case GYRO_RANGE_2000DPS: s_gyro_scale = 16.4f; break;
         default: return ESP_ERR_INVALID_ARG;
     }
+    update_scale();
 
     // Zapisujemy bity do rejestru (bit 3 i 4)
     return mpu6050_write_byte(REG_GYRO_CONFIG, range << 3);
 }
 
 esp_err_t mpu6050_set_dlpf_mode(mpu6050_dlpf_t mode) {
+    s_dlpf_cfg = mode;
     return mpu6050_write_byte(REG_CONFIG, mode);
 }
 
@@ -166,9 +359,9 @@ esp_err_t mpu6050_get_acceleration(mpu6050_acceleration_t *accel) {
         int16_t ray = (int16_t)((raw_data[2] << 8) | raw_data[3]);
         int16_t raz = (int16_t)((raw_data[4] << 8) | raw_data[5]);
 
-        accel->x = (rax - s_offsets.accel_x) / s_accel_scale;
-        accel->y = (ray - s_offsets.accel_y) / s_accel_scale;
-        accel->z = (raz - s_offsets.accel_z) / s_accel_scale;
+        accel->x = (rax - s_offsets.accel_x) * s_scale.accel_inv;
+        accel->y = (ray - s_offsets.accel_y) * s_scale.accel_inv;
+        accel->z = (raz - s_offsets.accel_z) * s_scale.accel_inv;
 
         return ESP_OK;
     }
@@ -186,9 +379,9 @@ esp_err_t mpu6050_get_rotation(mpu6050_rotation_t *gyro) {
         int16_t rgy = (int16_t)((raw_data[2] << 8) | raw_data[3]);
         int16_t rgz = (int16_t)((raw_data[4] << 8) | raw_data[5]);
 
-        gyro->x = (rgx - s_offsets.gyro_x) / s_gyro_scale;
-        gyro->y = (rgy - s_offsets.gyro_y) / s_gyro_scale;
-        gyro->z = (rgz - s_offsets.gyro_z) / s_gyro_scale;
+        gyro->x = (rgx - s_offsets.gyro_x) * s_scale.gyro_inv;
+        gyro->y = (rgy - s_offsets.gyro_y) * s_scale.gyro_inv;
+        gyro->z = (rgz - s_offsets.gyro_z) * s_scale.gyro_inv;
 
         return ESP_OK;
     }
@@ -208,41 +401,29 @@ esp_err_t mpu6050_get_temperature(float *temp) {
     return ESP_FAIL;
 }
 
-esp_err_t mpu6050_get_data(mpu6050_data_t *data) {
+esp_err_t mpu6050_get_raw_data(mpu6050_raw_sample_t *raw) {
     uint8_t raw_data[14];
     // Czytaj 14 bajtów zaczynając od ACCEL_XOUT_H (0x3B)
-    // Kolejność w pamięci MPU: Accel(6) -> Temp(2) -> Gyro(6)
     if (mpu6050_read_bytes(REG_ACCEL_XOUT_H, raw_data, 14) == ESP_OK) {
+        mpu6050_unpack_raw(raw_data, raw);
+        return ESP_OK;
+    }
 
-        // Łączenie bajtów (High << 8 | Low)
-        int16_t rax = (int16_t)((raw_data[0] << 8) | raw_data[1]);
-        int16_t ray = (int16_t)((raw_data[2] << 8) | raw_data[3]);
-        int16_t raz = (int16_t)((raw_data[4] << 8) | raw_data[5]);
-
-        int16_t rtemp = (int16_t)((raw_data[6] << 8) | raw_data[7]);
-
-        int16_t rgx = (int16_t)((raw_data[8] << 8) | raw_data[9]);
-        int16_t rgy = (int16_t)((raw_data[10] << 8) | raw_data[11]);
-        int16_t rgz = (int16_t)((raw_data[12] << 8) | raw_data[13]);
-
-        // Konwersja na jednostki czytelne dla człowieka
-        // Domyślna czułość Accel to +/- 2g (dzielnik 16384.0)
-        // Domyslna czułość Gyro to +/- 250deg/s (dzielnik 131.0)
-
-        data->ax = (rax - s_offsets.accel_x) / s_accel_scale;
-        data->ay = (ray - s_offsets.accel_y) / s_accel_scale;
-        data->az = (raz - s_offsets.accel_z) / s_accel_scale;
+    return ESP_FAIL;
+}
 
-        data->gx = (rgx - s_offsets.gyro_x) / s_gyro_scale;
-        data->gy = (rgy - s_offsets.gyro_y) / s_gyro_scale;
-        data->gz = (rgz - s_offsets.gyro_z) / s_gyro_scale;
+esp_err_t mpu6050_get_data(mpu6050_data_t *data) {
+    mpu6050_raw_sample_t raw;
+    esp_err_t ret = mpu6050_get_raw_data(&raw);
+    if (ret != ESP_OK) return ret;
 
-        data->temp = (rtemp / 340.0f) + 36.53f;
+    // Konwersja na jednostki czytelne dla człowieka (kernel wsadowy, n = 1)
+    mpu6050_convert_float(&s_scale, &raw, data, 1);
+    return ESP_OK;
+}
 
-        return ESP_OK;
-    }
-    
-    return ESP_FAIL;
+mpu6050_scale_t mpu6050_get_scale(void) {
+    return s_scale;
 }
 
 esp_err_t mpu6050_calibrate(uint16_t iterations) {
@@ -275,6 +456,7 @@ esp_err_t mpu6050_calibrate(uint16_t iterations) {
     s_offsets.gyro_x = gx_sum / iterations;
     s_offsets.gyro_y = gy_sum / iterations;
     s_offsets.gyro_z = gz_sum / iterations;
+    update_scale();
 
     ESP_LOGI(TAG, "KALIBRACJA ZAKOŃCZONA. Offsety: A[%d %d %d] G[%d %d %d]",
              s_offsets.accel_x, s_offsets.accel_y, s_offsets.accel_z,
@@ -287,29 +469,83 @@ mpu6050_offsets_t mpu6050_get_offsets(void) {
     return s_offsets;
 }
 
+void mpu6050_set_offsets(const mpu6050_offsets_t *offsets) {
+    s_offsets = *offsets;
+    update_scale();
+}
+
+uint16_t mpu6050_get_accel_lsb_per_g(void) {
+    return (uint16_t)s_accel_scale;
+}
+
 esp_err_t mpu6050_enable_motion_detection(uint8_t threshold, uint8_t duration) {
-    esp_err_t ret;
+    const mpu6050_reg_write_t writes[] = {
+        // KONFIGURACJA ZASILANIA (Uśpienie żyroskopu, aktywacja Low-Power Accel)
+        {REG_PWR_MGMT_1, 0x09},
+        {REG_PWR_MGMT_2, 0x07},
+        // USTAWIENIA DETEKCJI
+        {REG_MOT_THR, threshold},
+        {REG_MOT_DUR, duration},
+        // WŁĄCZENIE PRZERWANIA (zatrzaśnięte do odczytu INT_STATUS - pin
+        // może budzić ESP32 z deep sleep poziomem zamiast impulsu 50 us)
+        {REG_INT_PIN_CFG, 0x20},
+        {REG_INT_ENABLE, 0x40},
+        // AKTYWACJA TRYBU LOW-POWER
+        {REG_CONFIG, 0x01},
+    };
 
-    // KONFIGURACJA ZASILANIA (Uśpienie żyroskopu, aktywacja Low-Power Accel)
-    // REG_PWR_MGMT_1 (0x6B)
-    ret = mpu6050_write_byte(REG_PWR_MGMT_1, 0x09);
-    ret = mpu6050_write_byte(REG_PWR_MGMT_2, 0x07);
+    // Cała konfiguracja jedną paczką - pierwszy błąd przerywa i jest zwracany
+    esp_err_t ret = mpu6050_write_batch(writes, sizeof(writes) / sizeof(writes[0]));
+    if (ret == ESP_OK) s_dlpf_cfg = 0x01;
 
-    // USTAWIENIA DETEKCJI
-    ret = mpu6050_write_byte(REG_MOT_THR, threshold);
-    if(ret != ESP_OK) return ret;
+    return ret;
+}
 
-    ret = mpu6050_write_byte(REG_MOT_DUR, duration);
-    if(ret != ESP_OK) return ret;
+esp_err_t mpu6050_apply_sensing(const mpu6050_sensing_t *sensing) {
+    float accel_scale;
+    switch (sensing->accel_range) {
+        case ACCEL_RANGE_2G:  accel_scale = 16384.0f; break;
+        case ACCEL_RANGE_4G:  accel_scale = 8192.0f; break;
+        case ACCEL_RANGE_8G:  accel_scale = 4096.0f; break;
+        case ACCEL_RANGE_16G: accel_scale = 2048.0f; break;
+        default: return ESP_ERR_INVALID_ARG;
+    }
 
-    // WŁĄCZENIE PRZERWANIA
-    ret = mpu6050_write_byte(REG_INT_ENABLE, 0x40);
-    if(ret != ESP_OK) return ret;
+    // Bez żyroskopu zegar z wewnętrznego oscylatora, inaczej PLL z osi X
+    uint8_t pwr1 = sensing->gyro_standby ? 0x00 : 0x01;
+    if (sensing->temp_disable) pwr1 |= 0x08;
+    if (sensing->cycle) pwr1 |= 0x20;
+    uint8_t pwr2 = (uint8_t)(sensing->lp_wake << 6);
+    if (sensing->gyro_standby) pwr2 |= 0x07;
+
+    const mpu6050_reg_write_t writes[] = {
+        {REG_CONFIG, sensing->dlpf},
+        {REG_ACCEL_CONFIG, sensing->accel_range << 3},
+        {REG_MOT_THR, sensing->motion_threshold},
+        {REG_MOT_DUR, sensing->motion_duration},
+        {REG_INT_PIN_CFG, 0x20},
+        {REG_INT_ENABLE, sensing->motion_int ? 0x40 : 0x00},
+        // Zasilanie na końcu - LP_WAKE przed bitem CYCLE
+        {REG_PWR_MGMT_2, pwr2},
+        {REG_PWR_MGMT_1, pwr1},
+    };
 
-    // AKTYWACJA TRYBU LOW-POWER
-    ret = mpu6050_write_byte(REG_CONFIG, 0x01);
+    esp_err_t ret = mpu6050_write_batch(writes, sizeof(writes) / sizeof(writes[0]));
+    if (ret != ESP_OK) return ret;
 
-    return ret;
+    s_dlpf_cfg = sensing->dlpf;
+    s_accel_scale = accel_scale;
+    update_scale();
+    return ESP_OK;
+}
+
+esp_err_t mpu6050_set_motion_threshold(uint8_t threshold, uint8_t duration) {
+    const mpu6050_reg_write_t writes[] = {
+        {REG_MOT_THR, threshold},
+        {REG_MOT_DUR, duration},
+    };
+
+    return mpu6050_write_batch(writes, sizeof(writes) / sizeof(writes[0]));
 }
 
 uint8_t mpu6050_get_int_status(void) {
@@ -319,12 +555,14 @@ uint8_t mpu6050_get_int_status(void) {
 }
 
 esp_err_t mpu6050_set_normal_mode(void) {
-    // 1. Zresetowanie PWR_MGMT_1 (wybudzenie wszystkiego, użycie zegara PLL)
-    esp_err_t ret = mpu6050_write_byte(REG_PWR_MGMT_1, 0x01);
-    if (ret != ESP_OK) return ret;
+    const mpu6050_reg_write_t writes[] = {
+        // 1. Zresetowanie PWR_MGMT_1 (wybudzenie wszystkiego, użycie zegara PLL)
+        {REG_PWR_MGMT_1, 0x01},
+        // 2. Zresetowanie PWR_MGMT_2 (wyjście z trybu Standby)
+        {REG_PWR_MGMT_2, 0x00},
+    };
 
-    // 2. Zresetowanie PWR_MGMT_2 (wyjście z trybu Standby)
-    return mpu6050_write_byte(REG_PWR_MGMT_2, 0x00);
+    return mpu6050_write_batch(writes, sizeof(writes) / sizeof(writes[0]));
 }
 
 uint8_t mpu6050_read_register(uint8_t reg_addr) {
@@ -334,4 +572,170 @@ uint8_t mpu6050_read_register(uint8_t reg_addr) {
     }
 
     return 0xFF;
-}
\ No newline at end of file
+}
+
+// --- FIFO ---
+
+void mpu6050_ring_init(mpu6050_ring_t *ring, mpu6050_raw_sample_t *buf, uint16_t capacity) {
+    ring->buf = buf;
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->count = 0;
+}
+
+static void ring_push(mpu6050_ring_t *ring, const mpu6050_raw_sample_t *sample) {
+    ring->buf[ring->head] = *sample;
+    ring->head = (ring->head + 1) % ring->capacity;
+
+    if (ring->count < ring->capacity) {
+        ring->count++;
+    } else {
+        // Bufor pełny - nadpisaliśmy najstarszą próbkę
+        s_fifo_stats.ring_drops++;
+    }
+}
+
+bool mpu6050_ring_pop(mpu6050_ring_t *ring, mpu6050_raw_sample_t *out) {
+    if (ring->count == 0) return false;
+
+    uint16_t tail = (ring->head + ring->capacity - ring->count) % ring->capacity;
+    *out = ring->buf[tail];
+    ring->count--;
+    return true;
+}
+
+esp_err_t mpu6050_fifo_start(mpu6050_fifo_mode_t mode, uint16_t odr_hz) {
+    // Częstotliwość bazowa: 8 kHz bez DLPF, 1 kHz z DLPF (akcelerometr zawsze max 1 kHz)
+    uint32_t base_hz = (s_dlpf_cfg == 0 || s_dlpf_cfg == 7) ? 8000 : 1000;
+    if (odr_hz == 0 || odr_hz > base_hz) return ESP_ERR_INVALID_ARG;
+    uint32_t divider = (base_hz / odr_hz) - 1;
+    if (divider > 255) divider = 255;
+
+    uint8_t fifo_mask = FIFO_EN_ACCEL;
+    s_fifo_frame_size = 6;
+    if (mode == MPU6050_FIFO_ACCEL_GYRO) {
+        fifo_mask |= FIFO_EN_GYRO_XYZ;
+        s_fifo_frame_size = 12;
+    }
+
+    const mpu6050_reg_write_t writes[] = {
+        {REG_FIFO_EN, 0x00},
+        {REG_USER_CTRL, USER_CTRL_FIFO_RESET},
+        {REG_SMPLRT_DIV, (uint8_t)divider},
+        {REG_FIFO_EN, fifo_mask},
+        {REG_USER_CTRL, USER_CTRL_FIFO_EN},
+    };
+
+    esp_err_t ret = mpu6050_write_batch(writes, sizeof(writes) / sizeof(writes[0]));
+    if (ret != ESP_OK) return ret;
+
+    memset(&s_fifo_stats, 0, sizeof(s_fifo_stats));
+    s_fifo_stats.start_us = esp_timer_get_time();
+
+    ESP_LOGI(TAG, "FIFO włączone: %lu Hz, %d B/próbkę", base_hz / (divider + 1), s_fifo_frame_size);
+    return ESP_OK;
+}
+
+esp_err_t mpu6050_fifo_stop(void) {
+    s_fifo_frame_size = 0;
+
+    const mpu6050_reg_write_t writes[] = {
+        {REG_FIFO_EN, 0x00},
+        {REG_USER_CTRL, USER_CTRL_FIFO_RESET},
+    };
+
+    return mpu6050_write_batch(writes, sizeof(writes) / sizeof(writes[0]));
+}
+
+static esp_err_t fifo_reset(void) {
+    const mpu6050_reg_write_t writes[] = {
+        {REG_USER_CTRL, USER_CTRL_FIFO_RESET},
+        {REG_USER_CTRL, USER_CTRL_FIFO_EN},
+    };
+
+    return mpu6050_write_batch(writes, sizeof(writes) / sizeof(writes[0]));
+}
+
+esp_err_t mpu6050_fifo_drain(mpu6050_ring_t *ring, uint16_t max_samples, uint16_t *read) {
+    if (read) *read = 0;
+    if (s_fifo_frame_size == 0) return ESP_ERR_INVALID_STATE;
+
+    // KROK 1: Ile bajtów czeka w FIFO
+    uint8_t count_raw[2];
+    esp_err_t ret = mpu6050_read_bytes(REG_FIFO_COUNTH, count_raw, 2);
+    if (ret != ESP_OK) return ret;
+    s_fifo_stats.i2c_bytes += I2C_READ_OVERHEAD_BYTES + 2;
+
+    uint16_t fifo_count = (uint16_t)((count_raw[0] << 8) | count_raw[1]);
+
+    // FIFO pełne = czujnik gubi próbki, a granica ramek może być przesunięta
+    if (fifo_count >= MPU6050_FIFO_SIZE) {
+        s_fifo_stats.overflows++;
+        ESP_LOGW(TAG, "FIFO przepełnione - reset");
+        ret = fifo_reset();
+        return (ret == ESP_OK) ? ESP_ERR_INVALID_SIZE : ret;
+    }
+
+    uint16_t available = fifo_count / s_fifo_frame_size;
+    if (available > max_samples) available = max_samples;
+
+    // KROK 2: Odczyt całych ramek paczkami
+    uint8_t raw_data[MPU6050_FIFO_BURST_BYTES];
+    uint16_t frames_per_burst = MPU6050_FIFO_BURST_BYTES / s_fifo_frame_size;
+    uint16_t done = 0;
+
+    while (done < available) {
+        uint16_t frames = available - done;
+        if (frames > frames_per_burst) frames = frames_per_burst;
+
+        size_t len = (size_t)frames * s_fifo_frame_size;
+        ret = mpu6050_read_bytes(REG_FIFO_R_W, raw_data, len);
+        if (ret != ESP_OK) break;
+
+        s_fifo_stats.i2c_bytes += I2C_READ_OVERHEAD_BYTES + len;
+        s_fifo_stats.bursts++;
+
+        for (uint16_t f = 0; f < frames; f++) {
+            const uint8_t *p = &raw_data[f * s_fifo_frame_size];
+            mpu6050_raw_sample_t sample = {0};
+
+            // Kolejność w FIFO: Accel(6) -> Gyro(6)
+            sample.ax = (int16_t)((p[0] << 8) | p[1]);
+            sample.ay = (int16_t)((p[2] << 8) | p[3]);
+            sample.az = (int16_t)((p[4] << 8) | p[5]);
+
+            if (s_fifo_frame_size == 12) {
+                sample.gx = (int16_t)((p[6] << 8) | p[7]);
+                sample.gy = (int16_t)((p[8] << 8) | p[9]);
+                sample.gz = (int16_t)((p[10] << 8) | p[11]);
+            }
+
+            ring_push(ring, &sample);
+        }
+        done += frames;
+    }
+
+    s_fifo_stats.samples += done;
+    if (read) *read = done;
+
+    return ret;
+}
+
+mpu6050_fifo_stats_t mpu6050_fifo_get_stats(void) {
+    return s_fifo_stats;
+}
+
+void mpu6050_fifo_log_stats(void) {
+    int64_t elapsed_us = esp_timer_get_time() - s_fifo_stats.start_us;
+    if (elapsed_us <= 0 || s_fifo_stats.samples == 0) {
+        ESP_LOGI(TAG, "FIFO: brak danych");
+        return;
+    }
+
+    float samples_per_s = s_fifo_stats.samples * 1000000.0f / (float)elapsed_us;
+    float bytes_per_sample = (float)s_fifo_stats.i2c_bytes / (float)s_fifo_stats.samples;
+
+    ESP_LOGI(TAG, "FIFO: %.1f próbek/s, %.2f B I2C/próbkę (%lu paczek, %lu przepełnień, %lu nadpisanych)",
+             samples_per_s, bytes_per_sample,
+             s_fifo_stats.bursts, s_fifo_stats.overflows, s_fifo_stats.ring_drops);
+}
@@ -0,0 +1,90 @@
+#include "mpu6050_convert.h"
+
+// Temperatura: T = raw / 340 + 36.53  ->  T * 100 = raw * 5 / 17 + 3653
+#define TEMP_CENTI_OFFSET   3653
+
+void mpu6050_scale_init(mpu6050_scale_t *scale, float accel_lsb_per_g, float gyro_lsb_per_dps,
+                        const mpu6050_offsets_t *offsets) {
+    scale->offsets = *offsets;
+    scale->accel_inv = 1.0f / accel_lsb_per_g;
+    scale->gyro_inv = 1.0f / gyro_lsb_per_dps;
+
+    // 2^32 / czułość mieści się w int32 dla wszystkich zakresów (max 2^32 / 16.4)
+    scale->accel_mul_q32 = (int32_t)(4294967296.0 / accel_lsb_per_g + 0.5);
+    scale->gyro_mul_q32 = (int32_t)(4294967296.0 / gyro_lsb_per_dps + 0.5);
+}
+
+static int16_t offset_at(int16_t base, int16_t slope_q8, int32_t dt_centi) {
+    // slope [LSB/C, Q8] * dt [0.01 C] -> LSB: dzielnik 256 * 100
+    int32_t v = base + (int32_t)(((int64_t)slope_q8 * dt_centi) / 25600);
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)v;
+}
+
+void mpu6050_scale_set_temp(mpu6050_scale_t *scale, const mpu6050_tempco_t *tc, int16_t temp_centi) {
+    const int32_t dt = (int32_t)temp_centi - tc->ref_temp_centi;
+    mpu6050_offsets_t *o = &scale->offsets;
+
+    o->accel_x = offset_at(tc->base.accel_x, tc->slope_q8[0], dt);
+    o->accel_y = offset_at(tc->base.accel_y, tc->slope_q8[1], dt);
+    o->accel_z = offset_at(tc->base.accel_z, tc->slope_q8[2], dt);
+    o->gyro_x = offset_at(tc->base.gyro_x, tc->slope_q8[3], dt);
+    o->gyro_y = offset_at(tc->base.gyro_y, tc->slope_q8[4], dt);
+    o->gyro_z = offset_at(tc->base.gyro_z, tc->slope_q8[5], dt);
+}
+
+void mpu6050_unpack_raw(const uint8_t raw_data[14], mpu6050_raw_sample_t *out) {
+    // Kolejność w pamięci MPU: Accel(6) -> Temp(2) -> Gyro(6)
+    out->ax = (int16_t)((raw_data[0] << 8) | raw_data[1]);
+    out->ay = (int16_t)((raw_data[2] << 8) | raw_data[3]);
+    out->az = (int16_t)((raw_data[4] << 8) | raw_data[5]);
+
+    out->temp = (int16_t)((raw_data[6] << 8) | raw_data[7]);
+
+    out->gx = (int16_t)((raw_data[8] << 8) | raw_data[9]);
+    out->gy = (int16_t)((raw_data[10] << 8) | raw_data[11]);
+    out->gz = (int16_t)((raw_data[12] << 8) | raw_data[13]);
+}
+
+void mpu6050_convert_float(const mpu6050_scale_t *scale, const mpu6050_raw_sample_t *in,
+                           mpu6050_data_t *out, size_t n) {
+    const mpu6050_offsets_t *o = &scale->offsets;
+    const float a_inv = scale->accel_inv;
+    const float g_inv = scale->gyro_inv;
+
+    for (size_t i = 0; i < n; i++) {
+        out[i].ax = (float)(in[i].ax - o->accel_x) * a_inv;
+        out[i].ay = (float)(in[i].ay - o->accel_y) * a_inv;
+        out[i].az = (float)(in[i].az - o->accel_z) * a_inv;
+
+        out[i].gx = (float)(in[i].gx - o->gyro_x) * g_inv;
+        out[i].gy = (float)(in[i].gy - o->gyro_y) * g_inv;
+        out[i].gz = (float)(in[i].gz - o->gyro_z) * g_inv;
+
+        out[i].temp = (float)in[i].temp * (1.0f / 340.0f) + 36.53f;
+    }
+}
+
+static inline int32_t mul_q32(int32_t value, int32_t mul) {
+    return (int32_t)(((int64_t)value * mul) >> 16);
+}
+
+void mpu6050_convert_q16(const mpu6050_scale_t *scale, const mpu6050_raw_sample_t *in,
+                         mpu6050_fixed_data_t *out, size_t n) {
+    const mpu6050_offsets_t *o = &scale->offsets;
+    const int32_t a_mul = scale->accel_mul_q32;
+    const int32_t g_mul = scale->gyro_mul_q32;
+
+    for (size_t i = 0; i < n; i++) {
+        out[i].ax = mul_q32(in[i].ax - o->accel_x, a_mul);
+        out[i].ay = mul_q32(in[i].ay - o->accel_y, a_mul);
+        out[i].az = mul_q32(in[i].az - o->accel_z, a_mul);
+
+        out[i].gx = mul_q32(in[i].gx - o->gyro_x, g_mul);
+        out[i].gy = mul_q32(in[i].gy - o->gyro_y, g_mul);
+        out[i].gz = mul_q32(in[i].gz - o->gyro_z, g_mul);
+
+        out[i].temp = (int32_t)in[i].temp * 5 / 17 + TEMP_CENTI_OFFSET;
+    }
+}
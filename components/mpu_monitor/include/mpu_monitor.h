@@ -1,7 +1,89 @@
 #ifndef MPU_MONITOR_H
 #define MPU_MONITOR_H
 
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "mpu6050.h"
+#include "imu_backend.h"
+#include "mpu_sensing.h"
+
+// The monitor task is the only owner of the MPU and its I2C bus.
+// Other components change sensor settings by posting commands; the task
+// applies them on its next wake-up (commands wake it immediately).
+
+typedef enum {
+    MPU_CMD_SET_THRESHOLD,   // Motion threshold only, duration unchanged
+    MPU_CMD_SET_PROFILE,     // Threshold and duration together
+    MPU_CMD_RECALIBRATE,     // Blocking calibration, deferred until disarmed
+    MPU_CMD_SNAPSHOT,        // Latest sample and detector state (see mpu_monitor_snapshot)
+    MPU_CMD_PREPARE_SLEEP,   // Park the armed stream before deep sleep
+    MPU_CMD_RESUME,          // Restart the stream after an aborted sleep
+    MPU_CMD_SELECT_SENSING,  // Sensing profile used while armed
+} mpu_cmd_type_t;
+
+typedef struct {
+    uint8_t threshold;       // 1 LSB = 2 mg
+    uint8_t duration;        // ms
+} mpu_motion_profile_t;
+
+typedef struct {
+    mpu_cmd_type_t type;
+    union {
+        uint8_t threshold;
+        mpu_motion_profile_t profile;
+        mpu_sensing_id_t sensing;
+    };
+} mpu_cmd_t;
+
+typedef struct {
+    int64_t timestamp_us;
+    mpu6050_raw_sample_t raw;        // Offsets not applied
+    mpu6050_data_t data;             // Converted with current offsets
+    mpu_motion_profile_t profile;    // Effective motion threshold/duration
+    mpu_sensing_id_t sensing;        // Profile currently applied
+    mpu_sensing_id_t armed_sensing;  // Profile selected for the armed state
+    bool streaming;                  // Armed FIFO stream running
+    bool verifying;                  // Motion interrupt under verification
+    float tilt_deg;                  // Angle from armed reference (0 when not streaming)
+} mpu_snapshot_t;
+
+// Creates the command queue. Call before any task may post commands.
+esp_err_t mpu_monitor_init(void);
+
+// Replaces the default MPU-6050 backend (e.g. with another sensor behind
+// imu_backend.h). Only before the task starts; the backend is initialised by it.
+esp_err_t mpu_monitor_set_backend(const imu_backend_t *backend);
+
+// Queues a command without blocking; ESP_ERR_TIMEOUT if the queue is full
+esp_err_t mpu_monitor_post(const mpu_cmd_t *cmd);
+
+// Convenience wrappers around mpu_monitor_post. Threshold and duration
+// override the active sensing profile until another one is selected.
+esp_err_t mpu_monitor_set_threshold(uint8_t threshold);
+esp_err_t mpu_monitor_set_profile(uint8_t threshold, uint8_t duration);
+esp_err_t mpu_monitor_recalibrate(void);
+
+// Selects the armed sensing profile and drops any threshold override.
+// Takes effect at once when armed and not verifying a motion.
+esp_err_t mpu_monitor_select_sensing(mpu_sensing_id_t sensing);
+
+// Requests a snapshot and waits for the monitor task to fill it
+esp_err_t mpu_monitor_snapshot(mpu_snapshot_t *out, uint32_t timeout_ms);
+
+// Parks the armed stream and clears the INT latch so that only a new
+// motion raises the wake pin. Fails while a motion is being verified.
+esp_err_t mpu_monitor_prepare_sleep(uint32_t timeout_ms);
+esp_err_t mpu_monitor_resume(void);
+
+// Armed, motion detection configured and nothing being verified
+bool mpu_monitor_is_idle(void);
+
+// Motions verified and rejected as below the alarm threshold since boot.
+// A change means sub-threshold activity around the bike.
+uint32_t mpu_monitor_activity_count(void);
+
 // The FreeRTOS task function
 void mpu_monitor_task(void *pvParameter);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,54 @@
+#ifndef MPU_SENSING_H
+#define MPU_SENSING_H
+
+/*
+ * Named sensing profiles of the monitor task. Each bundles ODR, DLPF,
+ * accel range, motion threshold/duration, gyro standby and the low-power
+ * wake rate. Pure table and lookups with no ESP-IDF dependencies, so host
+ * replays (tools/motion_bench) run the same settings as the firmware.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "imu_backend.h"
+
+// The monitor picks one by state: the selected armed profile while armed,
+// PARKED_LOW_POWER while parked for deep sleep, TRANSPORT while disarmed
+// and ALARM_TRACKING during an alarm.
+typedef enum {
+    MPU_SENSING_PARKED_LOW_POWER,  // Cycled accel, no stream; verification stream starts on INT
+    MPU_SENSING_PARKED_SENSITIVE,  // Continuous accel, stream for the filter, tilt and pre-trigger
+    MPU_SENSING_TRANSPORT,         // On a carrier or ridden: 8 g, narrow filter, high threshold
+    MPU_SENSING_ALARM_TRACKING,    // Everything on for live snapshots during an alarm
+    MPU_SENSING_COUNT,
+} mpu_sensing_id_t;
+
+typedef struct {
+    const char *name;
+    uint8_t accel_range_g;
+    uint16_t dlpf_hz;
+    uint8_t lp_wake_hz;          // 0 = continuous
+    bool gyro_standby;
+    bool temp_disable;
+    uint8_t motion_threshold;    // 1 LSB = 2 mg
+    uint8_t motion_duration;
+    uint16_t stream_odr_hz;      // Armed stream; 0 = started on a motion INT only
+} mpu_sensing_t;
+
+// NULL for an unknown id
+const mpu_sensing_t *mpu_sensing_get(mpu_sensing_id_t sensing);
+
+// "parked-low-power", "parked-sensitive", "transport", "alarm-tracking"
+const char *mpu_sensing_name(mpu_sensing_id_t sensing);
+// MPU_SENSING_COUNT if the name is unknown
+mpu_sensing_id_t mpu_sensing_from_name(const char *name);
+
+// Backend configuration of a profile: motion interrupt when armed, the
+// sample stream only if requested (and the profile has one)
+imu_config_t mpu_sensing_config(mpu_sensing_id_t sensing, bool armed, bool stream);
+
+// Verification stream for a motion interrupt: the profile's own stream, or
+// for profiles without one (low power) the parked-sensitive settings
+mpu_sensing_id_t mpu_sensing_verify(mpu_sensing_id_t sensing);
+
+#endif // MPU_SENSING_H
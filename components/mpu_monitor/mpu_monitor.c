@@ -1,32 +1,721 @@
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
 #include "esp_log.h"
-#include "mpu6050.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "esp_cpu.h"
+#include "mpu_monitor.h"
+#include "imu_backend_mpu6050.h"
+#include "motion_pipeline.h"
+#include "imu_calib.h"
+#include "imu_tempco.h"
+#include "pretrigger.h"
 #include "arming_manager.h"
+#include "nvs_store.h"
 
 #include "config.h"
 
 static const char *TAG = "MPU_MON";
 
-void mpu_monitor_task(void *pvParameter)
+// Notification bits delivered to the monitor task
+#define MPU_NOTIFY_INT_BIT (1UL << 0)
+#define MPU_NOTIFY_CMD_BIT (1UL << 1)
+
+#define MPU_RING_SAMPLES      (64)
+#define MPU_GYRO_LSB_PER_DPS  (131.0f)   // +/- 250 deg/s, never changed
+#define MPU_GYRO_STARTUP_MS   (50)       // Gyro settling after leaving standby
+
+static TaskHandle_t s_mpu_task_handle = NULL;
+static volatile int64_t s_last_int_time_us = 0;
+
+// Command service: other tasks never touch the I2C bus themselves
+static QueueHandle_t s_cmd_queue = NULL;
+static SemaphoreHandle_t s_sync_lock = NULL;   // One synchronous requester at a time
+static SemaphoreHandle_t s_cmd_done = NULL;
+static esp_err_t s_cmd_result;
+static mpu_snapshot_t s_snapshot;
+static bool s_calib_pending = false;
+static bool s_park_pending = false;
+static bool s_resume_pending = false;
+static volatile bool s_idle = false;        // Armed, not verifying (power manager input)
+static volatile uint32_t s_activity_count = 0;  // Verified and rejected motions (GPS standby input)
+
+// Sensor access goes through the backend; conversion stays here so that
+// offsets learned on one backend apply the same way on any other
+static imu_backend_t s_imu;
+static bool s_imu_set = false;
+static imu_config_t s_imu_cfg = {
+    .mode = IMU_MODE_NORMAL,
+    .accel_range_g = 4,
+};
+static mpu6050_offsets_t s_offsets;
+static mpu6050_scale_t s_scale;
+
+// Offset-vs-temperature fit; s_scale carries the offsets for s_temp_centi
+static imu_tempco_t s_tempco;
+static mpu6050_tempco_t s_tempco_model;
+static int s_tempco_axes = 0;           // Axes with a temperature slope
+static int16_t s_temp_centi;
+static bool s_temp_valid = false;
+static int64_t s_temp_read_us = 0;
+
+// Selection and threshold override survive deep sleep
+static RTC_DATA_ATTR mpu_sensing_id_t s_armed_sensing = MPU_ARMED_SENSING_DEFAULT;
+static RTC_DATA_ATTR bool s_profile_override = false;
+static RTC_DATA_ATTR mpu_motion_profile_t s_profile;
+static mpu_sensing_id_t s_active_sensing = MPU_SENSING_COUNT;
+static bool s_sensing_pending = false;
+
+// Armed detection path (only touched by the monitor task)
+static motion_pipeline_t s_pipe;
+
+// Armed orientation and tilt filter, captured once per arming and carried
+// through deep sleep; a stream started by the motion itself must not
+// re-capture it in the moved pose
+static RTC_DATA_ATTR tilt_detector_t s_tilt_saved;
+static RTC_DATA_ATTR bool s_tilt_armed = false;
+static bool s_tilt_capture = false;         // Stream held until the reference is taken
+
+// Background recalibration state (disarmed path)
+static imu_recal_t s_recal;
+static int64_t s_calib_saved_us = 0;
+static mpu6050_raw_sample_t s_batch_raw[MPU_RING_SAMPLES];
+static mpu6050_fixed_data_t s_batch_fixed[MPU_RING_SAMPLES];
+static mpu6050_raw_sample_t s_last_raw;
+
+// Pre-trigger history; the storage doubles as the persisted record
+static uint32_t s_pre_storage[(PRETRIGGER_RECORD_SIZE(PRETRIGGER_SAMPLES) + 3) / 4];
+static pretrigger_t s_pre;
+static uint64_t s_pre_cycles = 0;
+static uint32_t s_pre_pushed = 0;
+static bool s_last_raw_valid = false;
+
+static const motion_pipeline_config_t s_pipe_config = {
+    .rule = {
+        .sample_rate_hz = MOTION_ODR_HZ,
+        .window_samples = MOTION_WINDOW_SAMPLES,
+        .active_mg = MOTION_ACTIVE_MG,
+        .gap_ms = MOTION_GAP_MS,
+        .sustained_ms = MOTION_SUSTAINED_MS,
+        .rms_mg = MOTION_RMS_MG,
+        .jerk_mg_s = MOTION_JERK_MG_S,
+        .min_variance_mg2 = MOTION_MIN_VARIANCE_MG2,
+    },
+    .tilt = {
+        .threshold_deg = TILT_THRESHOLD_DEG,
+        .accel_weight = TILT_ACCEL_WEIGHT,
+        .accel_gate_g = TILT_ACCEL_GATE_G,
+        .sample_rate_hz = MOTION_ODR_HZ,
+        .settle_samples = TILT_SETTLE_SAMPLES,
+    },
+    .verify_ms = MOTION_VERIFY_MS,
+};
+
+esp_err_t mpu_monitor_init(void)
+{
+    if (s_cmd_queue == NULL) {
+        s_cmd_queue = xQueueCreate(MPU_CMD_QUEUE_LEN, sizeof(mpu_cmd_t));
+        s_sync_lock = xSemaphoreCreateMutex();
+        s_cmd_done = xSemaphoreCreateBinary();
+    }
+    if (s_cmd_queue == NULL || s_sync_lock == NULL || s_cmd_done == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t mpu_monitor_post(const mpu_cmd_t *cmd)
+{
+    if (s_cmd_queue == NULL) return ESP_ERR_INVALID_STATE;
+    if (xQueueSend(s_cmd_queue, cmd, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Command queue full, dropping command %d", cmd->type);
+        return ESP_ERR_TIMEOUT;
+    }
+    // Before the task starts the command simply waits in the queue
+    if (s_mpu_task_handle != NULL) {
+        xTaskNotify(s_mpu_task_handle, MPU_NOTIFY_CMD_BIT, eSetBits);
+    }
+    return ESP_OK;
+}
+
+esp_err_t mpu_monitor_set_threshold(uint8_t threshold)
+{
+    mpu_cmd_t cmd = { .type = MPU_CMD_SET_THRESHOLD, .threshold = threshold };
+    return mpu_monitor_post(&cmd);
+}
+
+esp_err_t mpu_monitor_set_profile(uint8_t threshold, uint8_t duration)
+{
+    mpu_cmd_t cmd = { .type = MPU_CMD_SET_PROFILE, .profile = { threshold, duration } };
+    return mpu_monitor_post(&cmd);
+}
+
+esp_err_t mpu_monitor_recalibrate(void)
+{
+    mpu_cmd_t cmd = { .type = MPU_CMD_RECALIBRATE };
+    return mpu_monitor_post(&cmd);
+}
+
+esp_err_t mpu_monitor_select_sensing(mpu_sensing_id_t sensing)
+{
+    if (sensing >= MPU_SENSING_COUNT) return ESP_ERR_INVALID_ARG;
+    mpu_cmd_t cmd = { .type = MPU_CMD_SELECT_SENSING, .sensing = sensing };
+    return mpu_monitor_post(&cmd);
+}
+
+// Posts a command and waits until the monitor task completes it
+static esp_err_t post_and_wait(mpu_cmd_type_t type, uint32_t timeout_ms, mpu_snapshot_t *snapshot_out)
+{
+    if (s_cmd_queue == NULL) return ESP_ERR_INVALID_STATE;
+    if (xSemaphoreTake(s_sync_lock, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // Drop a completion left over from a requester that timed out
+    xSemaphoreTake(s_cmd_done, 0);
+
+    mpu_cmd_t cmd = { .type = type };
+    esp_err_t err = mpu_monitor_post(&cmd);
+    if (err == ESP_OK) {
+        if (xSemaphoreTake(s_cmd_done, pdMS_TO_TICKS(timeout_ms)) == pdTRUE) {
+            err = s_cmd_result;
+            if (err == ESP_OK && snapshot_out != NULL) {
+                *snapshot_out = s_snapshot;
+            }
+        } else {
+            err = ESP_ERR_TIMEOUT;
+        }
+    }
+
+    xSemaphoreGive(s_sync_lock);
+    return err;
+}
+
+esp_err_t mpu_monitor_snapshot(mpu_snapshot_t *out, uint32_t timeout_ms)
+{
+    return post_and_wait(MPU_CMD_SNAPSHOT, timeout_ms, out);
+}
+
+esp_err_t mpu_monitor_prepare_sleep(uint32_t timeout_ms)
+{
+    return post_and_wait(MPU_CMD_PREPARE_SLEEP, timeout_ms, NULL);
+}
+
+esp_err_t mpu_monitor_resume(void)
+{
+    mpu_cmd_t cmd = { .type = MPU_CMD_RESUME };
+    return mpu_monitor_post(&cmd);
+}
+
+bool mpu_monitor_is_idle(void)
+{
+    return s_idle;
+}
+
+uint32_t mpu_monitor_activity_count(void)
+{
+    return s_activity_count;
+}
+
+esp_err_t mpu_monitor_set_backend(const imu_backend_t *backend)
 {
-    // Initialize MPU
-    mpu6050_config_t mpu_config = {
-        .scl_io = MPU_SCL_IO,
-        .sda_io = MPU_SDA_IO,
-        .device_addr = MPU_DEVICE_ADDR,
-        .i2c_port = MPU_I2C_PORT
+    if (backend == NULL || backend->ops == NULL) return ESP_ERR_INVALID_ARG;
+    if (s_mpu_task_handle != NULL) return ESP_ERR_INVALID_STATE;
+    s_imu = *backend;
+    s_imu_set = true;
+    return ESP_OK;
+}
+
+// Backend INT callback: only timestamps the event and wakes the monitor task.
+// The status read happens in task context.
+static void IRAM_ATTR imu_int_cb(void *arg, bool in_isr)
+{
+    s_last_int_time_us = esp_timer_get_time();
+    if (in_isr) {
+        BaseType_t higher_prio_woken = pdFALSE;
+        xTaskNotifyFromISR(s_mpu_task_handle, MPU_NOTIFY_INT_BIT, eSetBits, &higher_prio_woken);
+        portYIELD_FROM_ISR(higher_prio_woken);
+    } else {
+        xTaskNotify(s_mpu_task_handle, MPU_NOTIFY_INT_BIT, eSetBits);
+    }
+}
+
+static uint16_t imu_lsb_per_g(void)
+{
+    return imu_accel_lsb_per_g(s_imu_cfg.accel_range_g);
+}
+
+// Rebuilds the temperature model around the current offsets and applies it
+static void imu_tempco_refresh(void)
+{
+    s_tempco_axes = imu_tempco_model(&s_tempco, &s_offsets, &s_tempco_model);
+    if (s_tempco_axes > 0 && s_temp_valid) {
+        mpu6050_scale_set_temp(&s_scale, &s_tempco_model, s_temp_centi);
+    }
+}
+
+static void imu_offsets_set(const mpu6050_offsets_t *offsets)
+{
+    s_offsets = *offsets;
+    mpu6050_scale_init(&s_scale, imu_lsb_per_g(), MPU_GYRO_LSB_PER_DPS, &s_offsets);
+    imu_tempco_refresh();
+}
+
+// Reads the die temperature every IMU_TEMP_READ_PERIOD_S (or now) and moves
+// the conversion offsets along the model. Profiles with the temperature
+// sensor off keep the last reading.
+static void imu_temp_poll(bool now)
+{
+    int64_t t = esp_timer_get_time();
+    if (s_imu_cfg.temp_disable) return;
+    if (!now && s_temp_valid && t - s_temp_read_us < (int64_t)IMU_TEMP_READ_PERIOD_S * 1000000) return;
+
+    int16_t temp_centi;
+    if (imu_backend_read_temp(&s_imu, &temp_centi) != ESP_OK) return;
+    s_temp_centi = temp_centi;
+    s_temp_valid = true;
+    s_temp_read_us = t;
+    if (s_tempco_axes > 0) {
+        mpu6050_scale_set_temp(&s_scale, &s_tempco_model, s_temp_centi);
+    }
+}
+
+static esp_err_t imu_apply(void)
+{
+    esp_err_t err = imu_backend_configure(&s_imu, &s_imu_cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "IMU configure (%s) failed: %s", s_imu.ops->name, esp_err_to_name(err));
+    }
+    return err;
+}
+
+// Blocking calibration: sensor flat, Z up, stream off. Spaced samples so
+// that a simulated backend advances as well.
+static esp_err_t imu_calibrate(uint16_t iterations)
+{
+    ESP_LOGI(TAG, "Calibrating - keep the sensor still");
+
+    int32_t sum[6] = {0};
+    for (uint16_t i = 0; i < iterations; i++) {
+        mpu6050_raw_sample_t s;
+        uint16_t n = 0;
+        esp_err_t err = imu_backend_read_batch(&s_imu, &s, 1, &n);
+        if (err != ESP_OK) return err;
+        if (n == 0) return ESP_ERR_INVALID_STATE;
+
+        sum[0] += s.ax;
+        sum[1] += s.ay;
+        sum[2] += s.az;
+        sum[3] += s.gx;
+        sum[4] += s.gy;
+        sum[5] += s.gz;
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+
+    mpu6050_offsets_t offsets = {
+        .accel_x = sum[0] / iterations,
+        .accel_y = sum[1] / iterations,
+        .accel_z = sum[2] / iterations - (int16_t)imu_lsb_per_g(),
+        .gyro_x = sum[3] / iterations,
+        .gyro_y = sum[4] / iterations,
+        .gyro_z = sum[5] / iterations,
+    };
+    imu_offsets_set(&offsets);
+    ESP_LOGI(TAG, "Calibration done: A[%d %d %d] G[%d %d %d]",
+             offsets.accel_x, offsets.accel_y, offsets.accel_z,
+             offsets.gyro_x, offsets.gyro_y, offsets.gyro_z);
+    return ESP_OK;
+}
+
+// temp_centi: die temperature the offsets belong to; windows: still windows
+// merged since the last full calibration
+static void imu_calib_save(int16_t temp_centi, uint16_t windows)
+{
+    imu_calib_record_t rec = {0};
+    rec.accel_lsb_per_g = imu_lsb_per_g();
+    rec.offsets = s_offsets;
+    rec.temp_centi = temp_centi;
+    rec.windows = windows;
+    imu_calib_record_seal(&rec);
+
+    esp_err_t err = nvs_save_imu_calib(&rec, sizeof(rec));
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Saving IMU calibration failed: %s", esp_err_to_name(err));
+        return;
+    }
+    s_calib_saved_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "IMU calibration saved (%u still windows, %.2f C)",
+             rec.windows, rec.temp_centi / 100.0f);
+
+    imu_tempco_record_t tc_rec;
+    imu_tempco_store(&s_tempco, &tc_rec);
+    err = nvs_save_imu_tempco(&tc_rec, sizeof(tc_rec));
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Saving IMU temperature model failed: %s", esp_err_to_name(err));
+    }
+}
+
+// Restarts stillness learning from the offsets currently in use
+static void imu_recal_restart(void)
+{
+    imu_recal_config_t cfg = {
+        .window_samples = IMU_RECAL_WINDOW_SAMPLES,
+        .accel_band_lsb = IMU_RECAL_ACCEL_BAND_LSB,
+        .gyro_band_lsb = IMU_RECAL_GYRO_BAND_LSB,
+        .accel_lsb_per_g = imu_lsb_per_g(),
+        .flat_tolerance_lsb = IMU_RECAL_FLAT_TOL_LSB,
+        .blend_shift = IMU_RECAL_BLEND_SHIFT,
+    };
+    imu_recal_init(&s_recal, &cfg, &s_offsets);
+}
+
+// Loads stored offsets so boot needs no blocking calibration
+static void imu_calib_load(void)
+{
+    imu_tempco_config_t tc_cfg = {
+        .accel_lsb_per_g = imu_lsb_per_g(),
+        .gyro_lsb_per_dps = (uint16_t)MPU_GYRO_LSB_PER_DPS,
+        .memory_points = IMU_TEMPCO_MEMORY_POINTS,
+        .min_points = IMU_TEMPCO_MIN_POINTS,
+        .min_span_centi = IMU_TEMPCO_MIN_SPAN_CENTI,
+        .min_step_centi = IMU_TEMPCO_MIN_STEP_CENTI,
+        .same_temp_every = IMU_TEMPCO_SAME_TEMP_EVERY,
+        .max_accel_slope_g = IMU_TEMPCO_MAX_ACCEL_G_PER_C,
+        .max_gyro_slope_dps = IMU_TEMPCO_MAX_GYRO_DPS_PER_C,
     };
+    imu_tempco_init(&s_tempco, &tc_cfg);
+
+    imu_tempco_record_t tc_rec;
+    if (nvs_load_imu_tempco(&tc_rec, sizeof(tc_rec)) == ESP_OK && imu_tempco_load(&s_tempco, &tc_rec)) {
+        ESP_LOGI(TAG, "IMU temperature model loaded");
+    }
+    imu_temp_poll(true);
+
+    imu_calib_record_t rec;
+    esp_err_t err = nvs_load_imu_calib(&rec, sizeof(rec));
+
+    if (err == ESP_OK && imu_calib_record_valid(&rec)) {
+        mpu6050_offsets_t offsets = imu_calib_record_offsets(&rec, imu_lsb_per_g());
+        imu_offsets_set(&offsets);
+        ESP_LOGI(TAG, "IMU calibration loaded: A[%d %d %d] G[%d %d %d] @ %.2f C",
+                 offsets.accel_x, offsets.accel_y, offsets.accel_z,
+                 offsets.gyro_x, offsets.gyro_y, offsets.gyro_z,
+                 rec.temp_centi / 100.0f);
+    } else {
+        ESP_LOGW(TAG, "No valid IMU calibration stored - learning in background");
+        imu_tempco_refresh();
+    }
+    if (s_tempco_axes > 0) {
+        ESP_LOGI(TAG, "Temperature compensation active on %d axes", s_tempco_axes);
+    }
+
+    imu_recal_restart();
+}
 
-    if (mpu6050_init(&mpu_config) != ESP_OK) {
-        ESP_LOGE(TAG, "MPU Init Failed! Task deleting.");
+// One raw sample per idle tick; offsets move only after a still window
+static void imu_recal_step(void)
+{
+    mpu6050_raw_sample_t raw;
+    uint16_t n = 0;
+    if (imu_backend_read_batch(&s_imu, &raw, 1, &n) != ESP_OK || n == 0) return;
+
+    uint16_t windows = s_recal.windows;
+    bool changed = imu_recal_update(&s_recal, &raw, !s_imu_cfg.gyro_standby);
+
+    // Every still window is a point of the offset-vs-temperature fit
+    bool fitted = s_recal.windows != windows && !s_imu_cfg.temp_disable &&
+                  imu_tempco_add(&s_tempco, &s_recal.observed, s_recal.observed_axes,
+                                 s_recal.temp_centi, 1.0f);
+
+    if (changed || fitted) {
+        imu_offsets_set(&s_recal.offsets);
+
+        int64_t since_save_us = esp_timer_get_time() - s_calib_saved_us;
+        if (s_calib_saved_us == 0 || since_save_us >= (int64_t)IMU_CALIB_SAVE_INTERVAL_S * 1000000) {
+            imu_calib_save(s_recal.temp_centi, s_recal.windows);
+        }
+    }
+}
+
+static imu_config_t sensing_config(mpu_sensing_id_t id, bool armed, bool stream)
+{
+    imu_config_t cfg = mpu_sensing_config(id, armed, stream);
+    if (armed && s_profile_override) {
+        cfg.motion_threshold = s_profile.threshold;
+        cfg.motion_duration = s_profile.duration;
+    }
+    return cfg;
+}
+
+// Switches the whole sensor setup in one backend reconfiguration.
+// Accel offsets follow a range change so calibration stays valid.
+static esp_err_t sensing_apply(mpu_sensing_id_t id, bool armed, bool stream)
+{
+    uint16_t old_lsb = imu_lsb_per_g();
+    s_imu_cfg = sensing_config(id, armed, stream);
+    s_active_sensing = id;
+
+    esp_err_t err = imu_apply();
+    if (err != ESP_OK) s_imu_cfg.stream_odr_hz = 0;
+
+    uint16_t lsb = imu_lsb_per_g();
+    if (lsb != old_lsb && old_lsb != 0) {
+        imu_tempco_set_accel_range(&s_tempco, lsb);
+        mpu6050_offsets_t offsets = s_offsets;
+        offsets.accel_x = (int16_t)((int32_t)offsets.accel_x * lsb / old_lsb);
+        offsets.accel_y = (int16_t)((int32_t)offsets.accel_y * lsb / old_lsb);
+        offsets.accel_z = (int16_t)((int32_t)offsets.accel_z * lsb / old_lsb);
+        imu_offsets_set(&offsets);
+        imu_recal_restart();
+    }
+    return err;
+}
+
+static bool sensing_on_demand(mpu_sensing_id_t id)
+{
+    return mpu_sensing_get(id)->stream_odr_hz == 0;
+}
+
+// Freezes the pre-trigger ring and stores it for later retrieval
+static void pretrigger_capture(pretrigger_reason_t reason)
+{
+    if (s_pre.count == 0) return;   // Keep the previous capture
+
+    size_t len = pretrigger_freeze(&s_pre, reason, (uint32_t)(esp_timer_get_time() / 1000),
+                                   imu_lsb_per_g(), &s_scale.offsets);
+
+    esp_err_t err = nvs_save_pretrigger(s_pre_storage, len);
+    uint32_t cycles = s_pre_pushed ? (uint32_t)(s_pre_cycles / s_pre_pushed) : 0;
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Saving pre-trigger capture failed: %s", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(TAG, "Pre-trigger capture saved: %u samples @ %u Hz, %u B, %lu cycles/sample",
+             s_pre.count, s_pre.rec->hdr.odr_hz, (unsigned)len, cycles);
+}
+
+static void raise_alarm(pretrigger_reason_t reason)
+{
+    trigger_system_alarm();
+    pretrigger_capture(reason);
+}
+
+// Starts the accel stream that feeds the detection pipeline
+static bool armed_stream_start(mpu_sensing_id_t id)
+{
+    pretrigger_reset(&s_pre);
+    motion_pipeline_restart(&s_pipe);
+    bool ok = sensing_apply(id, true, true) == ESP_OK && s_imu_cfg.stream_odr_hz != 0;
+    // After a parked stretch the last reading may be stale
+    imu_temp_poll(true);
+    return ok;
+}
+
+// Applies the selected armed profile. Returns true if its stream is running.
+static bool armed_enter(void)
+{
+    ESP_LOGI(TAG, "Armed sensing profile: %s", mpu_sensing_name(s_armed_sensing));
+    if (sensing_on_demand(s_armed_sensing)) {
+        sensing_apply(s_armed_sensing, true, false);
+        return false;
+    }
+    bool ok = armed_stream_start(s_armed_sensing);
+    if (!ok) {
+        ESP_LOGE(TAG, "Sample stream unavailable - motion filter and tilt disabled");
+    }
+    return ok;
+}
+
+// Stream for verifying a motion interrupt; low-power profiles borrow the
+// parked-sensitive settings until the verification ends
+static bool verify_stream_start(void)
+{
+    return armed_stream_start(mpu_sensing_verify(s_armed_sensing));
+}
+
+// Drains the stream into the pre-trigger ring and the detection pipeline
+static motion_event_t armed_stream_drain(void)
+{
+    uint16_t n = 0;
+    esp_err_t err = imu_backend_read_batch(&s_imu, s_batch_raw, MPU_RING_SAMPLES, &n);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_SIZE) {
+        ESP_LOGW(TAG, "Stream read failed: %s", esp_err_to_name(err));
+    }
+
+    if (n > 0) {
+        s_last_raw = s_batch_raw[n - 1];
+        s_last_raw_valid = true;
+
+        uint32_t start = esp_cpu_get_cycle_count();
+        pretrigger_push_batch(&s_pre, s_batch_raw, n);
+        s_pre_cycles += esp_cpu_get_cycle_count() - start;
+        s_pre_pushed += n;
+
+        mpu6050_convert_q16(&s_scale, s_batch_raw, s_batch_fixed, n);
+    }
+    return motion_pipeline_samples(&s_pipe, s_batch_fixed, n, esp_timer_get_time());
+}
+
+static void cmd_complete(esp_err_t result)
+{
+    s_cmd_result = result;
+    xSemaphoreGive(s_cmd_done);
+}
+
+static void snapshot_fill(bool stream_active, bool verifying)
+{
+    mpu_snapshot_t snap = {0};
+    imu_config_t armed_cfg = sensing_config(s_armed_sensing, true, false);
+    snap.timestamp_us = esp_timer_get_time();
+    snap.profile.threshold = armed_cfg.motion_threshold;
+    snap.profile.duration = armed_cfg.motion_duration;
+    snap.sensing = s_active_sensing;
+    snap.armed_sensing = s_armed_sensing;
+    snap.streaming = stream_active;
+    snap.verifying = verifying;
+
+    // While streaming the FIFO owns the samples - reuse the latest drained one
+    if (stream_active && s_last_raw_valid) {
+        snap.raw = s_last_raw;
+        snap.tilt_deg = tilt_detector_get_angle_deg(&s_pipe.tilt);
+    } else {
+        uint16_t n = 0;
+        if (imu_backend_read_batch(&s_imu, &snap.raw, 1, &n) != ESP_OK || n == 0) {
+            ESP_LOGW(TAG, "Snapshot read failed");
+        }
+    }
+
+    mpu6050_convert_float(&s_scale, &snap.raw, &snap.data, 1);
+
+    s_snapshot = snap;
+    cmd_complete(ESP_OK);
+}
+
+// Applies queued commands. Called on every wake-up of the monitor task,
+// so a posted command takes effect within one drain/check period.
+static void process_commands(bool motion_mode_active, bool stream_active, bool verifying)
+{
+    mpu_cmd_t cmd;
+    while (xQueueReceive(s_cmd_queue, &cmd, 0) == pdTRUE) {
+        switch (cmd.type) {
+        case MPU_CMD_SET_THRESHOLD:
+        case MPU_CMD_SET_PROFILE:
+            if (!s_profile_override) {
+                s_profile.threshold = mpu_sensing_get(s_armed_sensing)->motion_threshold;
+                s_profile.duration = mpu_sensing_get(s_armed_sensing)->motion_duration;
+                s_profile_override = true;
+            }
+            s_profile.threshold = cmd.type == MPU_CMD_SET_THRESHOLD ? cmd.threshold : cmd.profile.threshold;
+            if (cmd.type == MPU_CMD_SET_PROFILE) {
+                s_profile.duration = cmd.profile.duration;
+            }
+            ESP_LOGI(TAG, "Motion threshold %u, duration %u ms", s_profile.threshold, s_profile.duration);
+            // Otherwise applied on the next arming
+            if (motion_mode_active) {
+                s_imu_cfg.motion_threshold = s_profile.threshold;
+                s_imu_cfg.motion_duration = s_profile.duration;
+                imu_apply();
+            }
+            break;
+
+        case MPU_CMD_RECALIBRATE:
+            // Needs a resting sensor outside motion mode
+            s_calib_pending = true;
+            ESP_LOGI(TAG, "Recalibration requested%s", motion_mode_active ? " (deferred until disarmed)" : "");
+            break;
+
+        case MPU_CMD_SNAPSHOT:
+            snapshot_fill(stream_active, verifying);
+            break;
+
+        case MPU_CMD_PREPARE_SLEEP:
+            // Handled by the task loop, which owns the stream state
+            s_park_pending = true;
+            break;
+
+        case MPU_CMD_RESUME:
+            s_resume_pending = true;
+            break;
+
+        case MPU_CMD_SELECT_SENSING:
+            if (cmd.sensing >= MPU_SENSING_COUNT) break;
+            s_armed_sensing = cmd.sensing;
+            s_profile_override = false;
+            // Applied by the armed loop once no motion is being verified
+            s_sensing_pending = motion_mode_active;
+            ESP_LOGI(TAG, "Armed sensing profile -> %s", mpu_sensing_name(s_armed_sensing));
+            break;
+
+        default:
+            ESP_LOGW(TAG, "Unknown command %d", cmd.type);
+            break;
+        }
+    }
+}
+
+void mpu_monitor_task(void *pvParameter)
+{
+    s_mpu_task_handle = xTaskGetCurrentTaskHandle();
+
+    if (mpu_monitor_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Command queue allocation failed! Task deleting.");
         vTaskDelete(NULL);
     }
-    
+
+    // Real sensor unless a simulated backend was installed
+    if (!s_imu_set) {
+        imu_mpu6050_config_t hw_config = {
+            .bus = {
+                .scl_io = MPU_SCL_IO,
+                .sda_io = MPU_SDA_IO,
+                .device_addr = MPU_DEVICE_ADDR,
+                .i2c_port = MPU_I2C_PORT
+            },
+            .int_pin = MPU_INT_PIN,
+        };
+        s_imu = imu_backend_mpu6050(&hw_config);
+    }
+
+    if (imu_backend_init(&s_imu, imu_int_cb, NULL) != ESP_OK) {
+        ESP_LOGE(TAG, "IMU (%s) Init Failed! Task deleting.", s_imu.ops->name);
+        vTaskDelete(NULL);
+    }
+
+    if (s_armed_sensing >= MPU_SENSING_COUNT) {
+        s_armed_sensing = MPU_ARMED_SENSING_DEFAULT;
+    }
+
+    // Offsets are loaded for the range of the first profile
+    mpu6050_offsets_t no_offsets = {0};
+    imu_offsets_set(&no_offsets);
+    if (sensing_apply(MPU_SENSING_TRANSPORT, false, false) != ESP_OK) {
+        ESP_LOGE(TAG, "IMU setup failed! Task deleting.");
+        vTaskDelete(NULL);
+    }
+    ESP_LOGI(TAG, "IMU backend: %s, armed profile: %s", s_imu.ops->name, mpu_sensing_name(s_armed_sensing));
+
     // Initial calibration
-    mpu6050_set_accel_range(ACCEL_RANGE_4G);
+    imu_calib_load();
+
+    pretrigger_init(&s_pre, s_pre_storage, PRETRIGGER_SAMPLES, MOTION_ODR_HZ, PRETRIGGER_DECIMATION);
+    ESP_LOGI(TAG, "Pre-trigger buffer: %u samples (%.1f s), %u B",
+             PRETRIGGER_SAMPLES, pretrigger_span_s(&s_pre), (unsigned)sizeof(s_pre_storage));
     
+    // A motion interrupt woke us from deep sleep. Arming clears its latch,
+    // so verification has to start without waiting for another edge.
+    bool motion_wake = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_EXT1 &&
+                       (esp_sleep_get_ext1_wakeup_status() & (1ULL << MPU_INT_PIN));
+
+    motion_pipeline_init(&s_pipe, &s_pipe_config);
+    if (s_tilt_armed) s_pipe.tilt = s_tilt_saved;
+
     bool motion_mode_active = false;
+    bool stream_active = false;
+    bool parked = false;        // Stream stopped for deep sleep
 
     while (1) {
         
@@ -35,26 +724,184 @@ void mpu_monitor_task(void *pvParameter)
             
             if (!motion_mode_active) {
                 ESP_LOGI(TAG, "Configuring MPU for Motion Detection...");
-                mpu6050_enable_motion_detection(20, 1);
                 motion_mode_active = true;
-                mpu6050_get_int_status(); 
+                s_sensing_pending = false;
+                s_last_raw_valid = false;
+                if (!s_tilt_armed) {
+                    // Disarmed -> armed: new orientation reference
+                    motion_pipeline_init(&s_pipe, &s_pipe_config);
+                    s_tilt_armed = true;
+                }
+                stream_active = armed_enter();
+                // Low-power profiles have no stream; run one until the
+                // reference is captured
+                s_tilt_capture = !s_pipe.tilt.has_ref;
+                if (s_tilt_capture && !stream_active) stream_active = verify_stream_start();
+                uint8_t status;
+                imu_backend_read_int_status(&s_imu, &status);
+
+                // Drop edges latched before arming
+                xTaskNotifyWait(0, UINT32_MAX, NULL, 0);
+
+                if (motion_wake) {
+                    // Parked with the FIFO off: there is nothing from before
+                    // the wake to drain, the ring starts with the stream
+                    if (!stream_active) stream_active = verify_stream_start();
+                    if (stream_active) {
+                        ESP_LOGW(TAG, "Woken by motion, verifying...");
+                        motion_pipeline_interrupt(&s_pipe, esp_timer_get_time());
+                        pretrigger_mark(&s_pre, PRETRIGGER_FLAG_WOKE_FROM_SLEEP);
+                    }
+                }
+                motion_wake = false;
+            }
+
+            // Sleep until the INT pin fires; the timeout re-checks arming state and
+            // drains the sample stream (faster while a motion is being verified)
+            uint32_t notified = 0;
+            TickType_t wait_ms = s_pipe.verifying ? MOTION_DRAIN_MS : MPU_STATE_CHECK_MS;
+            xTaskNotifyWait(0, UINT32_MAX, &notified, pdMS_TO_TICKS(wait_ms));
+            process_commands(motion_mode_active, stream_active, s_pipe.verifying);
+            imu_temp_poll(false);
+
+            if (s_park_pending) {
+                s_park_pending = false;
+                if (s_pipe.verifying || s_tilt_capture) {
+                    cmd_complete(ESP_ERR_INVALID_STATE);
+                } else {
+                    // Nobody drains the stream in deep sleep: cycled accel only,
+                    // INT latch cleared so only a new motion raises the wake pin
+                    sensing_apply(MPU_SENSING_PARKED_LOW_POWER, true, false);
+                    stream_active = false;
+                    parked = true;
+                    s_tilt_saved = s_pipe.tilt;
+                    uint8_t status;
+                    imu_backend_read_int_status(&s_imu, &status);
+                    cmd_complete(ESP_OK);
+                }
+            }
+            if ((s_resume_pending || (notified & MPU_NOTIFY_INT_BIT)) && parked) {
+                parked = false;
+                stream_active = armed_enter();
             }
-            uint8_t status = mpu6050_get_int_status();
-            if (status & 0x40) {
-                ESP_LOGE(TAG, "Motion Detected! (Status: 0x%02X)", status);
-                trigger_system_alarm();
+            s_resume_pending = false;
+
+            if (s_sensing_pending && !s_pipe.verifying && !parked) {
+                s_sensing_pending = false;
+                stream_active = armed_enter();
+                if (s_tilt_capture && !stream_active) stream_active = verify_stream_start();
+            }
+
+            if (notified & MPU_NOTIFY_INT_BIT) {
+                uint8_t status = 0;
+                imu_backend_read_int_status(&s_imu, &status);
+                if (status & IMU_INT_STATUS_MOTION) {
+                    if (!stream_active) stream_active = verify_stream_start();
+                    if (!stream_active) {
+                        // Without samples we cannot filter - fail safe
+                        ESP_LOGE(TAG, "Motion Detected! (Status: 0x%02X, unverified)", status);
+                        raise_alarm(PRETRIGGER_REASON_UNVERIFIED);
+                        continue;
+                    }
+                    if (motion_pipeline_interrupt(&s_pipe, s_last_int_time_us) == MOTION_EVENT_VERIFYING) {
+                        ESP_LOGW(TAG, "Motion interrupt (Status: 0x%02X), verifying...", status);
+                        pretrigger_mark(&s_pre, 0);
+                    }
+                }
             }
 
-            vTaskDelay(pdMS_TO_TICKS(100));
+            s_idle = !s_pipe.verifying && !s_tilt_capture;
+            if (!stream_active) continue;
+
+            const motion_features_t *f = &s_pipe.last;
+            switch (armed_stream_drain()) {
+            case MOTION_EVENT_ALARM_TILT:
+                ESP_LOGE(TAG, "Tilt Detected! (%.1f deg from armed orientation)",
+                         tilt_detector_get_angle_deg(&s_pipe.tilt));
+                raise_alarm(PRETRIGGER_REASON_TILT);
+                continue;
+
+            case MOTION_EVENT_ALARM_MOTION:
+                ESP_LOGE(TAG, "Motion Detected! rms=%u mg jerk=%lu mg/s var=%lu sustained=%lu ms (INT->alarm %lld us)",
+                         f->rms_mg, f->jerk_mg_s, f->variance_mg2, f->sustained_ms,
+                         esp_timer_get_time() - s_pipe.verify_start_us);
+                raise_alarm(PRETRIGGER_REASON_MOTION);
+                break;
+
+            case MOTION_EVENT_REJECTED:
+                ESP_LOGI(TAG, "Motion rejected: rms=%u mg jerk=%lu mg/s var=%lu sustained=%lu ms",
+                         f->rms_mg, f->jerk_mg_s, f->variance_mg2, f->sustained_ms);
+                s_activity_count++;
+                pretrigger_unmark(&s_pre);
+                // Low-power profiles drop the verification stream again
+                if (sensing_on_demand(s_armed_sensing) && !s_tilt_capture) {
+                    stream_active = armed_enter();
+                }
+                break;
+
+            default:
+                if (s_tilt_capture && s_pipe.tilt.has_ref && !s_pipe.verifying) {
+                    s_tilt_capture = false;
+                    ESP_LOGI(TAG, "Armed orientation captured");
+                    if (sensing_on_demand(s_armed_sensing)) stream_active = armed_enter();
+                }
+                break;
+            }
+            s_idle = !s_pipe.verifying && !s_tilt_capture;
         } 
         // Is not armed or alarm already runnning
         else {
-            if (motion_mode_active) {
-                ESP_LOGI(TAG, "Disabling Motion Detection (Normal Mode)");
-                mpu6050_set_normal_mode();
+            s_pipe.verifying = false;
+            s_idle = false;
+            s_tilt_armed = false;       // Re-captured at the next arming
+            s_tilt_capture = false;
+            parked = false;
+            stream_active = false;
+            s_sensing_pending = false;
+
+            mpu_sensing_id_t wanted = is_system_in_alarm() ? MPU_SENSING_ALARM_TRACKING : MPU_SENSING_TRANSPORT;
+            if (motion_mode_active || s_active_sensing != wanted) {
+                ESP_LOGI(TAG, "Disabling Motion Detection (%s)", mpu_sensing_name(wanted));
+                sensing_apply(wanted, false, false);
                 motion_mode_active = false;
             }
-            vTaskDelay(pdMS_TO_TICKS(500));
+            if (!is_system_in_alarm()) {
+                if (s_calib_pending) {
+                    s_calib_pending = false;
+                    // Gyro offsets need the gyro out of standby
+                    s_imu_cfg.gyro_standby = false;
+                    if (imu_apply() == ESP_OK) {
+                        vTaskDelay(pdMS_TO_TICKS(MPU_GYRO_STARTUP_MS));
+                        if (imu_calibrate(MPU_CALIB_ITERATIONS) == ESP_OK) {
+                            imu_temp_poll(true);
+                            if (s_temp_valid) {
+                                imu_tempco_add(&s_tempco, &s_offsets, 0x3F, s_temp_centi,
+                                               IMU_TEMPCO_CALIB_WEIGHT);
+                                imu_offsets_set(&s_offsets);
+                            }
+                            // Measured just now at s_temp_centi, no still windows yet
+                            imu_calib_save(s_temp_valid ? s_temp_centi : 0, 0);
+                            imu_recal_restart();
+                        }
+                    }
+                    sensing_apply(wanted, false, false);
+                }
+            }
+
+            // Commands wake the task early; only timed ticks feed the
+            // stillness windows so their spacing stays uniform
+            bool woken = xTaskNotifyWait(0, UINT32_MAX, NULL, pdMS_TO_TICKS(MPU_STATE_CHECK_MS)) == pdTRUE;
+            process_commands(motion_mode_active, stream_active, s_pipe.verifying);
+            if (s_park_pending) {
+                // Only the armed path sleeps
+                s_park_pending = false;
+                cmd_complete(ESP_ERR_INVALID_STATE);
+            }
+            s_resume_pending = false;
+            imu_temp_poll(false);
+            if (!woken && !is_system_in_alarm()) {
+                imu_recal_step();
+            }
         }
     }
-}
\ No newline at end of file
+}
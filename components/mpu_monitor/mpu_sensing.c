@@ -0,0 +1,70 @@
+#include "mpu_sensing.h"
+#include <string.h>
+#include "config.h"
+
+static const mpu_sensing_t s_sensing[MPU_SENSING_COUNT] = {
+    [MPU_SENSING_PARKED_LOW_POWER] = {
+        .name = "parked-low-power",
+        .accel_range_g = 4, .dlpf_hz = 184, .lp_wake_hz = 5,
+        .gyro_standby = true, .temp_disable = true,
+        .motion_threshold = MPU_MOTION_THRESHOLD, .motion_duration = MPU_MOTION_DURATION,
+        .stream_odr_hz = 0,
+    },
+    [MPU_SENSING_PARKED_SENSITIVE] = {
+        .name = "parked-sensitive",
+        .accel_range_g = 4, .dlpf_hz = 184, .lp_wake_hz = 0,
+        .gyro_standby = true, .temp_disable = false,     // Offset temperature compensation
+        .motion_threshold = MPU_MOTION_THRESHOLD, .motion_duration = MPU_MOTION_DURATION,
+        .stream_odr_hz = MOTION_ODR_HZ,
+    },
+    [MPU_SENSING_TRANSPORT] = {
+        .name = "transport",
+        .accel_range_g = 8, .dlpf_hz = 21, .lp_wake_hz = 0,
+        .gyro_standby = true, .temp_disable = false,     // Temperature tags recalibration windows
+        .motion_threshold = 60, .motion_duration = 5,
+        .stream_odr_hz = MOTION_ODR_HZ,
+    },
+    [MPU_SENSING_ALARM_TRACKING] = {
+        .name = "alarm-tracking",
+        .accel_range_g = 8, .dlpf_hz = 44, .lp_wake_hz = 0,
+        .gyro_standby = false, .temp_disable = false,
+        .motion_threshold = MPU_MOTION_THRESHOLD, .motion_duration = MPU_MOTION_DURATION,
+        .stream_odr_hz = 0,
+    },
+};
+
+const mpu_sensing_t *mpu_sensing_get(mpu_sensing_id_t sensing) {
+    return sensing < MPU_SENSING_COUNT ? &s_sensing[sensing] : NULL;
+}
+
+const char *mpu_sensing_name(mpu_sensing_id_t sensing) {
+    return sensing < MPU_SENSING_COUNT ? s_sensing[sensing].name : "unknown";
+}
+
+mpu_sensing_id_t mpu_sensing_from_name(const char *name) {
+    for (int i = 0; i < MPU_SENSING_COUNT; i++) {
+        if (strcmp(name, s_sensing[i].name) == 0) return (mpu_sensing_id_t)i;
+    }
+    return MPU_SENSING_COUNT;
+}
+
+imu_config_t mpu_sensing_config(mpu_sensing_id_t sensing, bool armed, bool stream) {
+    const mpu_sensing_t *p = &s_sensing[sensing < MPU_SENSING_COUNT ? sensing : MPU_SENSING_TRANSPORT];
+    imu_config_t cfg = {
+        .mode = armed ? IMU_MODE_MOTION : IMU_MODE_NORMAL,
+        .accel_range_g = p->accel_range_g,
+        .motion_threshold = p->motion_threshold,
+        .motion_duration = p->motion_duration,
+        .stream_odr_hz = stream ? p->stream_odr_hz : 0,
+        .dlpf_hz = p->dlpf_hz,
+        .lp_wake_hz = p->lp_wake_hz,
+        .gyro_standby = p->gyro_standby,
+        .temp_disable = p->temp_disable,
+    };
+    return cfg;
+}
+
+mpu_sensing_id_t mpu_sensing_verify(mpu_sensing_id_t sensing) {
+    if (sensing < MPU_SENSING_COUNT && s_sensing[sensing].stream_odr_hz != 0) return sensing;
+    return MPU_SENSING_PARKED_SENSITIVE;
+}
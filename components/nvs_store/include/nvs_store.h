@@ -11,6 +11,10 @@
 #define KEY_PASS    "wifi_pass"
 #define KEY_FORCE_CONFIG "force_conf"
 #define KEY_DEVICE_ID    "device_id"
+#define KEY_IMU_CALIB    "imu_calib"
+#define KEY_PRETRIGGER   "pretrigger"
+#define KEY_IMU_TEMPCO   "imu_tempco"
+#define KEY_GPS_AID      "gps_aid"
 
 // General NVS Helper
 esp_err_t nvs_store_init(void);
@@ -35,4 +39,21 @@ bool nvs_get_force_config(void);
 void nvs_clear_force_config(void);
 void nvs_set_force_config(void);
 
+// IMU Calibration (opaque blob, owner defines the layout)
+esp_err_t nvs_save_imu_calib(const void* blob, size_t len);
+esp_err_t nvs_load_imu_calib(void* blob, size_t len);
+
+// IMU offset-vs-temperature fit (opaque blob)
+esp_err_t nvs_save_imu_tempco(const void* blob, size_t len);
+esp_err_t nvs_load_imu_tempco(void* blob, size_t len);
+
+// Pre-trigger IMU capture of the last alarm (variable-length blob)
+esp_err_t nvs_save_pretrigger(const void* blob, size_t len);
+// len: buffer size in, stored size out
+esp_err_t nvs_load_pretrigger(void* blob, size_t* len);
+
+// Last GPS fix for receiver aiding on wake (opaque blob)
+esp_err_t nvs_save_gps_aid(const void* blob, size_t len);
+esp_err_t nvs_load_gps_aid(void* blob, size_t len);
+
 #endif // NVS_STORE_H
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "nvs_store.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "esp_attr.h"
 #include "esp_log.h"
 #include <string.h>
 
@@ -37,6 +38,63 @@ static esp_err_t load_str(const char* key, char* buffer, size_t max_len) {
     return err;
 }
 
+static esp_err_t save_blob(const char* key, const void* value, size_t len) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) return err;
+
+    err = nvs_set_blob(handle, key, value, len);
+    if (err == ESP_OK) err = nvs_commit(handle);
+    nvs_close(handle);
+    return err;
+}
+
+// Fails with ESP_ERR_INVALID_SIZE if the stored blob has a different length
+static esp_err_t load_blob(const char* key, void* buffer, size_t len) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) return err;
+
+    size_t stored_len = 0;
+    err = nvs_get_blob(handle, key, NULL, &stored_len);
+    if (err == ESP_OK && stored_len != len) err = ESP_ERR_INVALID_SIZE;
+    if (err == ESP_OK) err = nvs_get_blob(handle, key, buffer, &stored_len);
+    nvs_close(handle);
+    return err;
+}
+
+// --- Identity cache ---
+// User and device ID are read for every LoRa frame and report. Kept in RTC
+// memory so that deep-sleep wakes do not go back to flash.
+
+#define ID_CACHE_MAGIC  (0x49444331)   // "IDC1"
+#define ID_CACHE_LEN    (64)
+
+typedef struct {
+    uint32_t magic;
+    bool has_user;
+    bool has_device;
+    char user_id[ID_CACHE_LEN];
+    char device_id[ID_CACHE_LEN];
+} id_cache_t;
+
+static RTC_DATA_ATTR id_cache_t s_ids;
+
+static esp_err_t load_id(const char *key, char *cached, bool *has, char *buffer, size_t max_len) {
+    if (s_ids.magic != ID_CACHE_MAGIC) {
+        memset(&s_ids, 0, sizeof(s_ids));
+        s_ids.magic = ID_CACHE_MAGIC;
+    }
+    if (!*has) {
+        esp_err_t err = load_str(key, cached, ID_CACHE_LEN);
+        if (err != ESP_OK) return load_str(key, buffer, max_len);
+        *has = true;
+    }
+    if (strlen(cached) >= max_len) return ESP_ERR_NVS_INVALID_LENGTH;
+    strcpy(buffer, cached);
+    return ESP_OK;
+}
+
 // --- User ID ---
 
 bool nvs_has_user_id(void) {
@@ -49,11 +107,12 @@ bool nvs_has_user_id(void) {
 }
 
 esp_err_t nvs_save_user_id(const char* user_id) {
+    s_ids.has_user = false;
     return save_str(KEY_USER_ID, user_id);
 }
 
 esp_err_t nvs_load_user_id(char* buffer, size_t max_len) {
-    return load_str(KEY_USER_ID, buffer, max_len);
+    return load_id(KEY_USER_ID, s_ids.user_id, &s_ids.has_user, buffer, max_len);
 }
 
 // --- Device ID ---
@@ -68,11 +127,12 @@ bool nvs_has_device_id(void) {
 }
 
 esp_err_t nvs_save_device_id(const char* device_id) {
+    s_ids.has_device = false;
     return save_str(KEY_DEVICE_ID, device_id);
 }
 
 esp_err_t nvs_load_device_id(char* buffer, size_t max_len) {
-    return load_str(KEY_DEVICE_ID, buffer, max_len);
+    return load_id(KEY_DEVICE_ID, s_ids.device_id, &s_ids.has_device, buffer, max_len);
 }
 
 // --- WiFi Credentials ---
@@ -138,4 +198,49 @@ void nvs_set_force_config(void) {
         nvs_commit(handle);
         nvs_close(handle);
     }
-}
\ No newline at end of file
+}
+
+// --- IMU Calibration ---
+
+esp_err_t nvs_save_imu_calib(const void* blob, size_t len) {
+    return save_blob(KEY_IMU_CALIB, blob, len);
+}
+
+esp_err_t nvs_load_imu_calib(void* blob, size_t len) {
+    return load_blob(KEY_IMU_CALIB, blob, len);
+}
+
+esp_err_t nvs_save_imu_tempco(const void* blob, size_t len) {
+    return save_blob(KEY_IMU_TEMPCO, blob, len);
+}
+
+esp_err_t nvs_load_imu_tempco(void* blob, size_t len) {
+    return load_blob(KEY_IMU_TEMPCO, blob, len);
+}
+
+// --- Pre-trigger Capture ---
+
+esp_err_t nvs_save_pretrigger(const void* blob, size_t len) {
+    return save_blob(KEY_PRETRIGGER, blob, len);
+}
+
+esp_err_t nvs_load_pretrigger(void* blob, size_t* len) {
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) return err;
+
+    // Fails with ESP_ERR_NVS_INVALID_LENGTH if the buffer is too small
+    err = nvs_get_blob(handle, KEY_PRETRIGGER, blob, len);
+    nvs_close(handle);
+    return err;
+}
+
+// --- GPS Aiding ---
+
+esp_err_t nvs_save_gps_aid(const void* blob, size_t len) {
+    return save_blob(KEY_GPS_AID, blob, len);
+}
+
+esp_err_t nvs_load_gps_aid(void* blob, size_t len) {
+    return load_blob(KEY_GPS_AID, blob, len);
+}
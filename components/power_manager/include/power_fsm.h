@@ -0,0 +1,85 @@
+#ifndef POWER_FSM_H
+#define POWER_FSM_H
+
+/*
+ * Decides when the armed device may enter deep sleep. Pure logic with
+ * explicit time input and no ESP-IDF dependencies, so it can be built
+ * and exercised on a host.
+ *
+ * Sleep is allowed only while armed, with no alarm and nothing in flight,
+ * and after the inputs have been quiet for settle_ms (listen_ms after a
+ * wake that may be followed by a downlink).
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    POWER_WAKE_COLD,         // Power-on / reset, not a deep-sleep wake
+    POWER_WAKE_MOTION,       // MPU INT
+    POWER_WAKE_BUTTON,       // Boot button
+    POWER_WAKE_LORA,         // E32 AUX (downlink)
+    POWER_WAKE_TIMER,        // Periodic listen window
+} power_wake_t;
+
+typedef enum {
+    POWER_STATE_AWAKE,       // Disarmed, in alarm or restarting - never sleeps
+    POWER_STATE_SETTLING,    // Armed, waiting for a quiet period
+    POWER_STATE_LISTENING,   // Armed, post-wake window for a LoRa downlink
+    POWER_STATE_SLEEP,       // Sleep may start now
+} power_state_t;
+
+// Reasons that currently keep the device awake (bit mask)
+#define POWER_BLOCK_DISARMED  (1U << 0)
+#define POWER_BLOCK_ALARM     (1U << 1)
+#define POWER_BLOCK_RESTART   (1U << 2)   // Reboot (config mode, reset) pending
+#define POWER_BLOCK_IMU       (1U << 3)   // Motion being verified / stream not parked
+#define POWER_BLOCK_LORA      (1U << 4)   // Module busy or status message queued
+#define POWER_BLOCK_BUTTON    (1U << 5)
+#define POWER_BLOCK_QUIET     (1U << 6)   // Quiet period not elapsed yet
+#define POWER_BLOCK_GPS       (1U << 7)   // GPS standby session running
+
+typedef struct {
+    bool armed;
+    bool in_alarm;
+    bool restarting;
+    bool imu_busy;
+    bool lora_busy;
+    bool button_down;
+    bool gps_busy;
+} power_inputs_t;
+
+typedef struct {
+    uint32_t settle_ms;      // Quiet time required after any activity
+    uint32_t listen_ms;      // Quiet time required after a LoRa/timer wake
+} power_fsm_config_t;
+
+typedef struct {
+    power_fsm_config_t cfg;
+    power_state_t state;
+    uint32_t quiet_since_ms;
+    uint32_t required_ms;    // settle_ms or listen_ms, depending on the last wake
+    uint32_t blockers;       // POWER_BLOCK_* from the last step
+    bool was_armed;
+} power_fsm_t;
+
+/**
+ * @brief Reset the machine after a boot or wake.
+ * @param wake Wake cause; LoRa and timer wakes start in LISTENING.
+ */
+void power_fsm_init(power_fsm_t *fsm, const power_fsm_config_t *cfg, power_wake_t wake, uint32_t now_ms);
+
+/**
+ * @brief Evaluate the inputs. Any activity restarts the quiet period.
+ * @return true if deep sleep may start now.
+ */
+bool power_fsm_step(power_fsm_t *fsm, const power_inputs_t *in, uint32_t now_ms);
+
+/**
+ * @brief Report activity not visible in the inputs (e.g. an aborted sleep).
+ */
+void power_fsm_note_activity(power_fsm_t *fsm, uint32_t now_ms);
+
+const char *power_fsm_state_name(power_state_t state);
+
+#endif // POWER_FSM_H
@@ -0,0 +1,29 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "power_fsm.h"
+
+// Kept in RTC slow memory across deep sleep
+typedef struct {
+    uint32_t boots;              // All boots, including wakes
+    uint32_t sleeps;
+    uint32_t motion_wakes;
+    uint32_t button_wakes;
+    uint32_t lora_wakes;
+    uint32_t timer_wakes;
+    uint64_t asleep_ms;          // Total time spent in deep sleep
+} power_counters_t;
+
+// Call first in app_main (after nvs_store_init): reads the wake cause,
+// releases pin holds and restores the RTC state.
+power_wake_t power_manager_init(void);
+
+// True if we woke from an armed deep sleep and the armed state must be restored
+bool power_manager_resume_armed(void);
+
+// Puts the device into deep sleep when the power state machine allows it
+void power_manager_task(void *pvParameter);
+
+#endif
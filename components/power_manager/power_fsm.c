@@ -0,0 +1,80 @@
+#include "power_fsm.h"
+#include <string.h>
+
+void power_fsm_init(power_fsm_t *fsm, const power_fsm_config_t *cfg, power_wake_t wake, uint32_t now_ms) {
+    memset(fsm, 0, sizeof(*fsm));
+    fsm->cfg = *cfg;
+    fsm->quiet_since_ms = now_ms;
+    // Only armed devices sleep, so any deep-sleep wake resumes armed
+    fsm->was_armed = (wake != POWER_WAKE_COLD);
+
+    // A downlink may follow (the sender retries while we boot)
+    bool listen = (wake == POWER_WAKE_LORA || wake == POWER_WAKE_TIMER);
+    fsm->required_ms = listen ? cfg->listen_ms : cfg->settle_ms;
+    fsm->state = listen ? POWER_STATE_LISTENING : POWER_STATE_AWAKE;
+}
+
+void power_fsm_note_activity(power_fsm_t *fsm, uint32_t now_ms) {
+    fsm->quiet_since_ms = now_ms;
+    fsm->required_ms = fsm->cfg.settle_ms;
+    if (fsm->state == POWER_STATE_SLEEP || fsm->state == POWER_STATE_LISTENING) {
+        fsm->state = POWER_STATE_SETTLING;
+    }
+}
+
+bool power_fsm_step(power_fsm_t *fsm, const power_inputs_t *in, uint32_t now_ms) {
+    uint32_t blockers = 0;
+
+    if (!in->armed)      blockers |= POWER_BLOCK_DISARMED;
+    if (in->in_alarm)    blockers |= POWER_BLOCK_ALARM;
+    if (in->restarting)  blockers |= POWER_BLOCK_RESTART;
+    if (in->imu_busy)    blockers |= POWER_BLOCK_IMU;
+    if (in->lora_busy)   blockers |= POWER_BLOCK_LORA;
+    if (in->button_down) blockers |= POWER_BLOCK_BUTTON;
+    if (in->gps_busy)    blockers |= POWER_BLOCK_GPS;
+
+    // Arming itself is activity: the status message and the user walking away
+    if (in->armed != fsm->was_armed) {
+        fsm->was_armed = in->armed;
+        power_fsm_note_activity(fsm, now_ms);
+    }
+
+    if (blockers & (POWER_BLOCK_DISARMED | POWER_BLOCK_ALARM | POWER_BLOCK_RESTART)) {
+        fsm->state = POWER_STATE_AWAKE;
+        fsm->quiet_since_ms = now_ms;
+        fsm->blockers = blockers;
+        return false;
+    }
+
+    if (blockers) {
+        power_fsm_note_activity(fsm, now_ms);
+    }
+    else if (fsm->state == POWER_STATE_AWAKE) {
+        // Just armed (or alarm cleared) - start the quiet period from here
+        fsm->state = POWER_STATE_SETTLING;
+        fsm->quiet_since_ms = now_ms;
+    }
+
+    if (now_ms - fsm->quiet_since_ms < fsm->required_ms) {
+        blockers |= POWER_BLOCK_QUIET;
+    }
+
+    fsm->blockers = blockers;
+    if (blockers) {
+        if (fsm->state == POWER_STATE_SLEEP) fsm->state = POWER_STATE_SETTLING;
+        return false;
+    }
+
+    fsm->state = POWER_STATE_SLEEP;
+    return true;
+}
+
+const char *power_fsm_state_name(power_state_t state) {
+    switch (state) {
+    case POWER_STATE_AWAKE:     return "AWAKE";
+    case POWER_STATE_SETTLING:  return "SETTLING";
+    case POWER_STATE_LISTENING: return "LISTENING";
+    case POWER_STATE_SLEEP:     return "SLEEP";
+    default:                    return "?";
+    }
+}
@@ -0,0 +1,207 @@
+#include <string.h>
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "driver/rtc_io.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+
+#include "power_manager.h"
+#include "arming_manager.h"
+#include "button_monitor.h"
+#include "mpu_monitor.h"
+#include "lora.h"
+#include "gps_standby.h"
+#include "config.h"
+
+static const char *TAG = "POWER";
+
+#define POWER_RTC_MAGIC (0x50575231)   // "PWR1"
+
+typedef struct {
+    uint32_t magic;
+    bool armed;                  // Armed state at sleep entry
+    int64_t sleep_enter_us;      // RTC wall clock at sleep entry
+    power_counters_t counters;
+} power_rtc_state_t;
+
+static RTC_DATA_ATTR power_rtc_state_t s_rtc;
+
+static power_wake_t s_wake = POWER_WAKE_COLD;
+static bool s_resume_armed = false;
+static power_fsm_t s_fsm;
+
+// Survives deep sleep (RTC timer), unlike esp_timer
+static int64_t rtc_time_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static power_wake_t read_wake_source(void)
+{
+    switch (esp_sleep_get_wakeup_cause()) {
+    case ESP_SLEEP_WAKEUP_EXT0:
+        return POWER_WAKE_BUTTON;
+    case ESP_SLEEP_WAKEUP_EXT1:
+        // Motion wins if both pins were high
+        if (esp_sleep_get_ext1_wakeup_status() & (1ULL << MPU_INT_PIN)) return POWER_WAKE_MOTION;
+        return POWER_WAKE_LORA;
+    case ESP_SLEEP_WAKEUP_TIMER:
+        return POWER_WAKE_TIMER;
+    default:
+        return POWER_WAKE_COLD;
+    }
+}
+
+power_wake_t power_manager_init(void)
+{
+    s_wake = read_wake_source();
+
+    // The E32 mode pins and the UART TX lines were held through sleep;
+    // lora_init and gps_init drive them again
+    gpio_hold_dis(LORA_M0_PIN);
+    gpio_hold_dis(LORA_M1_PIN);
+    gpio_hold_dis(LORA_TX_PIN);
+    gpio_hold_dis(GPS_TXD_PIN);
+    gpio_deep_sleep_hold_dis();
+
+    if (s_wake == POWER_WAKE_COLD || s_rtc.magic != POWER_RTC_MAGIC) {
+        if (s_wake != POWER_WAKE_COLD) {
+            ESP_LOGW(TAG, "RTC state lost, treating wake as cold boot");
+            s_wake = POWER_WAKE_COLD;
+        }
+        memset(&s_rtc, 0, sizeof(s_rtc));
+        s_rtc.magic = POWER_RTC_MAGIC;
+    }
+    else {
+        int64_t slept_us = rtc_time_us() - s_rtc.sleep_enter_us;
+        if (slept_us > 0) s_rtc.counters.asleep_ms += (uint64_t)(slept_us / 1000);
+
+        switch (s_wake) {
+        case POWER_WAKE_MOTION: s_rtc.counters.motion_wakes++; break;
+        case POWER_WAKE_BUTTON: s_rtc.counters.button_wakes++; break;
+        case POWER_WAKE_LORA:   s_rtc.counters.lora_wakes++;   break;
+        case POWER_WAKE_TIMER:  s_rtc.counters.timer_wakes++;  break;
+        default: break;
+        }
+        s_resume_armed = s_rtc.armed;
+    }
+    s_rtc.counters.boots++;
+
+    ESP_LOGI(TAG, "Boot #%lu, wake=%d, sleeps=%lu (asleep %llu s), armed=%d",
+             s_rtc.counters.boots, s_wake, s_rtc.counters.sleeps,
+             s_rtc.counters.asleep_ms / 1000, s_resume_armed);
+    return s_wake;
+}
+
+bool power_manager_resume_armed(void)
+{
+    return s_resume_armed;
+}
+
+static void enter_deep_sleep(void)
+{
+    s_rtc.armed = is_system_armed();
+    s_rtc.counters.sleeps++;
+
+    // Power-saving mode: the E32 listens in cycles and raises AUX before it
+    // outputs a frame sent with the wake-up preamble (sender in LORA_MODE_WAKEUP).
+    // M0/M1 are not RTC pins - hold their levels through deep sleep.
+    lora_set_mode(LORA_MODE_POWER_SAVING);
+    gpio_hold_en(LORA_M0_PIN);
+    gpio_hold_en(LORA_M1_PIN);
+    // UART TX idles high; a floating line looks like a start bit to the E32
+    // and the GPS, which would wake the receiver out of backup mode
+    gpio_hold_en(LORA_TX_PIN);
+    gpio_hold_en(GPS_TXD_PIN);
+    gpio_deep_sleep_hold_en();
+
+    // ext1 on ESP32 only supports ANY_HIGH for a set of pins, so the
+    // active-high sources share it and the active-low button takes ext0
+    uint64_t ext1_mask = (1ULL << MPU_INT_PIN);
+    rtc_gpio_pullup_dis(MPU_INT_PIN);
+    rtc_gpio_pulldown_en(MPU_INT_PIN);
+#if LORA_AUX_BUSY_LEVEL == 1
+    ext1_mask |= (1ULL << LORA_AUX_PIN);
+    rtc_gpio_pullup_dis(LORA_AUX_PIN);   // Driven by the module
+    rtc_gpio_pulldown_dis(LORA_AUX_PIN);
+#else
+    ESP_LOGW(TAG, "AUX is active low - no free wake source, downlink relies on the timer");
+#endif
+    esp_sleep_enable_ext1_wakeup_io(ext1_mask, ESP_EXT1_WAKEUP_ANY_HIGH);
+
+    rtc_gpio_pullup_en(BOOT_BUTTON_PIN);
+    rtc_gpio_pulldown_dis(BOOT_BUTTON_PIN);
+    esp_sleep_enable_ext0_wakeup(BOOT_BUTTON_PIN, 0);
+
+    // The timer also wakes us for a GPS standby refresh, whichever comes first
+    uint32_t timer_s = POWER_LISTEN_PERIOD_S > 0 ? POWER_LISTEN_PERIOD_S : UINT32_MAX;
+    uint32_t refresh_s = gps_standby_next_refresh_s();
+    if (refresh_s < timer_s) timer_s = refresh_s > 0 ? refresh_s : 1;
+    if (timer_s != UINT32_MAX) {
+        esp_sleep_enable_timer_wakeup((uint64_t)timer_s * 1000000);
+    }
+
+    ESP_LOGI(TAG, "Entering deep sleep (#%lu)", s_rtc.counters.sleeps);
+    vTaskDelay(pdMS_TO_TICKS(20)); // Let the log drain
+    s_rtc.sleep_enter_us = rtc_time_us();
+    esp_deep_sleep_start();
+}
+
+static void read_inputs(power_inputs_t *in)
+{
+    in->armed = is_system_armed();
+    in->in_alarm = is_system_in_alarm();
+    in->restarting = esp_is_restarting();
+    in->imu_busy = !mpu_monitor_is_idle();
+    in->lora_busy = lora_is_busy() || arming_status_pending();
+    in->button_down = gpio_get_level(BOOT_BUTTON_PIN) == 0;
+    in->gps_busy = gps_standby_active();
+}
+
+void power_manager_task(void *pvParameter)
+{
+    power_fsm_config_t cfg = {
+        .settle_ms = POWER_SETTLE_MS,
+        .listen_ms = POWER_LISTEN_MS,
+    };
+    power_fsm_init(&s_fsm, &cfg, s_wake, now_ms());
+    power_state_t last_state = s_fsm.state;
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(POWER_EVAL_MS));
+
+        power_inputs_t in;
+        read_inputs(&in);
+        bool may_sleep = power_fsm_step(&s_fsm, &in, now_ms());
+
+        if (s_fsm.state != last_state) {
+            ESP_LOGD(TAG, "%s -> %s (blockers 0x%02lx)", power_fsm_state_name(last_state),
+                     power_fsm_state_name(s_fsm.state), s_fsm.blockers);
+            last_state = s_fsm.state;
+        }
+        if (!may_sleep) continue;
+
+        // The wake pins must be low, otherwise we would wake immediately
+        // (or sleep through a motion that is already latched)
+        if (mpu_monitor_prepare_sleep(POWER_PREPARE_TIMEOUT_MS) != ESP_OK ||
+            gpio_get_level(MPU_INT_PIN) != 0 || lora_is_busy()) {
+            ESP_LOGI(TAG, "Sleep aborted, activity pending");
+            mpu_monitor_resume();
+            power_fsm_note_activity(&s_fsm, now_ms());
+            continue;
+        }
+
+        enter_deep_sleep();
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * track_buffer.h
+ * Bounded track of fixes with on-line simplification and a compact batch
+ * encoding for LoRa.
+ *
+ * Points closer than min_dist_m to the previous one are GPS jitter and are
+ * dropped. The rest go through an opening-window filter (the streaming form
+ * of Douglas-Peucker): a point is kept only when a straight line from the
+ * last kept point to the newest fix would pass further than tolerance_m from
+ * one of the points in between. The newest fix stays pending until the
+ * window closes or track_flush() commits it before a report.
+ *
+ * Kept points live in a caller-owned ring; when it is full the oldest point
+ * is overwritten and counted in `dropped`.
+ *
+ * Batch format (track_encode), integers as LEB128 varints, signed ones
+ * zig-zag encoded first:
+ *
+ *   version (u8) | count (u8) | quant_e7 | age_s | lat_e7 (s) | lon_e7 (s)
+ *   count - 1 times: dt_s | dlat (s) | dlon (s)
+ *
+ * The first point (anchor) is the newest of the batch and carries full
+ * precision and its age relative to the send time. Each following point is
+ * older: dt_s is the time step back, dlat/dlon the step back in units of
+ * quant_e7 on the grid round(x / quant_e7). Decoded history is within
+ * quant_e7 / 2 of the fix.
+ *
+ * Batches take the oldest unsent points, so a backlog left by failed sends
+ * goes out first and in order; the current position is reported separately.
+ * No ESP-IDF dependencies.
+ */
+
+#ifndef TRACK_BUFFER_H
+#define TRACK_BUFFER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TRACK_FRAME_VERSION (1)
+#define TRACK_WINDOW_MAX    (16)    // Points between two kept ones before one is forced
+#define TRACK_HEADER_MAX    (2 + 5 + 5 + 5 + 5)
+#define TRACK_POINT_MAX     (5 + 5 + 5)
+
+typedef struct {
+    int32_t lat_e7;
+    int32_t lon_e7;
+    uint32_t t_s;           // Uptime of the fix
+} track_point_t;
+
+typedef struct {
+    track_point_t *ring;    // Kept points, oldest first from tail
+    uint16_t capacity;
+    uint16_t head;          // Next write position
+    uint16_t count;
+    track_point_t window[TRACK_WINDOW_MAX];  // Since the last kept point, newest last
+    uint8_t window_len;
+    uint16_t min_dist_m;
+    uint16_t tolerance_m;
+    bool has_last;          // last is the newest kept point (may already be sent)
+    track_point_t last;
+    uint32_t added;         // Fixes offered
+    uint32_t jitter;        // Dropped by the distance filter
+    uint32_t simplified;    // Dropped by the line filter
+    uint32_t dropped;       // Overwritten before they were sent
+} track_t;
+
+/**
+ * @brief Attach caller-owned storage for `capacity` points and reset.
+ */
+void track_init(track_t *t, track_point_t *storage, uint16_t capacity,
+                uint16_t min_dist_m, uint16_t tolerance_m);
+
+/**
+ * @brief Forget all points and the filter state (statistics kept).
+ */
+void track_reset(track_t *t);
+
+/**
+ * @brief Offer a fix.
+ * @return false if it was dropped as jitter.
+ */
+bool track_add(track_t *t, const track_point_t *p);
+
+/**
+ * @brief Commit the pending newest fix so the track ends with it.
+ * @param current Latest fix, queued instead when everything was sent already
+ * (a parked bike only produces jitter) so every report carries a position;
+ * NULL to skip.
+ */
+void track_flush(track_t *t, const track_point_t *current);
+
+/**
+ * @brief Kept points not yet sent.
+ */
+static inline uint16_t track_count(const track_t *t) {
+    return t->count;
+}
+
+/**
+ * @brief Encode the oldest unsent points, as many as fit in out_len.
+ * Nothing is removed; call track_consume() once the frame went out.
+ * @param now_s Uptime at send time, for the anchor age.
+ * @param quant_e7 Grid of the deltas, 1 keeps full precision.
+ * @param points Number of points encoded.
+ * @return Encoded length, 0 if the track is empty or out_len < a single point.
+ */
+size_t track_encode(const track_t *t, uint32_t now_s, uint16_t quant_e7,
+                    uint8_t *out, size_t out_len, uint16_t *points);
+
+/**
+ * @brief Remove the oldest n points (those a successful track_encode() sent).
+ */
+void track_consume(track_t *t, uint16_t n);
+
+/**
+ * @brief Distance between two fixes in metres (local flat projection, fine
+ * for the few kilometres between reports).
+ */
+float track_distance_m(const track_point_t *a, const track_point_t *b);
+
+/**
+ * @brief Decode a batch, newest point first; t_s is relative to the send time
+ * (0 = sent, 30 = 30 s before).
+ * @return Number of points, or -1 for a malformed batch or one larger than max.
+ */
+int track_decode(const uint8_t *data, size_t len, track_point_t *out, int max);
+
+#endif // TRACK_BUFFER_H
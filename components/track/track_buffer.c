@@ -0,0 +1,231 @@
+#include "track_buffer.h"
+#include <math.h>
+#include <string.h>
+
+#define M_PER_E7    (0.0111195f)    // Metres per 1e-7 degree of latitude
+#define RAD_PER_E7  (1.74532925e-9f)
+
+void track_init(track_t *t, track_point_t *storage, uint16_t capacity,
+                uint16_t min_dist_m, uint16_t tolerance_m) {
+    memset(t, 0, sizeof(*t));
+    t->ring = storage;
+    t->capacity = capacity;
+    t->min_dist_m = min_dist_m;
+    t->tolerance_m = tolerance_m;
+}
+
+void track_reset(track_t *t) {
+    t->head = 0;
+    t->count = 0;
+    t->window_len = 0;
+    t->has_last = false;
+}
+
+// --- Geometry: local equirectangular projection around a, in metres ---
+
+static void project(const track_point_t *a, const track_point_t *p, float coslat, float *x, float *y) {
+    *x = (float)((int64_t)p->lon_e7 - a->lon_e7) * M_PER_E7 * coslat;
+    *y = (float)((int64_t)p->lat_e7 - a->lat_e7) * M_PER_E7;
+}
+
+static float coslat(const track_point_t *a) {
+    return cosf((float)a->lat_e7 * RAD_PER_E7);
+}
+
+float track_distance_m(const track_point_t *a, const track_point_t *b) {
+    float x, y;
+    project(a, b, coslat(a), &x, &y);
+    return sqrtf(x * x + y * y);
+}
+
+// Distance of q from the segment a-b
+static float segment_distance_m(const track_point_t *a, const track_point_t *b,
+                                const track_point_t *q, float c) {
+    float bx, by, qx, qy;
+    project(a, b, c, &bx, &by);
+    project(a, q, c, &qx, &qy);
+
+    float len2 = bx * bx + by * by;
+    float u = len2 > 0.0f ? (qx * bx + qy * by) / len2 : 0.0f;
+    if (u < 0.0f) u = 0.0f;
+    if (u > 1.0f) u = 1.0f;
+    float dx = qx - u * bx, dy = qy - u * by;
+    return sqrtf(dx * dx + dy * dy);
+}
+
+// --- Filter ---
+
+static void commit(track_t *t, const track_point_t *p) {
+    t->ring[t->head] = *p;
+    t->head = (uint16_t)((t->head + 1) % t->capacity);
+    if (t->count < t->capacity) t->count++;
+    else t->dropped++;
+    t->last = *p;
+    t->has_last = true;
+}
+
+// The newest pending point becomes the next kept one, the rest are dropped
+static void close_window(track_t *t) {
+    commit(t, &t->window[t->window_len - 1]);
+    t->simplified += t->window_len - 1u;
+    t->window_len = 0;
+}
+
+bool track_add(track_t *t, const track_point_t *p) {
+    t->added++;
+    if (!t->has_last) {
+        commit(t, p);
+        return true;
+    }
+
+    const track_point_t *ref = t->window_len ? &t->window[t->window_len - 1] : &t->last;
+    if (track_distance_m(ref, p) < (float)t->min_dist_m) {
+        t->jitter++;
+        return false;
+    }
+
+    // Would a line from the last kept point to p still cover the window?
+    float c = coslat(&t->last);
+    bool covered = t->window_len < TRACK_WINDOW_MAX;
+    for (uint8_t i = 0; covered && i < t->window_len; i++) {
+        if (segment_distance_m(&t->last, p, &t->window[i], c) > (float)t->tolerance_m) covered = false;
+    }
+    if (!covered) close_window(t);
+    t->window[t->window_len++] = *p;
+    return true;
+}
+
+void track_flush(track_t *t, const track_point_t *current) {
+    if (t->window_len > 0) close_window(t);
+    else if (t->count == 0 && current != NULL) commit(t, current);
+}
+
+// --- Batch encoding ---
+
+static size_t put_varint(uint8_t *out, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)((v >> 1) ^ (0u - (v & 1)));
+}
+
+// Nearest multiple of q, in units of q
+static int32_t quantize(int32_t x, uint16_t q) {
+    return x >= 0 ? (int32_t)(((int64_t)x + q / 2) / q) : -(int32_t)((-(int64_t)x + q / 2) / q);
+}
+
+// fwd-th unsent point from the oldest one
+static const track_point_t *oldest(const track_t *t, uint16_t fwd) {
+    return &t->ring[(t->head + t->capacity - t->count + fwd) % t->capacity];
+}
+
+static size_t put_header(uint8_t *out, const track_point_t *anchor, uint16_t count, uint32_t now_s,
+                         uint16_t quant_e7) {
+    size_t n = 0;
+    out[n++] = TRACK_FRAME_VERSION;
+    out[n++] = (uint8_t)count;
+    n += put_varint(out + n, quant_e7);
+    n += put_varint(out + n, now_s > anchor->t_s ? now_s - anchor->t_s : 0);
+    n += put_varint(out + n, zigzag(anchor->lat_e7));
+    n += put_varint(out + n, zigzag(anchor->lon_e7));
+    return n;
+}
+
+// One step back in time, from newer to the older point p
+static size_t put_step(uint8_t *out, const track_point_t *newer, const track_point_t *p, uint16_t quant_e7) {
+    int32_t qlat = quantize(newer->lat_e7, quant_e7);
+    int32_t qlon = quantize(newer->lon_e7, quant_e7);
+    int32_t plat = quantize(p->lat_e7, quant_e7);
+    int32_t plon = quantize(p->lon_e7, quant_e7);
+    size_t n = put_varint(out, newer->t_s > p->t_s ? newer->t_s - p->t_s : 0);
+    n += put_varint(out + n, zigzag((int32_t)((uint32_t)plat - (uint32_t)qlat)));
+    n += put_varint(out + n, zigzag((int32_t)((uint32_t)plon - (uint32_t)qlon)));
+    return n;
+}
+
+size_t track_encode(const track_t *t, uint32_t now_s, uint16_t quant_e7,
+                    uint8_t *out, size_t out_len, uint16_t *points) {
+    *points = 0;
+    if (t->count == 0 || quant_e7 == 0 || out_len < TRACK_HEADER_MAX) return 0;
+
+    // Take the oldest points that fit. A step costs the same whichever point
+    // anchors the batch, only the header depends on the anchor.
+    uint8_t tmp[TRACK_HEADER_MAX];
+    uint16_t count = 1;
+    size_t steps = 0;
+    while (count < t->count && count < 255) {
+        size_t m = put_step(tmp, oldest(t, count), oldest(t, count - 1), quant_e7);
+        if (put_header(tmp, oldest(t, count), count + 1, now_s, quant_e7) + steps + m > out_len) break;
+        steps += m;
+        count++;
+    }
+
+    // Written from the newest of them back
+    size_t n = put_header(out, oldest(t, count - 1), count, now_s, quant_e7);
+    for (uint16_t i = count - 1; i > 0; i--) {
+        n += put_step(out + n, oldest(t, i), oldest(t, i - 1), quant_e7);
+    }
+    *points = count;
+    return n;
+}
+
+void track_consume(track_t *t, uint16_t n) {
+    if (n > t->count) n = t->count;
+    t->count -= n;
+}
+
+// --- Decoding (backend reference and tests) ---
+
+static bool get_varint(const uint8_t *data, size_t len, size_t *pos, uint32_t *v) {
+    *v = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+        if (*pos >= len) return false;
+        uint8_t b = data[(*pos)++];
+        *v |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+int track_decode(const uint8_t *data, size_t len, track_point_t *out, int max) {
+    if (len < 2 || data[0] != TRACK_FRAME_VERSION || data[1] == 0 || data[1] > max) return -1;
+
+    int count = data[1];
+    size_t pos = 2;
+    uint32_t q, age, lat, lon;
+    if (!get_varint(data, len, &pos, &q) || q == 0 || q > UINT16_MAX ||
+        !get_varint(data, len, &pos, &age) ||
+        !get_varint(data, len, &pos, &lat) ||
+        !get_varint(data, len, &pos, &lon)) return -1;
+
+    out[0].lat_e7 = unzigzag(lat);
+    out[0].lon_e7 = unzigzag(lon);
+    out[0].t_s = age;
+    uint32_t qlat = (uint32_t)quantize(out[0].lat_e7, (uint16_t)q);
+    uint32_t qlon = (uint32_t)quantize(out[0].lon_e7, (uint16_t)q);
+
+    for (int i = 1; i < count; i++) {
+        uint32_t dt, dlat, dlon;
+        if (!get_varint(data, len, &pos, &dt) ||
+            !get_varint(data, len, &pos, &dlat) ||
+            !get_varint(data, len, &pos, &dlon)) return -1;
+        qlat += (uint32_t)unzigzag(dlat);
+        qlon += (uint32_t)unzigzag(dlon);
+        age += dt;
+        out[i].lat_e7 = (int32_t)((int64_t)(int32_t)qlat * q);
+        out[i].lon_e7 = (int32_t)((int64_t)(int32_t)qlon * q);
+        out[i].t_s = age;
+    }
+    return pos == len ? count : -1;
+}
@@ -16,6 +16,7 @@
 #include "mqtt_cl.h"
 #include "ble_config.h"
 #include "lora.h"
+#include "power_manager.h"
 
 static const char *TAG = "MAIN";
 
@@ -43,6 +44,9 @@ void app_main(void)
     // 1. Init NVS
     ESP_ERROR_CHECK(nvs_store_init());
 
+    // Wake cause and state kept in RTC memory across deep sleep
+    power_manager_init();
+
     // 2. Init Netif & Event Loop
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -68,7 +72,12 @@ void app_main(void)
 
         ble_config_deinit();
         
+        // IMU command queue must exist before the LoRa receiver starts
+        ESP_ERROR_CHECK(mpu_monitor_init());
         arming_init();
+        if (power_manager_resume_armed()) {
+            arming_restore(true);
+        }
 
         // Load WiFi and Connect
         // char ssid[32] = {0}, pass[64] = {0};
@@ -83,6 +92,7 @@ void app_main(void)
         xTaskCreate(&battery_monitor_task, "bat_mon", 5120, NULL, 1, NULL);
         xTaskCreate(&mpu_monitor_task, "mpu_mon", 4096, NULL, 5, NULL);
         xTaskCreate(&alarm_runner_task, "alarm_run", 4096, NULL, 5, NULL);
+        xTaskCreate(&power_manager_task, "power", 3072, NULL, 3, NULL);
         
     }
 }
\ No newline at end of file
@@ -0,0 +1,187 @@
+/*
+ * Corpus test for the streaming NMEA parser.
+ *
+ *   nmea_corpus_test corpus/neo6m.nmea corpus/neo6m.expected
+ *
+ * Feeds the corpus byte by byte and in odd-sized blocks, prints one canonical
+ * line per verified sentence plus the parser statistics, and compares each
+ * run with the expected file. Without the second argument the output is only printed,
+ * which is how the expected file of a new corpus is reviewed and created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nmea_parser.h"
+
+#define LINE_MAX_LEN 160
+
+static void pos_str(char *buf, size_t len, bool has_pos, int32_t lat_e7, int32_t lon_e7) {
+    if (has_pos) snprintf(buf, len, "%ld,%ld", (long)lat_e7, (long)lon_e7);
+    else snprintf(buf, len, "-");
+}
+
+static void format_sentence(char *out, size_t len, nmea_type_t type, const nmea_parser_t *p) {
+    char pos[32];
+    char opt[2][16];
+
+    switch (type) {
+    case NMEA_GGA: {
+        const nmea_gga_t *g = &p->s.gga;
+        pos_str(pos, sizeof(pos), g->has_pos, g->lat_e7, g->lon_e7);
+        if (g->has_alt) snprintf(opt[0], sizeof(opt[0]), "%ld", (long)g->alt_mm);
+        else snprintf(opt[0], sizeof(opt[0]), "-");
+        snprintf(out, len, "GGA t=%lu q=%u sv=%u hdop=%u pos=%s alt=%s",
+                 (unsigned long)g->time_ms, g->fix_quality, g->satellites, g->hdop_x100, pos, opt[0]);
+        break;
+    }
+    case NMEA_RMC: {
+        const nmea_rmc_t *r = &p->s.rmc;
+        pos_str(pos, sizeof(pos), r->has_pos, r->lat_e7, r->lon_e7);
+        if (r->has_course) snprintf(opt[0], sizeof(opt[0]), "%u", r->course_e2);
+        else snprintf(opt[0], sizeof(opt[0]), "-");
+        snprintf(out, len, "RMC t=%lu st=%c date=%lu pos=%s spd=%lu crs=%s",
+                 (unsigned long)r->time_ms, r->active ? 'A' : 'V', (unsigned long)r->date, pos,
+                 (unsigned long)r->speed_mm_s, opt[0]);
+        break;
+    }
+    case NMEA_VTG: {
+        const nmea_vtg_t *v = &p->s.vtg;
+        if (v->has_speed) snprintf(opt[0], sizeof(opt[0]), "%lu", (unsigned long)v->speed_mm_s);
+        else snprintf(opt[0], sizeof(opt[0]), "-");
+        if (v->has_course) snprintf(opt[1], sizeof(opt[1]), "%u", v->course_e2);
+        else snprintf(opt[1], sizeof(opt[1]), "-");
+        snprintf(out, len, "VTG spd=%s crs=%s", opt[0], opt[1]);
+        break;
+    }
+    case NMEA_GSA: {
+        const nmea_gsa_t *g = &p->s.gsa;
+        snprintf(out, len, "GSA fix=%u used=%u pdop=%u hdop=%u vdop=%u",
+                 g->fix_type, g->sats_used, g->pdop_x100, g->hdop_x100, g->vdop_x100);
+        break;
+    }
+    default:
+        snprintf(out, len, "OTHER %.*s", p->addr_len, p->addr);
+        break;
+    }
+}
+
+static char *read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = malloc((size_t)n + 1);
+    if (buf != NULL && fread(buf, 1, (size_t)n, f) == (size_t)n) {
+        buf[n] = '\0';
+        *len = (size_t)n;
+    } else {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    return buf;
+}
+
+// Next '\n'-terminated line of the expected file, or NULL at the end
+static const char *next_line(char **cursor, char *line, size_t len) {
+    if (**cursor == '\0') return NULL;
+    size_t n = strcspn(*cursor, "\r\n");
+    snprintf(line, len, "%.*s", (int)n, *cursor);
+    *cursor += n;
+    while (**cursor == '\r' || **cursor == '\n') (*cursor)++;
+    return line;
+}
+
+// Parses the corpus into canonical lines, one per verified sentence plus the
+// statistics. chunk 0 feeds byte by byte, otherwise blocks of 1..chunk bytes
+// so that sentences and fields are split at every position.
+static char *run(const char *corpus, size_t len, size_t chunk) {
+    size_t cap = len * 2 + 256, used = 0;
+    char *out = malloc(cap);
+    char line[LINE_MAX_LEN];
+    nmea_parser_t p;
+    nmea_parser_init(&p);
+
+    size_t i = 0, step = 1;
+    while (out != NULL && i < len) {
+        nmea_type_t type;
+        if (chunk == 0) {
+            type = nmea_parser_feed(&p, (uint8_t)corpus[i++]);
+        } else {
+            size_t n = len - i < step ? len - i : step;
+            size_t used_bytes = nmea_parser_feed_buf(&p, (const uint8_t *)corpus + i, n, &type);
+            i += used_bytes;
+            if (type == NMEA_NONE) step = step % chunk + 1;
+        }
+        if (type == NMEA_NONE) continue;
+        format_sentence(line, sizeof(line), type, &p);
+        used += (size_t)snprintf(out + used, cap - used, "%s\n", line);
+    }
+    if (out != NULL) {
+        snprintf(out + used, cap - used, "stats ok=%lu ck=%lu ovf=%lu bad=%lu\n",
+                 (unsigned long)p.stats.sentences, (unsigned long)p.stats.checksum_errors,
+                 (unsigned long)p.stats.overflows, (unsigned long)p.stats.malformed);
+    }
+    return out;
+}
+
+// Line-by-line comparison, prints mismatches
+static int compare(const char *name, const char *got, const char *want) {
+    char *g = (char *)got, *w = (char *)want;
+    char gl[LINE_MAX_LEN], wl[LINE_MAX_LEN];
+    int line = 0, failures = 0;
+
+    while (1) {
+        const char *a = next_line(&g, gl, sizeof(gl));
+        const char *b = next_line(&w, wl, sizeof(wl));
+        if (a == NULL && b == NULL) break;
+        line++;
+        if (a == NULL || b == NULL || strcmp(a, b) != 0) {
+            printf("%s line %d: expected %s\n%*s got      %s\n", name, line,
+                   b ? b : "(end)", (int)strlen(name) + 8 + (line > 9 ? 1 : 0), "", a ? a : "(end)");
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s corpus.nmea [expected.txt]\n", argv[0]);
+        return 2;
+    }
+
+    size_t corpus_len = 0, expected_len = 0;
+    char *corpus = read_file(argv[1], &corpus_len);
+    char *expected = argc > 2 ? read_file(argv[2], &expected_len) : NULL;
+    if (corpus == NULL || (argc > 2 && expected == NULL)) {
+        fprintf(stderr, "cannot read input files\n");
+        return 2;
+    }
+
+    char *bytes = run(corpus, corpus_len, 0);
+    if (bytes == NULL) return 2;
+    if (expected == NULL) {
+        fputs(bytes, stdout);
+        free(bytes);
+        free(corpus);
+        return 0;
+    }
+
+    int failures = compare("per-byte", bytes, expected);
+    for (size_t chunk = 1; chunk <= 17; chunk += 8) {
+        char *blocks = run(corpus, corpus_len, chunk);
+        char name[32];
+        snprintf(name, sizeof(name), "blocks<=%zu", chunk);
+        failures += blocks ? compare(name, blocks, expected) : 1;
+        free(blocks);
+    }
+
+    printf("%s: %d failures\n", argv[1], failures);
+    free(bytes);
+    free(corpus);
+    free(expected);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * Tests for the deep sleep decision (power_fsm).
+ *
+ *   power_fsm_test
+ *
+ * Drives the machine with explicit time through a cold boot, arming, the
+ * settle and listen windows after each wake cause, every blocker, an alarm
+ * and the millisecond counter wrapping, and checks when sleep is allowed
+ * and which blockers are reported.
+ */
+
+#include <stdio.h>
+#include "power_fsm.h"
+
+static int s_failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); s_failures++; } \
+} while (0)
+
+#define SETTLE_MS   5000
+#define LISTEN_MS   2000
+
+static const power_fsm_config_t s_cfg = {.settle_ms = SETTLE_MS, .listen_ms = LISTEN_MS};
+static const power_inputs_t s_armed = {.armed = true};
+
+static void test_cold_boot(void) {
+    power_fsm_t f;
+    power_inputs_t in = {0};
+    power_fsm_init(&f, &s_cfg, POWER_WAKE_COLD, 0);
+    CHECK(f.state == POWER_STATE_AWAKE);
+
+    // Disarmed never sleeps
+    CHECK(!power_fsm_step(&f, &in, 60000));
+    CHECK(f.state == POWER_STATE_AWAKE);
+    CHECK(f.blockers == POWER_BLOCK_DISARMED);
+
+    // Arming starts the quiet period
+    in.armed = true;
+    CHECK(!power_fsm_step(&f, &in, 100000));
+    CHECK(f.state == POWER_STATE_SETTLING);
+    CHECK(f.blockers == POWER_BLOCK_QUIET);
+    CHECK(!power_fsm_step(&f, &in, 100000 + SETTLE_MS - 1));
+    CHECK(power_fsm_step(&f, &in, 100000 + SETTLE_MS));
+    CHECK(f.state == POWER_STATE_SLEEP);
+    CHECK(f.blockers == 0);
+}
+
+static void test_listen_window(void) {
+    const power_wake_t wakes[] = {POWER_WAKE_TIMER, POWER_WAKE_LORA};
+    for (size_t i = 0; i < sizeof(wakes) / sizeof(wakes[0]); i++) {
+        power_fsm_t f;
+        power_fsm_init(&f, &s_cfg, wakes[i], 1000);
+        CHECK(f.state == POWER_STATE_LISTENING);
+        CHECK(!power_fsm_step(&f, &s_armed, 1000 + LISTEN_MS - 1));
+        CHECK(f.state == POWER_STATE_LISTENING);
+        CHECK(power_fsm_step(&f, &s_armed, 1000 + LISTEN_MS));
+    }
+
+    // A downlink during the window needs the full settle time afterwards
+    power_fsm_t f;
+    power_inputs_t in = s_armed;
+    power_fsm_init(&f, &s_cfg, POWER_WAKE_LORA, 0);
+    in.lora_busy = true;
+    CHECK(!power_fsm_step(&f, &in, 500));
+    CHECK(f.state == POWER_STATE_SETTLING);
+    CHECK(f.blockers == (POWER_BLOCK_LORA | POWER_BLOCK_QUIET));
+    in.lora_busy = false;
+    CHECK(!power_fsm_step(&f, &in, 500 + LISTEN_MS));
+    CHECK(!power_fsm_step(&f, &in, 500 + SETTLE_MS - 1));
+    CHECK(power_fsm_step(&f, &in, 500 + SETTLE_MS));
+}
+
+static void test_motion_wake(void) {
+    power_fsm_t f;
+    power_fsm_init(&f, &s_cfg, POWER_WAKE_MOTION, 0);
+    CHECK(f.state == POWER_STATE_AWAKE);
+    // Resumes armed (no arming activity); settle counts from the first step
+    CHECK(!power_fsm_step(&f, &s_armed, 10));
+    CHECK(f.state == POWER_STATE_SETTLING);
+    CHECK(!power_fsm_step(&f, &s_armed, SETTLE_MS + 9));
+    CHECK(power_fsm_step(&f, &s_armed, SETTLE_MS + 10));
+}
+
+static void test_blockers(void) {
+    static const struct {
+        power_inputs_t busy;
+        uint32_t bit;
+    } inputs[] = {
+        {{.armed = true, .imu_busy = true}, POWER_BLOCK_IMU},
+        {{.armed = true, .lora_busy = true}, POWER_BLOCK_LORA},
+        {{.armed = true, .button_down = true}, POWER_BLOCK_BUTTON},
+        {{.armed = true, .gps_busy = true}, POWER_BLOCK_GPS},
+    };
+
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+        power_fsm_t f;
+        power_fsm_init(&f, &s_cfg, POWER_WAKE_MOTION, 0);
+        CHECK(!power_fsm_step(&f, &s_armed, 0));
+        CHECK(power_fsm_step(&f, &s_armed, SETTLE_MS));
+
+        // Held for longer than the settle time: still no sleep
+        CHECK(!power_fsm_step(&f, &inputs[i].busy, SETTLE_MS + 1));
+        CHECK(f.state == POWER_STATE_SETTLING);
+        CHECK(!power_fsm_step(&f, &inputs[i].busy, 4 * SETTLE_MS));
+        CHECK(f.blockers == (inputs[i].bit | POWER_BLOCK_QUIET));
+
+        // Released: a full quiet period from the last busy step
+        CHECK(!power_fsm_step(&f, &s_armed, 5 * SETTLE_MS - 1));
+        CHECK(power_fsm_step(&f, &s_armed, 5 * SETTLE_MS));
+    }
+}
+
+static void test_alarm_and_restart(void) {
+    power_fsm_t f;
+    power_inputs_t in = s_armed;
+    power_fsm_init(&f, &s_cfg, POWER_WAKE_MOTION, 0);
+
+    in.in_alarm = true;
+    CHECK(!power_fsm_step(&f, &in, 1000));
+    CHECK(f.state == POWER_STATE_AWAKE);
+    CHECK(f.blockers == POWER_BLOCK_ALARM);
+    CHECK(!power_fsm_step(&f, &in, 600000));
+
+    // Cleared: the quiet period starts at the clear
+    in.in_alarm = false;
+    CHECK(!power_fsm_step(&f, &in, 700000));
+    CHECK(f.state == POWER_STATE_SETTLING);
+    CHECK(!power_fsm_step(&f, &in, 700000 + SETTLE_MS - 1));
+    CHECK(power_fsm_step(&f, &in, 700000 + SETTLE_MS));
+
+    in.restarting = true;
+    CHECK(!power_fsm_step(&f, &in, 800000));
+    CHECK(f.state == POWER_STATE_AWAKE);
+    CHECK(f.blockers == POWER_BLOCK_RESTART);
+}
+
+static void test_note_activity(void) {
+    power_fsm_t f;
+    power_fsm_init(&f, &s_cfg, POWER_WAKE_TIMER, 0);
+    CHECK(power_fsm_step(&f, &s_armed, LISTEN_MS));
+
+    // An aborted sleep: back to settling, settle time rather than listen time
+    power_fsm_note_activity(&f, 3000);
+    CHECK(f.state == POWER_STATE_SETTLING);
+    CHECK(!power_fsm_step(&f, &s_armed, 3000 + LISTEN_MS));
+    CHECK(power_fsm_step(&f, &s_armed, 3000 + SETTLE_MS));
+}
+
+static void test_wrap(void) {
+    const uint32_t t0 = UINT32_MAX - 1000;
+    power_fsm_t f;
+    power_fsm_init(&f, &s_cfg, POWER_WAKE_MOTION, t0);
+    CHECK(!power_fsm_step(&f, &s_armed, t0));
+    CHECK(!power_fsm_step(&f, &s_armed, t0 + SETTLE_MS - 1));
+    CHECK(power_fsm_step(&f, &s_armed, t0 + SETTLE_MS));
+}
+
+int main(void) {
+    test_cold_boot();
+    test_listen_window();
+    test_motion_wake();
+    test_blockers();
+    test_alarm_and_restart();
+    test_note_activity();
+    test_wrap();
+    printf("power_fsm_test: %d failures\n", s_failures);
+    return s_failures ? 1 : 0;
+}
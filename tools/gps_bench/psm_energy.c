@@ -0,0 +1,63 @@
+/*
+ * Modeled receiver energy per alarm report, continuous tracking against
+ * power save ON/OFF operation (UBX-CFG-PM2, see gps_set_power_save).
+ *
+ *   psm_energy
+ *
+ * Currents are the NEO-6 datasheet figures for the module alone (3.0 V,
+ * max performance); the breakout board's regulator and LED come on top in
+ * both modes. In ON/OFF operation every period costs a hot acquisition,
+ * the configured on time and the off current for the rest, plus the
+ * ephemeris downloads the receiver schedules itself (updateEPH), spread
+ * over the reports. The report period and on time come from config.h
+ * (ALARM_REPORT_MIN_MS, GPS_PSM_ON_TIME_S). Not a measurement and not a
+ * test: it ranks the modes and shows how the saving scales with the period.
+ */
+
+#include <stdio.h>
+#include "config.h"
+
+#define SUPPLY_V            (3.0)
+#define I_ACQUISITION_MA    (47.0)
+#define I_TRACKING_MA       (37.0)
+#define I_OFF_MA            (0.1)      // ON/OFF off state, RTC and backup RAM
+#define I_CYCLIC_1HZ_MA     (11.0)     // Datasheet power save average at 1 Hz
+#define HOT_START_S         (1.0)
+#define EPH_DOWNLOAD_S      (30.0)     // Receiver kept on for new ephemeris ...
+#define EPH_INTERVAL_S      (1800.0)   // ... about every half hour
+
+#define REPORT_PERIOD_S     (ALARM_REPORT_MIN_MS / 1000.0)
+#define PSM_ON_TIME_S       ((double)GPS_PSM_ON_TIME_S)
+
+// mJ per report period
+static double continuous_mj(double period_s) {
+    return SUPPLY_V * I_TRACKING_MA * period_s;
+}
+
+static double on_off_mj(double period_s, double on_time_s) {
+    double on_s = HOT_START_S + on_time_s;
+    double eph_s = EPH_DOWNLOAD_S * period_s / EPH_INTERVAL_S;
+    double off_s = period_s - on_s - eph_s;
+    if (off_s < 0) off_s = 0;
+    return SUPPLY_V * (I_ACQUISITION_MA * HOT_START_S + I_TRACKING_MA * (on_time_s + eph_s) +
+                       I_OFF_MA * off_s);
+}
+
+int main(void) {
+    double cont = continuous_mj(REPORT_PERIOD_S);
+    double psm = on_off_mj(REPORT_PERIOD_S, PSM_ON_TIME_S);
+    printf("report every %.0f s: continuous %.0f mJ, power save %.0f mJ (%.1fx less)\n",
+           REPORT_PERIOD_S, cont, psm, cont / psm);
+    printf("cyclic tracking at 1 Hz (datasheet average): %.0f mJ\n",
+           SUPPLY_V * I_CYCLIC_1HZ_MA * REPORT_PERIOD_S);
+
+    printf("\nperiod   continuous   power save   average\n");
+    const double periods[] = {15, 30, 60, 120, 300};
+    for (size_t i = 0; i < sizeof(periods) / sizeof(periods[0]); i++) {
+        double c = continuous_mj(periods[i]);
+        double p = on_off_mj(periods[i], PSM_ON_TIME_S);
+        double avg_ma = p / SUPPLY_V / periods[i];
+        printf("%5.0f s  %8.0f mJ  %8.0f mJ  %5.2f mA\n", periods[i], c, p, avg_ma);
+    }
+    return 0;
+}
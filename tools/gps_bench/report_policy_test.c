@@ -0,0 +1,207 @@
+/*
+ * Tests for the alarm report policy (report_policy).
+ *
+ *   report_policy_test
+ *
+ * Steps the policy with explicit time (ms) through the start of an alarm
+ * with and without a fix, displacement below and above dist_m, course
+ * changes across north at and below heading_min_mm_s, the heartbeat
+ * backing off to max_interval_ms and resetting on movement, and the
+ * fix_sync_ms window used with the receiver in power save.
+ */
+
+#include <stdio.h>
+#include "report_policy.h"
+
+static int s_failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); s_failures++; } \
+} while (0)
+
+#define MIN_MS      30000
+#define MAX_MS      240000
+#define LAT0        500619835
+#define LON0        199383018
+#define E7_PER_M    (1.0 / 0.0111195)
+#define RIDING      5000        // mm/s
+#define WALKING     1000
+
+static const report_policy_config_t s_cfg = {
+    .min_interval_ms = MIN_MS,
+    .max_interval_ms = MAX_MS,
+    .dist_m = 50,
+    .heading_deg = 45,
+    .heading_min_mm_s = 2000,
+    .fix_sync_ms = 0,
+};
+
+// A new fix north_m metres north of the start
+static report_inputs_t fix_at(double north_m, uint16_t course_e2, uint32_t speed_mm_s) {
+    report_inputs_t in = {
+        .fix = true,
+        .new_fix = true,
+        .pos = {.lat_e7 = LAT0 + (int32_t)(north_m * E7_PER_M), .lon_e7 = LON0},
+        .course_e2 = course_e2,
+        .speed_mm_s = speed_mm_s,
+    };
+    return in;
+}
+
+// Steps and records the report as sent, as alarm_runner does
+static report_reason_t step(report_policy_t *p, const report_inputs_t *in, uint32_t now_ms) {
+    report_reason_t r = report_policy_step(p, in, now_ms);
+    report_policy_sent(p, r, in, now_ms);
+    return r;
+}
+
+static void test_start(void) {
+    const report_inputs_t none = {0};
+    report_policy_t p;
+    report_policy_init(&p, &s_cfg);
+
+    CHECK(step(&p, &none, 0) == REPORT_REASON_START);
+    CHECK(step(&p, &none, 1000) == REPORT_REASON_NONE);
+
+    // The first fix goes out at once, whatever the interval
+    report_inputs_t in = fix_at(0, 0, 0);
+    CHECK(step(&p, &in, 2000) == REPORT_REASON_FIRST_FIX);
+    CHECK(step(&p, &in, 3000) == REPORT_REASON_NONE);
+    CHECK(p.sent[REPORT_REASON_START] == 1);
+    CHECK(p.sent[REPORT_REASON_FIRST_FIX] == 1);
+
+    // A fix at the alarm start skips START
+    report_policy_init(&p, &s_cfg);
+    CHECK(step(&p, &in, 0) == REPORT_REASON_FIRST_FIX);
+    CHECK(step(&p, &in, 1000) == REPORT_REASON_NONE);
+    CHECK(p.sent[REPORT_REASON_START] == 0);
+
+    // Without a fix the link is kept alive by heartbeats
+    report_policy_init(&p, &s_cfg);
+    CHECK(step(&p, &none, 0) == REPORT_REASON_START);
+    CHECK(step(&p, &none, MIN_MS - 1) == REPORT_REASON_NONE);
+    CHECK(step(&p, &none, MIN_MS) == REPORT_REASON_HEARTBEAT);
+}
+
+static void test_moved(void) {
+    report_policy_t p;
+    report_policy_init(&p, &s_cfg);
+    report_inputs_t in = fix_at(0, 0, WALKING);
+    CHECK(step(&p, &in, 0) == REPORT_REASON_FIRST_FIX);
+
+    // Moved, but min_interval_ms not over yet
+    in = fix_at(60, 0, WALKING);
+    CHECK(step(&p, &in, 10000) == REPORT_REASON_NONE);
+    CHECK(step(&p, &in, MIN_MS) == REPORT_REASON_MOVED);
+
+    // 40 m from the last report: only a heartbeat, from the reported position
+    in = fix_at(100, 0, WALKING);
+    CHECK(step(&p, &in, 2 * MIN_MS - 1) == REPORT_REASON_NONE);
+    CHECK(step(&p, &in, 2 * MIN_MS) == REPORT_REASON_HEARTBEAT);
+    in = fix_at(160, 0, WALKING);
+    CHECK(step(&p, &in, 3 * MIN_MS) == REPORT_REASON_MOVED);
+
+    // Only new fixes count
+    in = fix_at(250, 0, WALKING);
+    in.new_fix = false;
+    CHECK(step(&p, &in, 4 * MIN_MS - 1) == REPORT_REASON_NONE);
+}
+
+static void test_turned(void) {
+    report_policy_t p;
+    report_policy_init(&p, &s_cfg);
+    report_inputs_t in = fix_at(0, 35000, RIDING);     // 350 deg
+    CHECK(step(&p, &in, 0) == REPORT_REASON_FIRST_FIX);
+
+    // Not before min_interval_ms
+    in = fix_at(10, 9000, RIDING);
+    CHECK(step(&p, &in, MIN_MS - 1000) == REPORT_REASON_NONE);
+
+    // Across north: 350 -> 40 is 50 deg, 40 -> 355 back is 45 deg
+    in = fix_at(10, 4000, RIDING);
+    CHECK(step(&p, &in, MIN_MS) == REPORT_REASON_TURNED);
+    in = fix_at(20, 35500, RIDING);
+    CHECK(step(&p, &in, 2 * MIN_MS) == REPORT_REASON_TURNED);
+
+    // 355 -> 30 is 35 deg: the interval is over, so only a heartbeat
+    in = fix_at(30, 3000, RIDING);
+    CHECK(step(&p, &in, 3 * MIN_MS) == REPORT_REASON_HEARTBEAT);
+
+    // The course is noise at walking pace
+    in = fix_at(35, 18000, WALKING);
+    CHECK(step(&p, &in, 4 * MIN_MS) == REPORT_REASON_NONE);
+    in = fix_at(40, 18000, RIDING);
+    CHECK(step(&p, &in, 4 * MIN_MS + 1000) == REPORT_REASON_TURNED);
+
+    // ... and a report sent at walking pace holds no course to compare with
+    report_policy_init(&p, &s_cfg);
+    in = fix_at(0, 0, WALKING);
+    CHECK(step(&p, &in, 0) == REPORT_REASON_FIRST_FIX);
+    in = fix_at(10, 18000, RIDING);
+    CHECK(step(&p, &in, MIN_MS) == REPORT_REASON_HEARTBEAT);
+}
+
+static void test_backoff(void) {
+    report_policy_t p;
+    report_policy_init(&p, &s_cfg);
+    report_inputs_t in = fix_at(0, 0, 0);
+    CHECK(step(&p, &in, 0) == REPORT_REASON_FIRST_FIX);
+
+    // Parked, a fix every second: 30, 60, 120, 240, 240 s apart
+    const uint32_t expected_s[] = {30, 60, 120, 240, 240};
+    uint32_t last = 0;
+    size_t beats = 0;
+    for (uint32_t t = 1000; t <= 700000 && beats < 5; t += 1000) {
+        report_reason_t r = step(&p, &in, t);
+        if (r == REPORT_REASON_NONE) continue;
+        CHECK(r == REPORT_REASON_HEARTBEAT);
+        CHECK(t - last == expected_s[beats] * 1000);
+        last = t;
+        beats++;
+    }
+    CHECK(beats == 5);
+    CHECK(p.interval_ms == MAX_MS);
+
+    // Movement resets the heartbeat interval
+    in = fix_at(80, 0, WALKING);
+    CHECK(step(&p, &in, last + MIN_MS) == REPORT_REASON_MOVED);
+    CHECK(p.interval_ms == MIN_MS);
+    CHECK(step(&p, &in, last + 2 * MIN_MS) == REPORT_REASON_HEARTBEAT);
+}
+
+static void test_fix_sync(void) {
+    report_policy_config_t cfg = s_cfg;
+    cfg.fix_sync_ms = 2000;
+    report_policy_t p;
+    report_policy_init(&p, &cfg);
+    report_inputs_t in = fix_at(0, 0, 0);
+    CHECK(step(&p, &in, 0) == REPORT_REASON_FIRST_FIX);
+
+    // A fix just before the deadline is taken ...
+    CHECK(step(&p, &in, MIN_MS - 2001) == REPORT_REASON_NONE);
+    CHECK(step(&p, &in, MIN_MS - 2000) == REPORT_REASON_HEARTBEAT);
+
+    // ... and without one the heartbeat waits fix_sync_ms past it
+    report_inputs_t stale = in;
+    stale.new_fix = false;
+    const uint32_t t0 = MIN_MS - 2000;
+    const uint32_t interval = 2 * MIN_MS;
+    CHECK(step(&p, &stale, t0 + interval) == REPORT_REASON_NONE);
+    CHECK(step(&p, &stale, t0 + interval + 1999) == REPORT_REASON_NONE);
+    CHECK(step(&p, &stale, t0 + interval + 2000) == REPORT_REASON_HEARTBEAT);
+
+    // Movement reports may also come early
+    in = fix_at(60, 0, WALKING);
+    const uint32_t t1 = t0 + interval + 2000;
+    CHECK(step(&p, &in, t1 + MIN_MS - 2000) == REPORT_REASON_MOVED);
+}
+
+int main(void) {
+    test_start();
+    test_moved();
+    test_turned();
+    test_backoff();
+    test_fix_sync();
+    printf("report_policy_test: %d failures\n", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * Tests for the GPS warm standby policy (standby_policy).
+ *
+ *   standby_policy_test
+ *
+ * Steps the policy with explicit time (seconds) through the warm-up after
+ * arming, sessions ended by a fix, by the session limit and by an alarm,
+ * activity inside and past the gap, a spent daily budget and the day
+ * rollover that restores it, and checks the refresh time the deep sleep
+ * timer is given at each point.
+ */
+
+#include <stdio.h>
+#include "standby_policy.h"
+
+static int s_failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); s_failures++; } \
+} while (0)
+
+#define DAY_S       86400u
+#define REFRESH_S   3600
+#define GAP_S       900
+#define AFTER_FIX_S 30
+#define MAX_S       120
+#define BUDGET_S    300
+#define T0          1000000u
+
+static const standby_config_t s_cfg = {
+    .refresh_s = REFRESH_S,
+    .activity_gap_s = GAP_S,
+    .after_fix_s = AFTER_FIX_S,
+    .session_max_s = MAX_S,
+    .budget_s = BUDGET_S,
+};
+
+enum { IN_ARMED = 1, IN_ALARM = 2, IN_ACTIVITY = 4, IN_FIX = 8 };
+
+static bool step(standby_policy_t *p, unsigned flags, uint32_t now_s) {
+    const standby_inputs_t in = {
+        .armed = flags & IN_ARMED,
+        .in_alarm = flags & IN_ALARM,
+        .activity = flags & IN_ACTIVITY,
+        .fix = flags & IN_FIX,
+    };
+    return standby_policy_step(p, &in, now_s);
+}
+
+// Armed, idle steps every second from t up to end (exclusive); returns the
+// step at which the session ended, 0 if it did not
+static uint32_t run_until_off(standby_policy_t *p, uint32_t t, uint32_t end) {
+    for (; t < end; t++) {
+        if (!step(p, IN_ARMED, t)) return t;
+    }
+    return 0;
+}
+
+static void test_warm_up(void) {
+    standby_policy_t p;
+    standby_policy_init(&p, &s_cfg, T0);
+    CHECK(standby_policy_next_refresh_s(&p, T0) == 0);
+
+    // Disarmed: nothing, whatever the age
+    CHECK(!step(&p, 0, T0));
+    CHECK(!step(&p, IN_ACTIVITY, T0 + 1));
+
+    // Nothing known counts as stale: the first armed step refreshes
+    CHECK(step(&p, IN_ARMED, T0 + 10));
+    CHECK(p.reason == STANDBY_REASON_REFRESH);
+    CHECK(p.sessions == 1);
+
+    // Fix at +20, kept on for AFTER_FIX_S to collect the ephemeris
+    CHECK(step(&p, IN_ARMED | IN_FIX, T0 + 20));
+    CHECK(step(&p, IN_ARMED, T0 + 20 + AFTER_FIX_S - 1));
+    CHECK(!step(&p, IN_ARMED, T0 + 20 + AFTER_FIX_S));
+    CHECK(p.session_fix);
+    CHECK(p.used_s == 20 + AFTER_FIX_S - 10);
+
+    // Next refresh counts from the end of the session
+    uint32_t end = T0 + 20 + AFTER_FIX_S;
+    CHECK(standby_policy_next_refresh_s(&p, end) == REFRESH_S);
+    CHECK(standby_policy_next_refresh_s(&p, end + 100) == REFRESH_S - 100);
+    CHECK(!step(&p, IN_ARMED, end + REFRESH_S - 1));
+    CHECK(step(&p, IN_ARMED, end + REFRESH_S));
+    CHECK(p.reason == STANDBY_REASON_REFRESH);
+    CHECK(standby_policy_next_refresh_s(&p, end + REFRESH_S + 5) == 0);
+}
+
+static void test_session_limit(void) {
+    standby_policy_t p;
+    standby_policy_init(&p, &s_cfg, T0);
+    CHECK(step(&p, IN_ARMED, T0));
+    CHECK(run_until_off(&p, T0 + 1, T0 + 2 * MAX_S) == T0 + MAX_S);
+    CHECK(!p.session_fix);
+    CHECK(p.used_s == MAX_S);
+    CHECK(standby_policy_budget_left_s(&p) == BUDGET_S - MAX_S);
+}
+
+static void test_alarm_and_disarm(void) {
+    standby_policy_t p;
+    standby_policy_init(&p, &s_cfg, T0);
+    CHECK(step(&p, IN_ARMED, T0));
+    CHECK(!step(&p, IN_ARMED | IN_ALARM, T0 + 5));
+    CHECK(!p.on);
+
+    // No sessions during an alarm, fixes still age the refresh
+    CHECK(!step(&p, IN_ARMED | IN_ALARM | IN_FIX, T0 + 2 * REFRESH_S));
+    CHECK(standby_policy_next_refresh_s(&p, T0 + 2 * REFRESH_S) == REFRESH_S);
+
+    CHECK(step(&p, IN_ARMED, T0 + 4 * REFRESH_S));
+    CHECK(!step(&p, 0, T0 + 4 * REFRESH_S + 1));
+}
+
+static void test_activity_gap(void) {
+    standby_policy_t p;
+    standby_policy_init(&p, &s_cfg, T0);
+    CHECK(!step(&p, IN_ARMED | IN_ALARM | IN_FIX, T0));
+
+    // Inside the gap the last fix is fresh enough
+    CHECK(!step(&p, IN_ARMED | IN_ACTIVITY, T0 + GAP_S - 1));
+    CHECK(p.denied == 0);
+    CHECK(step(&p, IN_ARMED | IN_ACTIVITY, T0 + GAP_S));
+    CHECK(p.reason == STANDBY_REASON_ACTIVITY);
+    CHECK(step(&p, IN_ARMED | IN_FIX, T0 + GAP_S + 3));
+    CHECK(run_until_off(&p, T0 + GAP_S + 4, T0 + GAP_S + MAX_S) == T0 + GAP_S + 3 + AFTER_FIX_S);
+
+    // The gap counts from the end of that session
+    uint32_t end = T0 + GAP_S + 3 + AFTER_FIX_S;
+    CHECK(!step(&p, IN_ARMED | IN_ACTIVITY, end + GAP_S - 1));
+    CHECK(step(&p, IN_ARMED | IN_ACTIVITY, end + GAP_S));
+}
+
+static void test_budget_and_rollover(void) {
+    standby_policy_t p;
+    standby_policy_init(&p, &s_cfg, T0);
+
+    // Sessions without a fix until the budget is spent
+    uint32_t t = T0;
+    int sessions = 0;
+    while (standby_policy_budget_left_s(&p) > 0 && sessions < 10) {
+        t += GAP_S;
+        CHECK(step(&p, IN_ARMED | IN_ACTIVITY, t));
+        uint32_t off = run_until_off(&p, t + 1, t + 2 * MAX_S);
+        CHECK(off != 0);
+        t = off;
+        sessions++;
+    }
+    // 120 + 120 + 60: the last one is cut short by the budget
+    CHECK(sessions == 3);
+    CHECK(p.used_s == BUDGET_S);
+    CHECK(t == T0 + 3 * GAP_S + BUDGET_S);
+
+    // Spent: activity is refused and counted, refresh waits for the new day
+    CHECK(!step(&p, IN_ARMED | IN_ACTIVITY, t + GAP_S));
+    CHECK(p.denied == 1);
+    CHECK(!step(&p, IN_ARMED, t + REFRESH_S));
+    CHECK(p.denied == 1);
+    CHECK(standby_policy_next_refresh_s(&p, t + REFRESH_S) == T0 + DAY_S - (t + REFRESH_S));
+
+    // The day rolls over: budget back, the overdue refresh runs
+    CHECK(!step(&p, IN_ARMED, T0 + DAY_S - 1));
+    CHECK(step(&p, IN_ARMED, T0 + DAY_S));
+    CHECK(p.reason == STANDBY_REASON_REFRESH);
+    CHECK(p.day_start_s == T0 + DAY_S);
+    CHECK(p.used_s == 0);
+    CHECK(standby_policy_budget_left_s(&p) == BUDGET_S);
+}
+
+static void test_no_refresh(void) {
+    standby_config_t cfg = s_cfg;
+    cfg.refresh_s = 0;
+    standby_policy_t p;
+    standby_policy_init(&p, &cfg, T0);
+    CHECK(standby_policy_next_refresh_s(&p, T0) == UINT32_MAX);
+
+    // Only activity starts sessions
+    CHECK(!step(&p, IN_ARMED, T0 + DAY_S / 2));
+    CHECK(step(&p, IN_ARMED | IN_ACTIVITY, T0 + DAY_S / 2 + 1));
+    CHECK(p.reason == STANDBY_REASON_ACTIVITY);
+}
+
+int main(void) {
+    test_warm_up();
+    test_session_limit();
+    test_alarm_and_disarm();
+    test_activity_gap();
+    test_budget_and_rollover();
+    test_no_refresh();
+    printf("standby_policy_test: %d failures\n", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,289 @@
+/*
+ * Tests for the alarm track buffer.
+ *
+ *   track_test
+ *
+ * Replays a ride sampled every 5 s (east, a right-angle turn north, then
+ * parked with jitter) and checks that the simplified track stays within
+ * tolerance of every fix, that batches round-trip through track_decode at
+ * full and quantized precision, that frame-sized batches drain the ring
+ * oldest first, that a backlog left by failed sends goes out complete and
+ * in order, and that a full ring overwrites its oldest points. Prints
+ * the LoRa payload per point against the JSON position frame.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "track_buffer.h"
+
+static int s_failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); s_failures++; } \
+} while (0)
+
+#define RIDE_LEN    60
+#define LAT0        500619835
+#define LON0        199383018
+#define E7_PER_M    (1.0 / 0.0111195)
+
+static track_point_t s_ride[RIDE_LEN];
+
+// Deterministic +-amp metres of noise
+static double noise(unsigned *seed, double amp) {
+    *seed = *seed * 1103515245u + 12345u;
+    return ((double)((*seed >> 16) & 0x7FFF) / 0x7FFF * 2.0 - 1.0) * amp;
+}
+
+static void build_ride(void) {
+    const double coslat = cos(LAT0 * 1e-7 * M_PI / 180.0);
+    unsigned seed = 1;
+    double east = 0, north = 0;
+    for (int i = 0; i < RIDE_LEN; i++) {
+        if (i < 20) east += 25.0;               // 5 m/s
+        else if (i < 40) north += 25.0;
+        double jitter = i < 40 ? 2.0 : 3.0;     // Parked: only noise
+        s_ride[i].lat_e7 = LAT0 + (int32_t)lround((north + noise(&seed, jitter)) * E7_PER_M);
+        s_ride[i].lon_e7 = LON0 + (int32_t)lround((east + noise(&seed, jitter)) * E7_PER_M / coslat);
+        s_ride[i].t_s = 1000 + 5u * (unsigned)i;
+    }
+}
+
+static double dist_m(const track_point_t *a, const track_point_t *b, double *x, double *y) {
+    const double coslat = cos(a->lat_e7 * 1e-7 * M_PI / 180.0);
+    *x = (b->lon_e7 - a->lon_e7) / E7_PER_M * coslat;
+    *y = (b->lat_e7 - a->lat_e7) / E7_PER_M;
+    return hypot(*x, *y);
+}
+
+static double polyline_dist_m(const track_point_t *poly, int n, const track_point_t *q) {
+    double best = 1e9;
+    for (int i = 0; i + 1 < n; i++) {
+        double bx, by, qx, qy;
+        double len = dist_m(&poly[i], &poly[i + 1], &bx, &by);
+        dist_m(&poly[i], q, &qx, &qy);
+        double u = len > 0 ? (qx * bx + qy * by) / (len * len) : 0;
+        u = u < 0 ? 0 : (u > 1 ? 1 : u);
+        double d = hypot(qx - u * bx, qy - u * by);
+        if (d < best) best = d;
+    }
+    return best;
+}
+
+static void test_filter(void) {
+    track_point_t storage[64];
+    track_t t;
+    track_init(&t, storage, 64, 10, 15);
+    for (int i = 0; i < RIDE_LEN; i++) track_add(&t, &s_ride[i]);
+    track_flush(&t, NULL);
+
+    // Newest first, as sent
+    track_point_t kept[64];
+    uint8_t frame[512];
+    uint16_t points;
+    size_t len = track_encode(&t, 2000, 1, frame, sizeof(frame), &points);
+    int n = track_decode(frame, len, kept, 64);
+    CHECK(n == t.count && n == points);
+    printf("filter: %d fixes -> %d kept (jitter %lu, simplified %lu)\n", RIDE_LEN, n,
+           (unsigned long)t.jitter, (unsigned long)t.simplified);
+    CHECK(n >= 3 && n <= 6);
+    CHECK(t.added == RIDE_LEN);
+    CHECK(t.jitter >= 15);
+
+    // Every fix within tolerance (+ jitter radius) of the kept line
+    double worst = 0;
+    for (int i = 0; i < RIDE_LEN; i++) {
+        double d = polyline_dist_m(kept, n, &s_ride[i]);
+        if (d > worst) worst = d;
+    }
+    printf("filter: worst fix %.1f m from the kept track\n", worst);
+    CHECK(worst <= 15.0 + 10.0);
+
+    // First fix and the corner survive
+    double x, y;
+    CHECK(dist_m(&kept[n - 1], &s_ride[0], &x, &y) < 1.0);
+    double corner = 1e9;
+    for (int i = 0; i < n; i++) {
+        double d = dist_m(&kept[i], &s_ride[19], &x, &y);
+        if (d < corner) corner = d;
+    }
+    CHECK(corner < 30.0);
+}
+
+static void test_round_trip(void) {
+    track_point_t storage[RIDE_LEN];
+    track_t t;
+    track_init(&t, storage, RIDE_LEN, 0, 0);
+    for (int i = 0; i < RIDE_LEN; i++) track_add(&t, &s_ride[i]);
+    track_flush(&t, NULL);
+    CHECK(t.count == RIDE_LEN);     // No filtering with zero thresholds
+
+    const uint16_t quant[] = {1, 10, 100};
+    for (size_t k = 0; k < sizeof(quant) / sizeof(quant[0]); k++) {
+        uint8_t frame[1024];
+        track_point_t out[RIDE_LEN];
+        uint16_t points;
+        const uint32_t now = s_ride[RIDE_LEN - 1].t_s + 7;
+        size_t len = track_encode(&t, now, quant[k], frame, sizeof(frame), &points);
+        CHECK(points == RIDE_LEN);
+        CHECK(track_decode(frame, len, out, RIDE_LEN) == RIDE_LEN);
+        CHECK(track_decode(frame, len - 1, out, RIDE_LEN) == -1);
+        CHECK(track_decode(frame, len, out, RIDE_LEN - 1) == -1);
+
+        int32_t worst = 0;
+        for (int i = 0; i < RIDE_LEN; i++) {
+            const track_point_t *want = &s_ride[RIDE_LEN - 1 - i];
+            int32_t dlat = abs(out[i].lat_e7 - want->lat_e7);
+            int32_t dlon = abs(out[i].lon_e7 - want->lon_e7);
+            if (dlat > worst) worst = dlat;
+            if (dlon > worst) worst = dlon;
+            CHECK(out[i].t_s == now - want->t_s);
+        }
+        CHECK(worst <= quant[k] / 2);
+        CHECK(out[0].lat_e7 == s_ride[RIDE_LEN - 1].lat_e7);
+        printf("quant %3u: %zu B for %d points, %.2f B/point, max error %ld (1e-7 deg)\n",
+               quant[k], len, RIDE_LEN, (double)len / RIDE_LEN, (long)worst);
+    }
+}
+
+static void test_frames(void) {
+    track_point_t storage[RIDE_LEN];
+    track_t t;
+    track_init(&t, storage, RIDE_LEN, 0, 0);
+    for (int i = 0; i < RIDE_LEN; i++) track_add(&t, &s_ride[i]);
+    track_flush(&t, NULL);
+
+    // 48-byte frames drain the ring oldest first without losing a point;
+    // each one decodes newest first
+    int next = 0, frames = 0;
+    while (track_count(&t) > 0 && frames < RIDE_LEN) {
+        uint8_t frame[48];
+        track_point_t out[RIDE_LEN];
+        uint16_t points;
+        size_t len = track_encode(&t, 2000, 10, frame, sizeof(frame), &points);
+        CHECK(len > 0 && len <= sizeof(frame) && points > 0);
+        CHECK(track_decode(frame, len, out, RIDE_LEN) == points);
+        CHECK(next + points <= RIDE_LEN);
+        for (int i = 0; i < points && next + points - 1 - i < RIDE_LEN; i++) {
+            CHECK(abs(out[i].lat_e7 - s_ride[next + points - 1 - i].lat_e7) <= 5);
+        }
+        next += points;
+        track_consume(&t, points);
+        frames++;
+    }
+    CHECK(next == RIDE_LEN);
+    printf("frames: %d points in %d frames of <= 48 B\n", RIDE_LEN, frames);
+
+    uint8_t small[8];
+    uint16_t points;
+    track_add(&t, &s_ride[0]);
+    CHECK(track_encode(&t, 2000, 10, small, sizeof(small), &points) == 0 && points == 0);
+}
+
+// Report periods of 30 s (6 fixes) with up to FRAMES_PER_REPORT frames each,
+// the way alarm_runner sends; the link is down for periods 1-4
+static void test_backlog(void) {
+    enum { PERIOD_FIXES = 6, FRAMES_PER_REPORT = 4, DOWN_FROM = 1, DOWN_TO = 4 };
+    track_point_t storage[RIDE_LEN];
+    track_t t;
+    track_init(&t, storage, RIDE_LEN, 0, 0);
+
+    int fix = 0, next = 0, period = 0, drained_at = -1;
+    for (; period < 3 * RIDE_LEN / PERIOD_FIXES && (fix < RIDE_LEN || track_count(&t) > 0); period++) {
+        for (int k = 0; k < PERIOD_FIXES && fix < RIDE_LEN; k++) track_add(&t, &s_ride[fix++]);
+        track_flush(&t, NULL);
+        const bool link_up = period < DOWN_FROM || period > DOWN_TO;
+        const uint32_t now = s_ride[fix - 1].t_s;
+
+        for (int f = 0; f < FRAMES_PER_REPORT && track_count(&t) > 0; f++) {
+            uint8_t frame[48];
+            track_point_t out[RIDE_LEN];
+            uint16_t points;
+            size_t len = track_encode(&t, now, 10, frame, sizeof(frame), &points);
+            CHECK(track_decode(frame, len, out, RIDE_LEN) == points);
+
+            // Every frame starts at the oldest point not yet delivered
+            CHECK(points > 0 && next + points <= RIDE_LEN);
+            if (points == 0 || next + points > RIDE_LEN) break;
+            CHECK(abs(out[points - 1].lat_e7 - s_ride[next].lat_e7) <= 5);
+            CHECK(out[points - 1].t_s == now - s_ride[next].t_s);
+
+            if (!link_up) break;        // The runner stops at the first failed send
+            track_consume(&t, points);
+            next += points;
+        }
+        if (period == DOWN_TO) CHECK(track_count(&t) == (DOWN_TO - DOWN_FROM + 1) * PERIOD_FIXES);
+        if (drained_at < 0 && link_up && period > DOWN_TO && next == fix) drained_at = period;
+    }
+    CHECK(next == RIDE_LEN);
+    CHECK(t.dropped == 0);
+    CHECK(drained_at >= 0 && drained_at <= DOWN_TO + 2);
+    printf("backlog: link down for %d periods, caught up %d period(s) after it came back\n",
+           DOWN_TO - DOWN_FROM + 1, drained_at - DOWN_TO);
+}
+
+static void test_overflow(void) {
+    track_point_t storage[4];
+    track_t t;
+    track_init(&t, storage, 4, 10, 15);
+    // Zig-zag far apart: every fix is a corner and is kept
+    for (int i = 0; i < 10; i++) {
+        track_point_t p = {LAT0 + (i & 1) * 100000, LON0 + i * 100000, (uint32_t)i};
+        track_add(&t, &p);
+    }
+    track_flush(&t, NULL);
+    CHECK(t.count == 4);
+    CHECK(t.dropped == 6);
+
+    uint8_t frame[128];
+    track_point_t out[4];
+    uint16_t points;
+    size_t len = track_encode(&t, 9, 1, frame, sizeof(frame), &points);
+    CHECK(track_decode(frame, len, out, 4) == 4);
+    CHECK(out[0].lon_e7 == LON0 + 900000 && out[3].lon_e7 == LON0 + 600000);
+
+    // Everything sent and the bike parked: a report still gets the position
+    track_consume(&t, points);
+    const track_point_t parked = {LAT0, LON0, 20};
+    CHECK(!track_add(&t, &(track_point_t){LAT0 + 100000, LON0 + 900000, 19}));
+    track_flush(&t, &parked);
+    CHECK(track_count(&t) == 1);
+    track_flush(&t, NULL);
+    CHECK(track_count(&t) == 1);
+
+    track_reset(&t);
+    CHECK(track_count(&t) == 0);
+}
+
+// The frame alarm_runner sent per position before the track buffer
+static void report_airtime(void) {
+    char json[128];
+    int json_len = snprintf(json, sizeof(json), "{\"lat\":%.7f,\"lon\":%.7f,\"sats\":%d}",
+                            s_ride[0].lat_e7 / 1e7, s_ride[0].lon_e7 / 1e7, 8);
+
+    track_point_t storage[RIDE_LEN];
+    track_t t;
+    track_init(&t, storage, RIDE_LEN, 0, 0);
+    for (int i = 0; i < 6; i++) track_add(&t, &s_ride[i * 5]);   // 30 s of 5 s samples
+    track_flush(&t, NULL);
+    uint8_t frame[48];
+    uint16_t points;
+    size_t len = track_encode(&t, s_ride[25].t_s, 10, frame, sizeof(frame), &points);
+
+    printf("airtime: JSON %d chars for 1 point; batch %zu B = %zu hex chars for %u points (%.1f chars/point)\n",
+           json_len, len, 2 * len, points, 2.0 * len / points);
+}
+
+int main(void) {
+    build_ride();
+    test_filter();
+    test_round_trip();
+    test_frames();
+    test_backlog();
+    test_overflow();
+    report_airtime();
+    printf("track_test: %d failures\n", s_failures);
+    return s_failures ? 1 : 0;
+}
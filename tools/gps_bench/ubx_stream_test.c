@@ -0,0 +1,144 @@
+/*
+ * Tests for the UBX parser and the NMEA/UBX stream demultiplexer.
+ *
+ *   ubx_stream_test
+ *
+ * Builds a stream of NMEA sentences interleaved with UBX frames (payloads
+ * containing '$' and '*', a frame cutting a sentence off, a corrupted frame,
+ * a frame longer than the decode buffer) and checks that every block split
+ * yields the same verified messages and statistics.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "gps_stream.h"
+
+static int s_failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); s_failures++; } \
+} while (0)
+
+#define MAX_EVENTS 32
+
+typedef struct {
+    int count;
+    char kind[MAX_EVENTS];      // 'N' or 'U'
+    int type[MAX_EVENTS];
+    int32_t value[MAX_EVENTS];  // Latitude, ACK id or 0
+} events_t;
+
+static void on_message(void *ctx, const gps_stream_t *s, nmea_type_t nmea, ubx_type_t ubx) {
+    events_t *e = ctx;
+    if (e->count >= MAX_EVENTS) return;
+    int i = e->count++;
+    e->kind[i] = nmea != NMEA_NONE ? 'N' : 'U';
+    e->type[i] = nmea != NMEA_NONE ? (int)nmea : (int)ubx;
+    e->value[i] = 0;
+    if (nmea == NMEA_GGA) e->value[i] = s->nmea.s.gga.lat_e7;
+    if (ubx == UBX_POSLLH) e->value[i] = s->ubx.m.posllh.lat_e7;
+    if (ubx == UBX_ACK || ubx == UBX_NAK) e->value[i] = s->ubx.m.ack.id;
+}
+
+static size_t append(uint8_t *buf, size_t pos, const void *data, size_t len) {
+    memcpy(buf + pos, data, len);
+    return pos + len;
+}
+
+static void put_u32(uint8_t *b, uint32_t v) {
+    b[0] = (uint8_t)v; b[1] = (uint8_t)(v >> 8); b[2] = (uint8_t)(v >> 16); b[3] = (uint8_t)(v >> 24);
+}
+
+static const char GGA[] =
+    "$GPGGA,081838.00,5003.71901,N,01956.29811,E,1,08,0.98,220.1,M,39.8,M,,*5C\r\n";
+
+static size_t build_stream(uint8_t *buf, size_t cap) {
+    size_t n = 0;
+    uint8_t payload[160];
+
+    // Sentence, then NAV-POSLLH with '$' and '*' bytes in its payload
+    n = append(buf, n, GGA, strlen(GGA));
+    memset(payload, '$', 28);
+    put_u32(payload + 8, 500619835);
+    payload[20] = '*';
+    n += ubx_frame_encode(UBX_CLASS_NAV, UBX_NAV_POSLLH, payload, 28, buf + n, cap - n);
+
+    // A frame cutting a sentence off: the sentence is dropped, the frame kept
+    n = append(buf, n, GGA, 30);
+    uint8_t ack[2] = {UBX_CLASS_CFG, 0x01};
+    n += ubx_frame_encode(UBX_CLASS_ACK, UBX_ACK_ACK, ack, sizeof(ack), buf + n, cap - n);
+    n = append(buf, n, "\r\n", 2);
+
+    // Corrupted frame (checksum), then a frame too long to decode
+    size_t bad = n;
+    n += ubx_frame_encode(UBX_CLASS_NAV, UBX_NAV_SOL, payload, 52, buf + n, cap - n);
+    buf[bad + 20] ^= 0x40;
+    memset(payload, 0x55, sizeof(payload));
+    n += ubx_frame_encode(0x0A, 0x04, payload, sizeof(payload), buf + n, cap - n);
+
+    // False sync in text, ACK-NAK with a wrong length, then a sentence
+    n = append(buf, n, "\xB5\x00", 2);
+    n += ubx_frame_encode(UBX_CLASS_ACK, UBX_ACK_NAK, ack, 1, buf + n, cap - n);
+    ack[1] = 0x08;
+    n += ubx_frame_encode(UBX_CLASS_ACK, UBX_ACK_NAK, ack, sizeof(ack), buf + n, cap - n);
+    n = append(buf, n, GGA, strlen(GGA));
+    return n;
+}
+
+static void check_events(const events_t *e, const gps_stream_t *s, size_t chunk) {
+    static const char kind[] = {'N', 'U', 'U', 'U', 'U', 'U', 'N'};
+    static const int type[] = {NMEA_GGA, UBX_POSLLH, UBX_ACK, UBX_OTHER, UBX_OTHER, UBX_NAK, NMEA_GGA};
+    static const int32_t value[] = {500619835, 500619835, 0x01, 0, 0, 0x08, 500619835};
+    const int expected = (int)sizeof(kind);
+
+    if (e->count != expected) {
+        printf("chunk %zu: %d messages, expected %d\n", chunk, e->count, expected);
+        s_failures++;
+        return;
+    }
+    for (int i = 0; i < expected; i++) {
+        if (e->kind[i] != kind[i] || e->type[i] != type[i] || e->value[i] != value[i]) {
+            printf("chunk %zu: message %d is %c%d (%ld), expected %c%d (%ld)\n", chunk, i,
+                   e->kind[i], e->type[i], (long)e->value[i], kind[i], type[i], (long)value[i]);
+            s_failures++;
+        }
+    }
+    CHECK(s->ubx.stats.frames == 5);
+    CHECK(s->ubx.stats.checksum_errors == 1);
+    CHECK(s->ubx.stats.overflows == 1);
+    CHECK(s->ubx.stats.bad_length == 1);
+    CHECK(s->nmea.stats.sentences == 2);
+    CHECK(s->nmea.stats.malformed == 1);
+}
+
+static void test_stream_splits(void) {
+    uint8_t stream[1024];
+    size_t len = build_stream(stream, sizeof(stream));
+
+    for (size_t chunk = 1; chunk <= len; chunk = chunk < 16 ? chunk + 1 : chunk * 2) {
+        gps_stream_t s;
+        events_t e = {0};
+        gps_stream_init(&s);
+        for (size_t i = 0; i < len; i += chunk) {
+            gps_stream_feed(&s, stream + i, len - i < chunk ? len - i : chunk, on_message, &e);
+        }
+        check_events(&e, &s, chunk);
+    }
+}
+
+static void test_encode(void) {
+    // UBX-CFG-RATE 1 Hz, checksum from the u-blox protocol specification
+    const uint8_t rate[] = {0xE8, 0x03, 0x01, 0x00, 0x01, 0x00};
+    const uint8_t want[] = {0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0xE8, 0x03, 0x01, 0x00, 0x01, 0x00, 0x01, 0x39};
+    uint8_t out[32];
+    CHECK(ubx_frame_encode(UBX_CLASS_CFG, 0x08, rate, sizeof(rate), out, sizeof(out)) == sizeof(want));
+    CHECK(memcmp(out, want, sizeof(want)) == 0);
+    CHECK(ubx_frame_encode(UBX_CLASS_CFG, 0x08, rate, sizeof(rate), out, sizeof(want) - 1) == 0);
+}
+
+int main(void) {
+    test_encode();
+    test_stream_splits();
+    printf("ubx_stream_test: %d failures\n", s_failures);
+    return s_failures ? 1 : 0;
+}
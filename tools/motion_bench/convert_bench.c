@@ -0,0 +1,153 @@
+/*
+ * Host microbenchmark for the MPU-6050 conversion kernels.
+ *
+ *   convert_bench [samples] [rounds]
+ *
+ * Converts the same array of raw samples with the previous per-sample
+ * division (kept here as the baseline), with mpu6050_convert_float() and
+ * with mpu6050_convert_q16(), and prints the best round per kernel in ns
+ * and, on x86, TSC cycles per sample. The results are compared against the
+ * baseline so that a faster kernel cannot hide a wrong one.
+ *
+ * Host numbers only rank the kernels. On x86 the compiler vectorises the
+ * divides; the ESP32 FPU has no divide instruction, so there the baseline
+ * calls a software routine per axis.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mpu6050_convert.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+#define ACCEL_LSB_PER_G   (8192.0f)     // +/- 4 g, as armed
+#define GYRO_LSB_PER_DPS  (131.0f)
+
+typedef struct {
+    double ns;
+    double cycles;
+} cost_t;
+
+// --- Baseline: the previous mpu6050_get_data() arithmetic ---
+
+__attribute__((noinline))
+static void convert_div(float accel_scale, float gyro_scale, const mpu6050_offsets_t *o,
+                        const mpu6050_raw_sample_t *in, mpu6050_data_t *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i].ax = (in[i].ax - o->accel_x) / accel_scale;
+        out[i].ay = (in[i].ay - o->accel_y) / accel_scale;
+        out[i].az = (in[i].az - o->accel_z) / accel_scale;
+        out[i].gx = (in[i].gx - o->gyro_x) / gyro_scale;
+        out[i].gy = (in[i].gy - o->gyro_y) / gyro_scale;
+        out[i].gz = (in[i].gz - o->gyro_z) / gyro_scale;
+        out[i].temp = (in[i].temp / 340.0f) + 36.53f;
+    }
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t tsc(void) {
+#if HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Sensor-like values: gravity on Z, small motion and noise elsewhere
+static void fill(mpu6050_raw_sample_t *in, size_t n) {
+    srand(1);
+    for (size_t i = 0; i < n; i++) {
+        in[i].ax = (int16_t)(rand() % 2001 - 1000);
+        in[i].ay = (int16_t)(rand() % 2001 - 1000);
+        in[i].az = (int16_t)(8192 + rand() % 2001 - 1000);
+        in[i].gx = (int16_t)(rand() % 4001 - 2000);
+        in[i].gy = (int16_t)(rand() % 4001 - 2000);
+        in[i].gz = (int16_t)(rand() % 4001 - 2000);
+        in[i].temp = (int16_t)(rand() % 3401 - 5000);
+    }
+}
+
+#define MEASURE(best, call) do { \
+    for (int r_ = 0; r_ < rounds; r_++) { \
+        double t0_ = now_ns(); \
+        uint64_t c0_ = tsc(); \
+        call; \
+        uint64_t c1_ = tsc(); \
+        double t1_ = now_ns(); \
+        double ns_ = (t1_ - t0_) / n, cyc_ = (double)(c1_ - c0_) / n; \
+        if (r_ == 0 || ns_ < (best).ns) { (best).ns = ns_; (best).cycles = cyc_; } \
+    } \
+} while (0)
+
+static void print_cost(const char *name, cost_t c, cost_t base) {
+    if (HAVE_TSC) {
+        printf("%-18s %7.2f ns/sample  %7.2f cycles/sample  %5.2fx\n", name, c.ns, c.cycles, base.ns / c.ns);
+    } else {
+        printf("%-18s %7.2f ns/sample  %5.2fx\n", name, c.ns, base.ns / c.ns);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 4096;
+    int rounds = argc > 2 ? atoi(argv[2]) : 2000;
+    if (n == 0 || rounds <= 0) {
+        fprintf(stderr, "usage: %s [samples] [rounds]\n", argv[0]);
+        return 2;
+    }
+
+    mpu6050_raw_sample_t *in = malloc(n * sizeof(*in));
+    mpu6050_data_t *out_div = malloc(n * sizeof(*out_div));
+    mpu6050_data_t *out_float = malloc(n * sizeof(*out_float));
+    mpu6050_fixed_data_t *out_q16 = malloc(n * sizeof(*out_q16));
+    if (!in || !out_div || !out_float || !out_q16) return 1;
+    fill(in, n);
+
+    const mpu6050_offsets_t offsets = {-312, 88, 140, -21, 17, 5};
+    mpu6050_scale_t scale;
+    mpu6050_scale_init(&scale, ACCEL_LSB_PER_G, GYRO_LSB_PER_DPS, &offsets);
+
+    // Scales through volatile, as the firmware read them from globals
+    volatile float accel_scale = ACCEL_LSB_PER_G, gyro_scale = GYRO_LSB_PER_DPS;
+    cost_t c_div = {0}, c_float = {0}, c_q16 = {0};
+    MEASURE(c_div, convert_div(accel_scale, gyro_scale, &offsets, in, out_div, n));
+    MEASURE(c_float, mpu6050_convert_float(&scale, in, out_float, n));
+    MEASURE(c_q16, mpu6050_convert_q16(&scale, in, out_q16, n));
+
+    // Largest deviation from the baseline, in output units
+    double err_float = 0, err_q16 = 0;
+    for (size_t i = 0; i < n; i++) {
+        const float *d = &out_div[i].ax, *f = &out_float[i].ax;
+        const int32_t *q = &out_q16[i].ax;
+        for (int k = 0; k < 6; k++) {
+            err_float = fmax(err_float, fabs(f[k] - d[k]));
+            err_q16 = fmax(err_q16, fabs(q[k] / 65536.0 - d[k]));
+        }
+        err_float = fmax(err_float, fabs(f[6] - d[6]));
+        err_q16 = fmax(err_q16, fabs(q[6] / 100.0 - d[6]));
+    }
+
+    printf("%zu samples, best of %d rounds\n", n, rounds);
+    print_cost("division", c_div, c_div);
+    print_cost("reciprocal float", c_float, c_div);
+    print_cost("Q16 fixed point", c_q16, c_div);
+    printf("max deviation from division: float %.2e, Q16 %.2e (g, deg/s, C)\n", err_float, err_q16);
+
+    free(in);
+    free(out_div);
+    free(out_float);
+    free(out_q16);
+    return 0;
+}
@@ -0,0 +1,7 @@
+#ifndef HOST_DRIVER_GPIO_H
+#define HOST_DRIVER_GPIO_H
+
+// Host stand-in so config.h can be included for its tuning constants.
+// Pin macros are never expanded on the host.
+
+#endif // HOST_DRIVER_GPIO_H
@@ -0,0 +1,703 @@
+/*
+ * Host benchmark of the armed motion detection path.
+ *
+ * Replays a labelled trace corpus through the simulated IMU backend and the
+ * same motion_pipeline the firmware runs, emulating the monitor task's wake
+ * pattern (INT edges, MPU_STATE_CHECK_MS idle ticks, MOTION_DRAIN_MS while
+ * verifying). Profiles are the firmware's named sensing profiles
+ * (mpu_sensing.h) or a custom MOT_THR:MOT_DUR on the default armed one;
+ * profiles without a stream start the verification stream on an interrupt,
+ * as the monitor does. With --sleep the armed device also goes to deep sleep
+ * when power_fsm allows it (POWER_SETTLE_MS without a motion being
+ * verified), parks the sensor in the low-power profile, and only a motion
+ * interrupt wakes it: the firmware then boots for BOOT_MS before the stream
+ * starts and verification begins, as after a motion wake on the target.
+ * For every profile it reports:
+ *   - detection latency percentiles (theft onset -> alarm),
+ *   - false alarms per hour (nuisance traces and theft lead-ins),
+ *   - CPU time per simulated hour (host CPU, firmware-side work only),
+ *     plus wakes and samples per hour, which carry over to the target,
+ *   - with --sleep, the share of time asleep and the sleeps per hour.
+ *
+ * Corpus manifest, one trace per line ('#' comments):
+ *     <trace.csv|trace.bin> <scenario> <onset_ms|-> [range_g]
+ * Paths are relative to the manifest. '-' marks a nuisance trace (no alarm
+ * expected). range_g applies to CSV traces (binary ones carry it).
+ * Without --corpus a synthetic corpus is generated (trace_gen.h).
+ *
+ * Build and run:
+ *     cmake -S tools/motion_bench -B build/motion_bench
+ *     cmake --build build/motion_bench
+ *     build/motion_bench/motion_bench --profiles parked-low-power,parked-sensitive,10:1,40:1:120:1500
+ *     build/motion_bench/motion_bench --profiles parked-low-power,parked-sensitive --sleep 300
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "config.h"
+#include "imu_sim.h"
+#include "motion_pipeline.h"
+#include "mpu_sensing.h"
+#include "power_fsm.h"
+#include "trace_gen.h"
+
+#define MAX_PROFILES   (16)
+#define MAX_SCENARIOS  (16)
+#define BATCH_SAMPLES  (64)      // Same as MPU_RING_SAMPLES in mpu_monitor
+#define ARMED_RANGE_G  (4)       // Range of CSV traces without one in the manifest
+
+typedef struct {
+    char name[32];               // Sensing profile name, or "thr:dur" for a custom threshold
+    imu_config_t armed;          // Backend configuration while armed
+    imu_config_t verify;         // Stream for verifying an interrupt
+    uint16_t rms_mg;
+    uint16_t sustained_ms;
+} profile_t;
+
+typedef struct {
+    char name[32];
+    uint32_t traces;
+    uint32_t thefts;
+    uint32_t detected;
+    uint32_t false_alarms;
+    uint32_t alarms_by_event[MOTION_EVENT_REJECTED + 1];
+    double nuisance_hours;       // Time in which any alarm is a false one
+    double sim_hours;
+    double cpu_ns;
+    uint64_t wakes;
+    uint64_t samples;
+    uint64_t sleeps;
+    double asleep_hours;
+    int64_t *latency_ms;
+    size_t latency_count;
+    size_t latency_capacity;
+} stats_t;
+
+typedef struct {
+    int64_t now_us;
+    bool int_pending;
+} bench_clock_t;
+
+static profile_t s_profiles[MAX_PROFILES];
+static int s_profile_count;
+static stats_t s_stats[MAX_PROFILES][MAX_SCENARIOS];
+static char s_scenarios[MAX_SCENARIOS][32];
+static int s_scenario_count;
+static uint32_t s_rearm_s = 60;
+static int32_t s_boot_ms = -1;   // --sleep: boot time after a motion wake, -1 = never sleeps
+
+static int64_t bench_clock(void *arg) {
+    return ((bench_clock_t *)arg)->now_us;
+}
+
+// Stands in for the monitor's INT callback: marks the task as notified
+static void bench_int(void *arg, bool in_isr) {
+    (void)in_isr;
+    ((bench_clock_t *)arg)->int_pending = true;
+}
+
+static uint32_t bench_ms(const bench_clock_t *clk) {
+    return (uint32_t)(clk->now_us / 1000);
+}
+
+static double cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int scenario_index(const char *name) {
+    for (int i = 0; i < s_scenario_count; i++) {
+        if (strcmp(s_scenarios[i], name) == 0) return i;
+    }
+    if (s_scenario_count == MAX_SCENARIOS) return -1;
+    snprintf(s_scenarios[s_scenario_count], sizeof(s_scenarios[0]), "%s", name);
+    return s_scenario_count++;
+}
+
+static void add_latency(stats_t *st, int64_t ms) {
+    if (st->latency_count == st->latency_capacity) {
+        size_t cap = st->latency_capacity ? st->latency_capacity * 2 : 16;
+        int64_t *p = realloc(st->latency_ms, cap * sizeof(int64_t));
+        if (p == NULL) return;
+        st->latency_ms = p;
+        st->latency_capacity = cap;
+    }
+    st->latency_ms[st->latency_count++] = ms;
+}
+
+static motion_pipeline_config_t pipeline_config(const profile_t *p) {
+    motion_pipeline_config_t cfg = {
+        .rule = {
+            .sample_rate_hz = MOTION_ODR_HZ,
+            .window_samples = MOTION_WINDOW_SAMPLES,
+            .active_mg = MOTION_ACTIVE_MG,
+            .gap_ms = MOTION_GAP_MS,
+            .sustained_ms = p->sustained_ms,
+            .rms_mg = p->rms_mg,
+            .jerk_mg_s = MOTION_JERK_MG_S,
+            .min_variance_mg2 = MOTION_MIN_VARIANCE_MG2,
+        },
+        .tilt = {
+            .threshold_deg = TILT_THRESHOLD_DEG,
+            .accel_weight = TILT_ACCEL_WEIGHT,
+            .accel_gate_g = TILT_ACCEL_GATE_G,
+            .sample_rate_hz = MOTION_ODR_HZ,
+            .settle_samples = TILT_SETTLE_SAMPLES,
+        },
+        .verify_ms = MOTION_VERIFY_MS,
+    };
+    return cfg;
+}
+
+// Applies a backend configuration; the conversion follows its accel range
+static void apply_config(const imu_backend_t *imu, const imu_config_t *cfg, mpu6050_scale_t *scale) {
+    imu_backend_configure(imu, cfg);
+    mpu6050_offsets_t offsets = {0};
+    mpu6050_scale_init(scale, imu_accel_lsb_per_g(cfg->accel_range_g), 131.0f, &offsets);
+}
+
+/*
+ * One armed session over a trace. Alarms disarm the system; it is re-armed
+ * s_rearm_s later (owner dismisses the alarm). A theft trace ends at the
+ * first alarm after its onset. With s_boot_ms >= 0 the power manager's
+ * sleep decision runs every POWER_EVAL_MS while armed.
+ */
+static void run_trace(const imu_trace_sample_t *trace, size_t count, uint8_t range_g,
+                      int64_t onset_ms, const profile_t *prof, stats_t *st) {
+    bench_clock_t clk = {0};
+    imu_sim_t *sim = malloc(sizeof(imu_sim_t));
+    if (sim == NULL || count < 2) {
+        free(sim);
+        return;
+    }
+    imu_sim_config_t sim_cfg = {
+        .trace = trace,
+        .count = count,
+        .trace_range_g = range_g,
+        .clock = bench_clock,
+        .clock_arg = &clk,
+    };
+    imu_sim_init(sim, &sim_cfg);
+    imu_backend_t imu = imu_sim_backend(sim);
+    imu_backend_init(&imu, bench_int, &clk);
+
+    const imu_config_t disarmed_cfg = mpu_sensing_config(MPU_SENSING_TRANSPORT, false, false);
+    const bool on_demand = prof->armed.stream_odr_hz == 0;
+    mpu6050_scale_t scale;
+
+    const bool sleep_mode = s_boot_ms >= 0;
+    const imu_config_t parked_cfg = mpu_sensing_config(MPU_SENSING_PARKED_LOW_POWER, true, false);
+    const power_fsm_config_t fsm_cfg = {
+        .settle_ms = POWER_SETTLE_MS,
+        .listen_ms = POWER_LISTEN_MS,
+    };
+    power_fsm_t fsm;
+
+    motion_pipeline_config_t pipe_cfg = pipeline_config(prof);
+    motion_pipeline_t pipe;
+    mpu6050_raw_sample_t raw[BATCH_SAMPLES];
+    mpu6050_fixed_data_t fixed[BATCH_SAMPLES];
+
+    int64_t period_us = (int64_t)(trace[1].t_ms - trace[0].t_ms) * 1000;
+    if (period_us <= 0) period_us = 1000;
+    int64_t end_us = (int64_t)(trace[count - 1].t_ms - trace[0].t_ms) * 1000;
+    int64_t onset_us = onset_ms >= 0 ? onset_ms * 1000 : -1;
+
+    bool armed = false;
+    bool streaming = false;
+    bool tilt_capture = false;   // Stream held until the armed orientation is taken
+    int64_t rearm_us = 0;
+    int64_t next_wake_us = 0;
+    int64_t next_eval_us = 0;
+    bool asleep = false;
+    int64_t sleep_start_us = 0;
+    int64_t boot_done_us = -1;   // Woken: the monitor task runs from here
+    bool detected = false;
+    double cpu = 0;
+
+    for (clk.now_us = 0; clk.now_us <= end_us && !detected; clk.now_us += period_us) {
+        imu_sim_advance(sim);
+
+        if (!armed) {
+            if (clk.now_us < rearm_us) continue;
+            double c0 = cpu_ns();
+            // Profiles without a stream run one until the reference is captured
+            apply_config(&imu, on_demand ? &prof->verify : &prof->armed, &scale);
+            uint8_t status;
+            imu_backend_read_int_status(&imu, &status);
+            motion_pipeline_init(&pipe, &pipe_cfg);
+            cpu += cpu_ns() - c0;
+            streaming = true;
+            tilt_capture = true;
+            clk.int_pending = false;
+            armed = true;
+            next_wake_us = clk.now_us + (int64_t)MPU_STATE_CHECK_MS * 1000;
+            power_fsm_init(&fsm, &fsm_cfg, POWER_WAKE_COLD, bench_ms(&clk));
+            next_eval_us = clk.now_us + (int64_t)POWER_EVAL_MS * 1000;
+            continue;
+        }
+
+        if (asleep) {
+            if (boot_done_us < 0) {
+                if (!clk.int_pending) continue;
+                // The INT pin wakes the chip; nothing runs until it has booted
+                boot_done_us = clk.now_us + (int64_t)s_boot_ms * 1000;
+                st->asleep_hours += (clk.now_us - sleep_start_us) / 3.6e9;
+            }
+            if (clk.now_us < boot_done_us) continue;
+
+            // Monitor start after a motion wake: arming cleared the latch,
+            // verification starts with the stream, the tilt reference is kept
+            double c0 = cpu_ns();
+            apply_config(&imu, on_demand ? &prof->verify : &prof->armed, &scale);
+            uint8_t status;
+            imu_backend_read_int_status(&imu, &status);
+            motion_pipeline_restart(&pipe);
+            motion_pipeline_interrupt(&pipe, clk.now_us);
+            cpu += cpu_ns() - c0;
+            st->wakes++;
+            clk.int_pending = false;
+            asleep = false;
+            boot_done_us = -1;
+            streaming = true;
+            next_wake_us = clk.now_us + (int64_t)MOTION_DRAIN_MS * 1000;
+            power_fsm_init(&fsm, &fsm_cfg, POWER_WAKE_MOTION, bench_ms(&clk));
+            next_eval_us = clk.now_us + (int64_t)POWER_EVAL_MS * 1000;
+            continue;
+        }
+
+        if (sleep_mode && clk.now_us >= next_eval_us) {
+            next_eval_us = clk.now_us + (int64_t)POWER_EVAL_MS * 1000;
+            const power_inputs_t in = {
+                .armed = true,
+                .imu_busy = pipe.verifying || tilt_capture,
+            };
+            // Sleep is aborted while an INT is pending, as with the pin high
+            if (power_fsm_step(&fsm, &in, bench_ms(&clk)) && !clk.int_pending) {
+                // mpu_monitor_prepare_sleep: cycled accel, INT latch cleared
+                double c0 = cpu_ns();
+                apply_config(&imu, &parked_cfg, &scale);
+                uint8_t status;
+                imu_backend_read_int_status(&imu, &status);
+                cpu += cpu_ns() - c0;
+                clk.int_pending = false;
+                streaming = false;
+                asleep = true;
+                sleep_start_us = clk.now_us;
+                st->sleeps++;
+                continue;
+            }
+        }
+
+        bool woken_by_int = clk.int_pending;
+        if (!woken_by_int && clk.now_us < next_wake_us) continue;
+        clk.int_pending = false;
+
+        double c0 = cpu_ns();
+        if (woken_by_int) {
+            uint8_t status = 0;
+            imu_backend_read_int_status(&imu, &status);
+            if (status & IMU_INT_STATUS_MOTION) {
+                if (!streaming) {
+                    apply_config(&imu, &prof->verify, &scale);
+                    motion_pipeline_restart(&pipe);
+                    streaming = true;
+                }
+                motion_pipeline_interrupt(&pipe, clk.now_us);
+            }
+        }
+        st->wakes++;
+        if (!streaming) {
+            cpu += cpu_ns() - c0;
+            next_wake_us = clk.now_us + (int64_t)MPU_STATE_CHECK_MS * 1000;
+            continue;
+        }
+
+        uint16_t n = 0;
+        imu_backend_read_batch(&imu, raw, BATCH_SAMPLES, &n);
+        mpu6050_convert_q16(&scale, raw, fixed, n);
+        motion_event_t ev = motion_pipeline_samples(&pipe, fixed, n, clk.now_us);
+
+        // Low-power profiles drop the stream once it is no longer needed
+        bool stream_done = ev == MOTION_EVENT_REJECTED && !tilt_capture;
+        if (ev == MOTION_EVENT_NONE && tilt_capture && pipe.tilt.has_ref && !pipe.verifying) {
+            tilt_capture = false;
+            stream_done = true;
+        }
+        if (stream_done && on_demand) {
+            apply_config(&imu, &prof->armed, &scale);
+            streaming = false;
+        }
+        cpu += cpu_ns() - c0;
+
+        st->samples += n;
+        next_wake_us = clk.now_us + (int64_t)(pipe.verifying ? MOTION_DRAIN_MS : MPU_STATE_CHECK_MS) * 1000;
+
+        if (ev != MOTION_EVENT_ALARM_MOTION && ev != MOTION_EVENT_ALARM_TILT) continue;
+
+        st->alarms_by_event[ev]++;
+        if (onset_us >= 0 && clk.now_us >= onset_us) {
+            detected = true;
+            add_latency(st, (clk.now_us - onset_us) / 1000);
+        } else {
+            st->false_alarms++;
+        }
+        imu_backend_configure(&imu, &disarmed_cfg);
+        armed = false;
+        streaming = false;
+        rearm_us = clk.now_us + (int64_t)s_rearm_s * 1000000;
+    }
+
+    int64_t ran_us = clk.now_us < end_us ? clk.now_us : end_us;
+    if (asleep && boot_done_us < 0) st->asleep_hours += (ran_us - sleep_start_us) / 3.6e9;
+    st->traces++;
+    st->sim_hours += ran_us / 3.6e9;
+    st->nuisance_hours += (onset_us >= 0 ? (onset_us < ran_us ? onset_us : ran_us) : ran_us) / 3.6e9;
+    st->cpu_ns += cpu;
+    if (onset_us >= 0) {
+        st->thefts++;
+        if (detected) st->detected++;
+    }
+    free(sim);
+}
+
+static void run_all_profiles(const char *scenario, const imu_trace_sample_t *trace, size_t count,
+                             uint8_t range_g, int64_t onset_ms) {
+    int si = scenario_index(scenario);
+    if (si < 0) {
+        fprintf(stderr, "Too many scenarios, skipping '%s'\n", scenario);
+        return;
+    }
+    for (int p = 0; p < s_profile_count; p++) {
+        run_trace(trace, count, range_g, onset_ms, &s_profiles[p], &s_stats[p][si]);
+    }
+}
+
+// --- Corpus ---
+
+static int load_trace(const char *path, imu_trace_sample_t **out, size_t *count, uint8_t *range_g) {
+    size_t capacity = 1u << 16;
+    while (1) {
+        imu_trace_sample_t *buf = malloc(capacity * sizeof(*buf));
+        if (buf == NULL) return -1;
+        esp_err_t err = imu_trace_load(path, buf, capacity, count, range_g);
+        if (err == ESP_OK) {
+            *out = buf;
+            return 0;
+        }
+        free(buf);
+        if (err != ESP_ERR_NO_MEM) return -1;
+        capacity *= 2;
+    }
+}
+
+static int run_corpus(const char *manifest) {
+    FILE *f = fopen(manifest, "r");
+    if (f == NULL) {
+        perror(manifest);
+        return -1;
+    }
+
+    char dir[512] = ".";
+    const char *slash = strrchr(manifest, '/');
+    if (slash) snprintf(dir, sizeof(dir), "%.*s", (int)(slash - manifest), manifest);
+
+    char line[640];
+    int traces = 0;
+    while (fgets(line, sizeof(line), f)) {
+        char file[256], scenario[32], onset[32];
+        unsigned range = ARMED_RANGE_G;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%255s %31s %31s %u", file, scenario, onset, &range) < 3) continue;
+
+        char path[800];
+        if (file[0] == '/') snprintf(path, sizeof(path), "%s", file);
+        else snprintf(path, sizeof(path), "%s/%s", dir, file);
+
+        imu_trace_sample_t *trace;
+        size_t count;
+        uint8_t range_g = (uint8_t)range;
+        if (load_trace(path, &trace, &count, &range_g) != 0) {
+            fprintf(stderr, "Cannot load trace %s\n", path);
+            continue;
+        }
+        int64_t onset_ms = strcmp(onset, "-") == 0 ? -1 : atoll(onset);
+        run_all_profiles(scenario, trace, count, range_g, onset_ms);
+        free(trace);
+        traces++;
+    }
+    fclose(f);
+    return traces;
+}
+
+static int save_synth(const char *dir, scenario_t s, uint32_t i, const gen_trace_t *t, FILE *manifest) {
+    char name[64], path[600];
+    snprintf(name, sizeof(name), "%s_%02u.bin", scenario_name(s), i);
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    esp_err_t err = imu_trace_save_bin(f, t->samples, t->count, TRACE_GEN_RANGE_G);
+    fclose(f);
+    if (err != ESP_OK) return -1;
+
+    if (t->onset_ms >= 0) fprintf(manifest, "%s %s %lld\n", name, scenario_name(s), (long long)t->onset_ms);
+    else fprintf(manifest, "%s %s -\n", name, scenario_name(s));
+    return 0;
+}
+
+static int run_synth(uint32_t per_scenario, uint32_t minutes, const char *save_dir) {
+    FILE *manifest = NULL;
+    if (save_dir) {
+        char path[600];
+        snprintf(path, sizeof(path), "%s/corpus.txt", save_dir);
+        manifest = fopen(path, "w");
+        if (manifest == NULL) {
+            perror(path);
+            return -1;
+        }
+        fprintf(manifest, "# Synthetic corpus: <trace> <scenario> <onset_ms|->\n");
+    }
+
+    int traces = 0;
+    for (int s = 0; s < SCENARIO_COUNT; s++) {
+        for (uint32_t i = 0; i < per_scenario; i++) {
+            gen_trace_t t;
+            if (trace_gen((scenario_t)s, (uint32_t)(s * 1000 + i + 1), minutes, &t) != 0) {
+                fprintf(stderr, "Out of memory generating %s\n", scenario_name((scenario_t)s));
+                continue;
+            }
+            if (manifest) save_synth(save_dir, (scenario_t)s, i, &t, manifest);
+            run_all_profiles(scenario_name((scenario_t)s), t.samples, t.count, TRACE_GEN_RANGE_G, t.onset_ms);
+            trace_gen_free(&t);
+            traces++;
+        }
+    }
+    if (manifest) fclose(manifest);
+    return traces;
+}
+
+// --- Report ---
+
+static int cmp_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted array, -1 when empty
+static int64_t percentile(const int64_t *v, size_t n, unsigned pct) {
+    if (n == 0) return -1;
+    size_t rank = (pct * n + 99) / 100;
+    return v[rank ? rank - 1 : 0];
+}
+
+static void merge(stats_t *into, const stats_t *from) {
+    into->traces += from->traces;
+    into->thefts += from->thefts;
+    into->detected += from->detected;
+    into->false_alarms += from->false_alarms;
+    for (int e = 0; e <= MOTION_EVENT_REJECTED; e++) into->alarms_by_event[e] += from->alarms_by_event[e];
+    into->nuisance_hours += from->nuisance_hours;
+    into->sim_hours += from->sim_hours;
+    into->cpu_ns += from->cpu_ns;
+    into->wakes += from->wakes;
+    into->samples += from->samples;
+    into->sleeps += from->sleeps;
+    into->asleep_hours += from->asleep_hours;
+    for (size_t i = 0; i < from->latency_count; i++) add_latency(into, from->latency_ms[i]);
+}
+
+static void print_row(const char *name, stats_t *st, bool csv, const profile_t *p) {
+    qsort(st->latency_ms, st->latency_count, sizeof(int64_t), cmp_i64);
+    int64_t p50 = percentile(st->latency_ms, st->latency_count, 50);
+    int64_t p90 = percentile(st->latency_ms, st->latency_count, 90);
+    int64_t p99 = percentile(st->latency_ms, st->latency_count, 99);
+    int64_t max = st->latency_count ? st->latency_ms[st->latency_count - 1] : -1;
+    double fp_h = st->nuisance_hours > 0 ? st->false_alarms / st->nuisance_hours : 0;
+    double hours = st->sim_hours > 0 ? st->sim_hours : 1;
+    double asleep_pct = 100.0 * st->asleep_hours / hours;
+
+    if (csv) {
+        printf("%s,%u,%u,%u,%u,%s,%u,%.3f,%u,%u,%u,%lld,%lld,%lld,%lld,%.3f,%u,%u,%.3f,%.0f,%.0f,%.1f,%.1f\n",
+               p->name, p->armed.motion_threshold, p->armed.motion_duration, p->rms_mg, p->sustained_ms,
+               name, st->traces, st->sim_hours,
+               st->thefts, st->detected, st->false_alarms, (long long)p50, (long long)p90, (long long)p99,
+               (long long)max, fp_h, st->alarms_by_event[MOTION_EVENT_ALARM_MOTION],
+               st->alarms_by_event[MOTION_EVENT_ALARM_TILT], st->cpu_ns / 1e6 / hours,
+               st->wakes / hours, st->samples / hours, asleep_pct, st->sleeps / hours);
+        return;
+    }
+
+    char detect[16] = "-";
+    char lat[4][24];
+    int64_t lat_v[4] = { p50, p90, p99, max };
+    if (st->thefts) snprintf(detect, sizeof(detect), "%u/%u", st->detected, st->thefts);
+    for (int i = 0; i < 4; i++) {
+        if (lat_v[i] < 0) snprintf(lat[i], sizeof(lat[i]), "-");
+        else snprintf(lat[i], sizeof(lat[i]), "%lld", (long long)lat_v[i]);
+    }
+    printf("  %-12s %6u %7.2f %8s %7s %7s %7s %7s %6u %7.2f %6u %5u %9.2f %8.0f",
+           name, st->traces, st->sim_hours, detect, lat[0], lat[1], lat[2], lat[3],
+           st->false_alarms, fp_h, st->alarms_by_event[MOTION_EVENT_ALARM_MOTION],
+           st->alarms_by_event[MOTION_EVENT_ALARM_TILT], st->cpu_ns / 1e6 / hours, st->wakes / hours);
+    if (s_boot_ms >= 0) printf(" %7.1f %8.1f", asleep_pct, st->sleeps / hours);
+    printf("\n");
+}
+
+static void report(bool csv) {
+    if (csv) {
+        printf("profile,threshold,duration_ms,rms_mg,sustained_ms,scenario,traces,sim_hours,thefts,detected,"
+               "false_alarms,lat_p50_ms,lat_p90_ms,lat_p99_ms,lat_max_ms,fp_per_hour,"
+               "alarms_motion,alarms_tilt,cpu_ms_per_hour,wakes_per_hour,samples_per_hour,"
+               "asleep_pct,sleeps_per_hour\n");
+    }
+
+    for (int p = 0; p < s_profile_count; p++) {
+        const profile_t *prof = &s_profiles[p];
+        if (!csv) {
+            printf("\n== %s: MOT_THR %u (%u mg) MOT_DUR %u ms, %s, rms %u mg, sustained %u ms",
+                   prof->name, prof->armed.motion_threshold, prof->armed.motion_threshold * 2,
+                   prof->armed.motion_duration,
+                   prof->armed.stream_odr_hz ? "streaming" : "stream on INT", prof->rms_mg, prof->sustained_ms);
+            if (s_boot_ms >= 0) printf(", deep sleep (boot %ld ms)", (long)s_boot_ms);
+            printf("\n  %-12s %6s %7s %8s %7s %7s %7s %7s %6s %7s %6s %5s %9s %8s",
+                   "scenario", "traces", "hours", "detect", "p50ms", "p90ms", "p99ms", "maxms",
+                   "FP", "FP/h", "motion", "tilt", "cpu_ms/h", "wakes/h");
+            if (s_boot_ms >= 0) printf(" %7s %8s", "asleep%", "sleeps/h");
+            printf("\n");
+        }
+
+        stats_t all = {0};
+        for (int s = 0; s < s_scenario_count; s++) {
+            merge(&all, &s_stats[p][s]);
+            print_row(s_scenarios[s], &s_stats[p][s], csv, prof);
+        }
+        print_row("all", &all, csv, prof);
+        free(all.latency_ms);
+    }
+    if (!csv) {
+        printf("\ncpu_ms/h is host CPU for the firmware-side work (status reads, drains, conversion,\n"
+               "pipeline); wakes/h and samples/h scale to the target.\n");
+    }
+}
+
+// --- CLI ---
+
+// One --profiles entry: a sensing profile name or thr:dur, either followed
+// by optional :rms_mg[:sustained_ms]
+static int parse_profile(const char *item, profile_t *out) {
+    char name[32];
+    size_t len = strcspn(item, ":");
+    if (len == 0 || len >= sizeof(name)) return -1;
+    memcpy(name, item, len);
+    name[len] = '\0';
+
+    unsigned thr = 0, dur = 0, rms = MOTION_RMS_MG, sus = MOTION_SUSTAINED_MS;
+    if (name[0] >= '0' && name[0] <= '9') {
+        // Custom threshold on the default armed profile, as the
+        // set-threshold command overrides it
+        if (sscanf(item, "%u:%u:%u:%u", &thr, &dur, &rms, &sus) < 2 || thr == 0 || thr > 255 || dur > 255) return -1;
+        out->armed = mpu_sensing_config(MPU_ARMED_SENSING_DEFAULT, true, true);
+        out->armed.motion_threshold = (uint8_t)thr;
+        out->armed.motion_duration = (uint8_t)dur;
+        out->verify = out->armed;
+        snprintf(out->name, sizeof(out->name), "%u:%u", thr, dur);
+    } else {
+        mpu_sensing_id_t id = mpu_sensing_from_name(name);
+        if (id == MPU_SENSING_COUNT) return -1;
+        if (item[len] == ':' && sscanf(item + len + 1, "%u:%u", &rms, &sus) < 1) return -1;
+        out->armed = mpu_sensing_config(id, true, true);
+        out->verify = mpu_sensing_config(mpu_sensing_verify(id), true, true);
+        snprintf(out->name, sizeof(out->name), "%s", name);
+    }
+    out->rms_mg = (uint16_t)rms;
+    out->sustained_ms = (uint16_t)sus;
+    return 0;
+}
+
+static int parse_profiles(const char *list) {
+    s_profile_count = 0;
+    const char *p = list;
+    while (*p && s_profile_count < MAX_PROFILES) {
+        char item[64];
+        size_t len = strcspn(p, ",");
+        if (len >= sizeof(item)) return -1;
+        memcpy(item, p, len);
+        item[len] = '\0';
+        if (parse_profile(item, &s_profiles[s_profile_count]) != 0) return -1;
+        s_profile_count++;
+        p += len;
+        if (*p == ',') p++;
+    }
+    return s_profile_count > 0 ? 0 : -1;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [--corpus manifest.txt | --synth N [--minutes M] [--save-synth DIR]]\n"
+            "          [--profiles name|thr:dur[:rms_mg[:sustained_ms]],...] [--rearm S] [--sleep BOOT_MS] [--csv]\n"
+            "profiles: sensing profile names (parked-low-power, parked-sensitive, transport, ...)\n"
+            "          or MOT_THR:MOT_DUR on %s\n"
+            "--sleep:  deep sleep while armed and idle, BOOT_MS from a motion wake to the stream\n"
+            "defaults: --synth 4 --minutes 30 --profiles %s --rearm 60, no sleep\n",
+            argv0, mpu_sensing_name(MPU_ARMED_SENSING_DEFAULT), mpu_sensing_name(MPU_ARMED_SENSING_DEFAULT));
+}
+
+int main(int argc, char **argv) {
+    const char *corpus = NULL;
+    const char *save_dir = NULL;
+    uint32_t synth = 4;
+    uint32_t minutes = 30;
+    bool csv = false;
+
+    parse_profile(mpu_sensing_name(MPU_ARMED_SENSING_DEFAULT), &s_profiles[0]);
+    s_profile_count = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(a, "--csv") == 0) {
+            csv = true;
+            continue;
+        }
+        if (v == NULL) {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+        if (strcmp(a, "--corpus") == 0) corpus = v;
+        else if (strcmp(a, "--synth") == 0) synth = (uint32_t)atoi(v);
+        else if (strcmp(a, "--minutes") == 0) minutes = (uint32_t)atoi(v);
+        else if (strcmp(a, "--save-synth") == 0) save_dir = v;
+        else if (strcmp(a, "--rearm") == 0) s_rearm_s = (uint32_t)atoi(v);
+        else if (strcmp(a, "--sleep") == 0) s_boot_ms = atoi(v) < 0 ? 0 : atoi(v);
+        else if (strcmp(a, "--profiles") == 0) {
+            if (parse_profiles(v) != 0) {
+                fprintf(stderr, "Bad profile list '%s'\n", v);
+                return 2;
+            }
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    int traces = corpus ? run_corpus(corpus) : run_synth(synth, minutes, save_dir);
+    if (traces <= 0) {
+        fprintf(stderr, "No traces replayed\n");
+        return 1;
+    }
+    report(csv);
+
+    for (int p = 0; p < s_profile_count; p++) {
+        for (int s = 0; s < s_scenario_count; s++) free(s_stats[p][s].latency_ms);
+    }
+    return 0;
+}
@@ -0,0 +1,270 @@
+#include "trace_gen.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PI_F          (3.14159265f)
+#define LSB_PER_MG    (8.192f)      // +/-4 g
+#define GYRO_LSB_DPS  (131.0f)
+#define NOISE_MG      (4.0f)        // Sensor noise (1 sigma) in low-power mode
+#define LEAD_IN_S     (60)          // Quiet parking before a theft starts
+
+static const char *const s_names[SCENARIO_COUNT] = {
+    [SCENARIO_BIKE_RACK] = "bike_rack",
+    [SCENARIO_WIND] = "wind",
+    [SCENARIO_LIFT_CARRY] = "lift_carry",
+    [SCENARIO_RIDE_AWAY] = "ride_away",
+};
+
+const char *scenario_name(scenario_t s) {
+    return s < SCENARIO_COUNT ? s_names[s] : "?";
+}
+
+int scenario_from_name(const char *name) {
+    for (int i = 0; i < SCENARIO_COUNT; i++) {
+        if (strcmp(name, s_names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+// --- Trace builder ---
+
+typedef struct {
+    imu_trace_sample_t *buf;
+    size_t count;
+    size_t capacity;
+    uint32_t rng;
+    float roll_deg;          // Bike attitude (gravity direction)
+    float pitch_deg;
+    float prev_roll_deg;
+    float prev_pitch_deg;
+} gen_t;
+
+static float rnd(gen_t *g) {
+    // xorshift32, [0, 1)
+    g->rng ^= g->rng << 13;
+    g->rng ^= g->rng >> 17;
+    g->rng ^= g->rng << 5;
+    return (g->rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static float uniform(gen_t *g, float lo, float hi) {
+    return lo + (hi - lo) * rnd(g);
+}
+
+static float gauss(gen_t *g) {
+    float u1 = rnd(g) + 1e-7f;
+    float u2 = rnd(g);
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * PI_F * u2);
+}
+
+static int16_t clamp_i16(float v) {
+    if (v > 32767.0f) return 32767;
+    if (v < -32768.0f) return -32768;
+    return (int16_t)lrintf(v);
+}
+
+// Appends one sample: gravity for the current attitude + dynamic accel (mg)
+static void emit(gen_t *g, float dx, float dy, float dz) {
+    if (g->count == g->capacity) return;
+
+    float r = g->roll_deg * (PI_F / 180.0f);
+    float p = g->pitch_deg * (PI_F / 180.0f);
+    float ax = -sinf(p) * 1000.0f + dx;
+    float ay = sinf(r) * cosf(p) * 1000.0f + dy;
+    float az = cosf(r) * cosf(p) * 1000.0f + dz;
+
+    imu_trace_sample_t *s = &g->buf[g->count];
+    s->t_ms = (uint32_t)(g->count * (1000 / TRACE_GEN_RATE_HZ));
+    s->ax = clamp_i16((ax + gauss(g) * NOISE_MG) * LSB_PER_MG);
+    s->ay = clamp_i16((ay + gauss(g) * NOISE_MG) * LSB_PER_MG);
+    s->az = clamp_i16((az + gauss(g) * NOISE_MG) * LSB_PER_MG);
+
+    float dps_x = (g->roll_deg - g->prev_roll_deg) * TRACE_GEN_RATE_HZ;
+    float dps_y = (g->pitch_deg - g->prev_pitch_deg) * TRACE_GEN_RATE_HZ;
+    s->gx = clamp_i16(dps_x * GYRO_LSB_DPS);
+    s->gy = clamp_i16(dps_y * GYRO_LSB_DPS);
+    s->gz = 0;
+    s->flags = 0;
+    g->prev_roll_deg = g->roll_deg;
+    g->prev_pitch_deg = g->pitch_deg;
+    g->count++;
+}
+
+static void quiet(gen_t *g, float seconds) {
+    int n = (int)(seconds * TRACE_GEN_RATE_HZ);
+    for (int i = 0; i < n; i++) emit(g, 0, 0, 0);
+}
+
+static float now_s(const gen_t *g) {
+    return (float)g->count / TRACE_GEN_RATE_HZ;
+}
+
+// Damped ringing of the frame after an impact
+static void bump(gen_t *g, float peak_mg) {
+    float f = uniform(g, 12.0f, 25.0f);
+    float tau = uniform(g, 0.08f, 0.25f);
+    float dir[3] = { uniform(g, -1, 1), uniform(g, -1, 1), uniform(g, -0.4f, 0.4f) };
+    float norm = sqrtf(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]) + 1e-6f;
+    int n = (int)(5.0f * tau * TRACE_GEN_RATE_HZ);
+
+    for (int i = 0; i < n; i++) {
+        float t = (float)i / TRACE_GEN_RATE_HZ;
+        float a = peak_mg * expf(-t / tau) * sinf(2.0f * PI_F * f * t);
+        emit(g, a * dir[0] / norm, a * dir[1] / norm, a * dir[2] / norm);
+    }
+}
+
+// Irregular shaking (another bike pushed into the rack, a lock rattled)
+static void jostle(gen_t *g, float seconds, float amp_mg) {
+    int n = (int)(seconds * TRACE_GEN_RATE_HZ);
+    float f = uniform(g, 3.0f, 8.0f);
+    float phase = 0.0f;
+    for (int i = 0; i < n; i++) {
+        phase += 2.0f * PI_F * f * (1.0f + 0.3f * gauss(g)) / TRACE_GEN_RATE_HZ;
+        float env = sinf(PI_F * i / n);
+        emit(g, amp_mg * env * sinf(phase), amp_mg * env * cosf(1.3f * phase),
+             0.3f * amp_mg * env * gauss(g));
+    }
+}
+
+static void gen_bike_rack(gen_t *g, float seconds) {
+    while (now_s(g) < seconds) {
+        // Poisson arrivals, mean 45 s apart
+        quiet(g, -45.0f * logf(rnd(g) + 1e-6f));
+
+        float kind = rnd(g);
+        if (kind < 0.1f) {
+            jostle(g, uniform(g, 2.0f, 4.0f), uniform(g, 150.0f, 400.0f));
+        } else {
+            bump(g, uniform(g, 200.0f, 1200.0f));
+            if (kind < 0.4f) {
+                quiet(g, uniform(g, 0.3f, 1.0f));
+                bump(g, uniform(g, 100.0f, 600.0f));
+            }
+        }
+        // The bike settles slightly differently against the rack
+        g->roll_deg += uniform(g, -1.5f, 1.5f);
+    }
+}
+
+static void gen_wind(gen_t *g, float seconds) {
+    float base_roll = g->roll_deg;
+    while (now_s(g) < seconds) {
+        quiet(g, uniform(g, 2.0f, 30.0f));
+
+        float dur = uniform(g, 3.0f, 15.0f);
+        float sway_deg = uniform(g, 0.5f, 4.0f);
+        float sway_hz = uniform(g, 0.4f, 1.5f);
+        float flutter_mg = uniform(g, 10.0f, 40.0f);
+        float flutter_hz = uniform(g, 2.0f, 6.0f);
+        int n = (int)(dur * TRACE_GEN_RATE_HZ);
+
+        for (int i = 0; i < n; i++) {
+            float t = (float)i / TRACE_GEN_RATE_HZ;
+            float env = sinf(PI_F * i / n);
+            g->roll_deg = base_roll + sway_deg * env * sinf(2.0f * PI_F * sway_hz * t);
+            float fl = flutter_mg * env * sinf(2.0f * PI_F * flutter_hz * t);
+            emit(g, 0.3f * fl, fl, 0.2f * fl * gauss(g));
+        }
+        g->roll_deg = base_roll;
+    }
+}
+
+static void gen_lift_carry(gen_t *g) {
+    // Lift: pitch up over ~1 s with an up/down vertical push
+    float lift_deg = uniform(g, 15.0f, 35.0f);
+    int n = TRACE_GEN_RATE_HZ;
+    for (int i = 0; i < n; i++) {
+        float x = (float)i / n;
+        g->pitch_deg = lift_deg * x;
+        emit(g, 0, 0, 300.0f * sinf(2.0f * PI_F * x));
+    }
+
+    // Carry: walking steps, swaying load
+    float step_hz = uniform(g, 1.6f, 2.1f);
+    float vert_mg = uniform(g, 150.0f, 350.0f);
+    float lat_mg = uniform(g, 50.0f, 120.0f);
+    n = 40 * TRACE_GEN_RATE_HZ;
+    for (int i = 0; i < n; i++) {
+        float t = (float)i / TRACE_GEN_RATE_HZ;
+        float w = 2.0f * PI_F * step_hz * t;
+        g->pitch_deg = lift_deg + 5.0f * sinf(2.0f * PI_F * 0.5f * t);
+        emit(g, 0.2f * vert_mg * sinf(w + 1.0f),
+             lat_mg * sinf(0.5f * w),
+             vert_mg * (sinf(w) + 0.3f * sinf(2.0f * w)));
+    }
+}
+
+static void gen_ride_away(gen_t *g) {
+    // Unlocking
+    jostle(g, uniform(g, 2.0f, 5.0f), uniform(g, 100.0f, 300.0f));
+
+    // Kickstand up
+    float stand_deg = uniform(g, 5.0f, 12.0f);
+    float start_roll = g->roll_deg;
+    int n = TRACE_GEN_RATE_HZ / 2;
+    for (int i = 0; i < n; i++) {
+        g->roll_deg = start_roll - stand_deg * (float)i / n;
+        emit(g, 0, 0, 0);
+    }
+
+    // Riding: filtered road noise, pedalling sway, potholes
+    float road_mg = uniform(g, 80.0f, 200.0f);
+    float pedal_hz = uniform(g, 1.2f, 1.6f);
+    float sway_deg = uniform(g, 3.0f, 6.0f);
+    float lp[3] = {0};
+    float upright = g->roll_deg + stand_deg;
+    n = 60 * TRACE_GEN_RATE_HZ;
+    for (int i = 0; i < n; i++) {
+        float t = (float)i / TRACE_GEN_RATE_HZ;
+        for (int k = 0; k < 3; k++) lp[k] += 0.5f * (road_mg * gauss(g) - lp[k]);
+        g->roll_deg = upright + sway_deg * sinf(2.0f * PI_F * pedal_hz * t);
+        float surge = uniform(g, 50.0f, 150.0f) * (sinf(4.0f * PI_F * pedal_hz * t) > 0.9f);
+        float pothole = rnd(g) < 0.002f ? uniform(g, 500.0f, 1500.0f) : 0.0f;
+        emit(g, lp[0] + surge, lp[1], lp[2] + pothole);
+    }
+}
+
+int trace_gen(scenario_t s, uint32_t seed, uint32_t minutes, gen_trace_t *out) {
+    float seconds = s == SCENARIO_BIKE_RACK || s == SCENARIO_WIND ? minutes * 60.0f : LEAD_IN_S + 120.0f;
+
+    gen_t g = {0};
+    g.capacity = (size_t)(seconds + 60.0f) * TRACE_GEN_RATE_HZ;   // Last event may run over
+    g.buf = malloc(g.capacity * sizeof(imu_trace_sample_t));
+    if (g.buf == NULL) return -1;
+    g.rng = seed * 2654435761u + 1u;
+    g.roll_deg = uniform(&g, -3.0f, 3.0f);       // Parked slightly off level
+    g.prev_roll_deg = g.roll_deg;
+
+    out->onset_ms = -1;
+    switch (s) {
+    case SCENARIO_BIKE_RACK:
+        gen_bike_rack(&g, seconds);
+        break;
+    case SCENARIO_WIND:
+        gen_wind(&g, seconds);
+        break;
+    case SCENARIO_LIFT_CARRY:
+    case SCENARIO_RIDE_AWAY:
+        quiet(&g, LEAD_IN_S);
+        out->onset_ms = (int64_t)g.count * 1000 / TRACE_GEN_RATE_HZ;
+        if (s == SCENARIO_LIFT_CARRY) gen_lift_carry(&g);
+        else gen_ride_away(&g);
+        quiet(&g, 5.0f);
+        break;
+    default:
+        free(g.buf);
+        return -1;
+    }
+
+    out->samples = g.buf;
+    out->count = g.count;
+    return 0;
+}
+
+void trace_gen_free(gen_trace_t *t) {
+    free(t->samples);
+    t->samples = NULL;
+    t->count = 0;
+}
@@ -0,0 +1,42 @@
+#ifndef TRACE_GEN_H
+#define TRACE_GEN_H
+
+/*
+ * Synthetic labelled traces for the benchmark, used when no recorded
+ * corpus is given. Deterministic for a given seed. Traces are sampled at
+ * TRACE_GEN_RATE_HZ, +/-4 g, sensor flat with gravity on +Z.
+ */
+
+#include <stddef.h>
+#include "imu_sim.h"
+
+#define TRACE_GEN_RATE_HZ  (100)
+#define TRACE_GEN_RANGE_G  (4)
+
+typedef enum {
+    SCENARIO_BIKE_RACK,      // Parked; other bikes bumping the rack (nuisance)
+    SCENARIO_WIND,           // Parked; gusts swaying the bike (nuisance)
+    SCENARIO_LIFT_CARRY,     // Lifted off the stand and carried away (theft)
+    SCENARIO_RIDE_AWAY,      // Unlocked and ridden away (theft)
+    SCENARIO_COUNT,
+} scenario_t;
+
+typedef struct {
+    imu_trace_sample_t *samples;   // malloc'd, free with trace_gen_free()
+    size_t count;
+    int64_t onset_ms;              // Theft start in trace time, -1 for nuisance traces
+} gen_trace_t;
+
+const char *scenario_name(scenario_t s);
+int scenario_from_name(const char *name);    // -1 if unknown
+
+/**
+ * @brief Generate one trace.
+ * @param minutes Length of nuisance traces; theft traces are a fixed
+ *                quiet lead-in plus the theft itself.
+ * @return 0, or -1 on allocation failure.
+ */
+int trace_gen(scenario_t s, uint32_t seed, uint32_t minutes, gen_trace_t *out);
+void trace_gen_free(gen_trace_t *t);
+
+#endif // TRACE_GEN_H
@@ -0,0 +1,89 @@
+#ifndef HOST_DRIVER_I2C_MASTER_H
+#define HOST_DRIVER_I2C_MASTER_H
+
+// Host stand-in for the ESP-IDF I2C master driver in asynchronous mode
+// (event callbacks registered): transactions are queued with pointers to
+// the caller's buffers and complete only when the test says so
+// (fake_i2c_complete) or in i2c_master_bus_wait_all_done. A submit to a
+// full queue fails like one on a stalled bus.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct fake_i2c_bus *i2c_master_bus_handle_t;
+typedef struct fake_i2c_dev *i2c_master_dev_handle_t;
+
+typedef enum { I2C_CLK_SRC_DEFAULT } i2c_clock_source_t;
+typedef enum { I2C_ADDR_BIT_LEN_7 } i2c_addr_bit_len_t;
+
+typedef struct {
+    int i2c_port;
+    int sda_io_num;
+    int scl_io_num;
+    i2c_clock_source_t clk_source;
+    uint8_t glitch_ignore_cnt;
+    size_t trans_queue_depth;
+    struct {
+        uint32_t enable_internal_pullup : 1;
+    } flags;
+} i2c_master_bus_config_t;
+
+typedef struct {
+    i2c_addr_bit_len_t dev_addr_length;
+    uint16_t device_address;
+    uint32_t scl_speed_hz;
+} i2c_device_config_t;
+
+typedef enum {
+    I2C_EVENT_ALIVE,
+    I2C_EVENT_DONE,
+    I2C_EVENT_NACK,
+    I2C_EVENT_TIMEOUT,
+} i2c_master_event_t;
+
+typedef struct {
+    i2c_master_event_t event;
+} i2c_master_event_data_t;
+
+typedef bool (*i2c_master_callback_t)(i2c_master_dev_handle_t dev, const i2c_master_event_data_t *evt, void *arg);
+
+typedef struct {
+    i2c_master_callback_t on_trans_done;
+} i2c_master_event_callbacks_t;
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *cfg, i2c_master_bus_handle_t *ret_bus);
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus, const i2c_device_config_t *cfg,
+                                    i2c_master_dev_handle_t *ret_dev);
+esp_err_t i2c_master_register_event_callbacks(i2c_master_dev_handle_t dev, const i2c_master_event_callbacks_t *cbs,
+                                              void *arg);
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t dev, const uint8_t *write_buffer, size_t write_size,
+                              int xfer_timeout_ms);
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t dev, const uint8_t *write_buffer, size_t write_size,
+                                      uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+esp_err_t i2c_master_bus_wait_all_done(i2c_master_bus_handle_t bus, int timeout_ms);
+
+// --- Test controls ---
+
+#define FAKE_I2C_QUEUE_MAX  (32)
+
+typedef struct {
+    bool async;                 // Accept event callbacks (else transactions block)
+    bool stalled;               // Nothing completes; wait_all_done times out
+    esp_err_t fail_submit;      // Next submit returns this (ESP_OK = none)
+    bool fail_completion;       // Next completion reports a NACK
+    size_t depth;               // From the bus configuration
+    size_t queued;
+    uint32_t completed;
+    uint8_t regs[256];          // Register file, auto-increment on access
+} fake_i2c_t;
+
+extern fake_i2c_t fake_i2c;
+
+void fake_i2c_reset(void);
+
+// Completes up to n queued transactions in order (the ISR); returns how many
+size_t fake_i2c_complete(size_t n);
+
+#endif // HOST_DRIVER_I2C_MASTER_H
@@ -0,0 +1,7 @@
+#ifndef HOST_ESP_ATTR_H
+#define HOST_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+
+#endif // HOST_ESP_ATTR_H
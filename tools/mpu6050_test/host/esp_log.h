@@ -0,0 +1,14 @@
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+// Host stand-in: formats are type-checked, nothing is printed
+
+#include <stdio.h>
+
+#define HOST_LOG(tag, fmt, ...) do { (void)(tag); if (0) printf(fmt, ##__VA_ARGS__); } while (0)
+#define ESP_LOGE(tag, fmt, ...) HOST_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) HOST_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) HOST_LOG(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) HOST_LOG(tag, fmt, ##__VA_ARGS__)
+
+#endif // HOST_ESP_LOG_H
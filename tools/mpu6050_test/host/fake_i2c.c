@@ -0,0 +1,123 @@
+#include "driver/i2c_master.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include <string.h>
+
+fake_i2c_t fake_i2c;
+
+typedef struct {
+    const uint8_t *tx;
+    size_t tx_len;
+    uint8_t *rx;
+    size_t rx_len;
+} fake_trans_t;
+
+static fake_trans_t s_queue[FAKE_I2C_QUEUE_MAX];
+static size_t s_head;
+static i2c_master_callback_t s_cb;
+static void *s_cb_arg;
+static int64_t s_now_us;
+
+// Handles only need to be distinct and non-NULL
+static struct fake_i2c_bus { int unused; } s_bus;
+static struct fake_i2c_dev { int unused; } s_dev;
+
+void fake_i2c_reset(void) {
+    memset(&fake_i2c, 0, sizeof(fake_i2c));
+    fake_i2c.async = true;
+    s_head = 0;
+    s_cb = NULL;
+}
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *cfg, i2c_master_bus_handle_t *ret_bus) {
+    fake_i2c.depth = cfg->trans_queue_depth < FAKE_I2C_QUEUE_MAX ? cfg->trans_queue_depth : FAKE_I2C_QUEUE_MAX;
+    *ret_bus = &s_bus;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus, const i2c_device_config_t *cfg,
+                                    i2c_master_dev_handle_t *ret_dev) {
+    (void)bus;
+    (void)cfg;
+    *ret_dev = &s_dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_register_event_callbacks(i2c_master_dev_handle_t dev, const i2c_master_event_callbacks_t *cbs,
+                                              void *arg) {
+    (void)dev;
+    if (!fake_i2c.async) return ESP_ERR_NOT_SUPPORTED;
+    s_cb = cbs->on_trans_done;
+    s_cb_arg = arg;
+    return ESP_OK;
+}
+
+// The device: a register file with auto-increment
+static bool execute(const fake_trans_t *t) {
+    if (t->tx_len == 0) return false;
+    uint8_t reg = t->tx[0];
+    for (size_t i = 1; i < t->tx_len; i++) fake_i2c.regs[(uint8_t)(reg + i - 1)] = t->tx[i];
+    for (size_t i = 0; i < t->rx_len; i++) t->rx[i] = fake_i2c.regs[(uint8_t)(reg + i)];
+    return true;
+}
+
+size_t fake_i2c_complete(size_t n) {
+    size_t done = 0;
+    while (done < n && fake_i2c.queued > 0) {
+        const fake_trans_t *t = &s_queue[s_head];
+        s_head = (s_head + 1) % FAKE_I2C_QUEUE_MAX;
+        fake_i2c.queued--;
+
+        bool ok = execute(t) && !fake_i2c.fail_completion;
+        fake_i2c.fail_completion = false;
+        fake_i2c.completed++;
+        i2c_master_event_data_t evt = {.event = ok ? I2C_EVENT_DONE : I2C_EVENT_NACK};
+        if (s_cb) s_cb(&s_dev, &evt, s_cb_arg);
+        done++;
+    }
+    return done;
+}
+
+static esp_err_t submit(const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len) {
+    esp_err_t err = fake_i2c.fail_submit;
+    fake_i2c.fail_submit = ESP_OK;
+    if (err != ESP_OK) return err;
+
+    fake_trans_t t = {tx, tx_len, rx, rx_len};
+    if (!s_cb) return execute(&t) ? ESP_OK : ESP_FAIL;
+
+    if (fake_i2c.queued >= fake_i2c.depth) return ESP_ERR_TIMEOUT;
+    s_queue[(s_head + fake_i2c.queued) % FAKE_I2C_QUEUE_MAX] = t;
+    fake_i2c.queued++;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t dev, const uint8_t *write_buffer, size_t write_size,
+                              int xfer_timeout_ms) {
+    (void)dev;
+    (void)xfer_timeout_ms;
+    return submit(write_buffer, write_size, NULL, 0);
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t dev, const uint8_t *write_buffer, size_t write_size,
+                                      uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms) {
+    (void)dev;
+    (void)xfer_timeout_ms;
+    return submit(write_buffer, write_size, read_buffer, read_size);
+}
+
+esp_err_t i2c_master_bus_wait_all_done(i2c_master_bus_handle_t bus, int timeout_ms) {
+    (void)bus;
+    (void)timeout_ms;
+    if (fake_i2c.stalled && fake_i2c.queued > 0) return ESP_ERR_TIMEOUT;
+    fake_i2c_complete(fake_i2c.queued);
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time(void) {
+    return s_now_us += 10;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    s_now_us += (int64_t)ticks * 1000;
+}
@@ -0,0 +1,190 @@
+/*
+ * Tests for the queued I2C transactions of the MPU-6050 driver.
+ *
+ *   mpu6050_async_test
+ *
+ * Runs mpu6050.c against a host fake of the IDF I2C master driver that
+ * completes transactions only when told to, and checks the background read
+ * (callback, its place among queued writes, one read at a time), a full
+ * sensing batch behind a pending read, failed submits and completions
+ * keeping the completion tags aligned, a wait that times out with
+ * transactions still queued, and the synchronous bus fallback.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "driver/i2c_master.h"
+#include "mpu6050.h"
+
+static int s_failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); s_failures++; } \
+} while (0)
+
+#define REG_ACCEL_CONFIG    0x1C
+#define REG_MOT_THR         0x1F
+#define REG_PWR_MGMT_1      0x6B
+#define REG_WHO_AM_I        0x75
+
+typedef struct {
+    int calls;
+    esp_err_t result;
+    uint8_t reg;
+    uint8_t value;
+} read_done_t;
+
+// Runs in the fake's completion, like the ISR on the target
+static void on_read(esp_err_t result, uint8_t reg_addr, uint8_t *data, size_t len, void *arg) {
+    read_done_t *d = (read_done_t *)arg;
+    d->calls++;
+    d->result = result;
+    d->reg = reg_addr;
+    d->value = len > 0 ? data[0] : 0;
+}
+
+static void setup(bool async) {
+    fake_i2c_reset();
+    fake_i2c.async = async;
+    fake_i2c.regs[REG_WHO_AM_I] = 0x68;
+    const mpu6050_config_t conf = {.scl_io = 22, .sda_io = 21, .device_addr = 0x68, .i2c_port = 0};
+    CHECK(mpu6050_init(&conf) == ESP_OK);
+    mpu6050_reset_i2c_stats();
+}
+
+static void test_async_read(void) {
+    setup(true);
+    read_done_t d = {0};
+    uint8_t buf[1] = {0};
+
+    CHECK(mpu6050_read_async(REG_WHO_AM_I, buf, 1, on_read, &d) == ESP_OK);
+    CHECK(d.calls == 0);
+    CHECK(mpu6050_get_i2c_stats().async_reads == 1);
+
+    // One at a time
+    read_done_t other = {0};
+    uint8_t other_buf[1];
+    CHECK(mpu6050_read_async(REG_WHO_AM_I, other_buf, 1, on_read, &other) == ESP_ERR_INVALID_STATE);
+    CHECK(mpu6050_get_i2c_stats().async_reads == 1);
+
+    CHECK(fake_i2c_complete(1) == 1);
+    CHECK(d.calls == 1);
+    CHECK(d.result == ESP_OK);
+    CHECK(d.reg == REG_WHO_AM_I);
+    CHECK(d.value == 0x68);
+    CHECK(buf[0] == 0x68);
+
+    // Done: the next one may start
+    CHECK(mpu6050_read_async(REG_WHO_AM_I, other_buf, 1, on_read, &other) == ESP_OK);
+    CHECK(fake_i2c_complete(1) == 1);
+    CHECK(other.calls == 1);
+
+    CHECK(mpu6050_read_async(REG_WHO_AM_I, NULL, 1, on_read, &d) == ESP_ERR_INVALID_ARG);
+    CHECK(mpu6050_read_async(REG_WHO_AM_I, buf, 0, on_read, &d) == ESP_ERR_INVALID_ARG);
+}
+
+static void test_batch_behind_read(void) {
+    setup(true);
+    read_done_t d = {0};
+    uint8_t buf[1];
+    CHECK(mpu6050_read_async(REG_WHO_AM_I, buf, 1, on_read, &d) == ESP_OK);
+
+    // Eight writes queued behind the read: all must fit
+    const mpu6050_sensing_t sensing = {
+        .accel_range = ACCEL_RANGE_4G,
+        .dlpf = DLPF_44HZ,
+        .motion_int = true,
+        .motion_threshold = 20,
+        .motion_duration = 1,
+    };
+    CHECK(mpu6050_apply_sensing(&sensing) == ESP_OK);
+    CHECK(fake_i2c.queued == 0);
+
+    // The read completed first and kept its tag; the writes landed
+    CHECK(d.calls == 1);
+    CHECK(d.result == ESP_OK);
+    CHECK(d.value == 0x68);
+    CHECK(fake_i2c.regs[REG_ACCEL_CONFIG] == (ACCEL_RANGE_4G << 3));
+    CHECK(fake_i2c.regs[REG_MOT_THR] == 20);
+    CHECK(fake_i2c.regs[REG_PWR_MGMT_1] == 0x01);
+    CHECK(mpu6050_get_i2c_stats().errors == 0);
+}
+
+static void test_failures_keep_tags(void) {
+    setup(true);
+    read_done_t d = {0};
+    uint8_t buf[1];
+
+    // A read that never got queued: not counted, no callback, not pending
+    fake_i2c.fail_submit = ESP_FAIL;
+    CHECK(mpu6050_read_async(REG_WHO_AM_I, buf, 1, on_read, &d) == ESP_FAIL);
+    CHECK(mpu6050_get_i2c_stats().async_reads == 0);
+    CHECK(fake_i2c_complete(1) == 0);
+    CHECK(d.calls == 0);
+
+    // A failed synchronous submit in between
+    fake_i2c.fail_submit = ESP_FAIL;
+    CHECK(mpu6050_set_accel_range(ACCEL_RANGE_8G) == ESP_FAIL);
+
+    // The next read still gets its own completion, ahead of a sync one
+    CHECK(mpu6050_read_async(REG_WHO_AM_I, buf, 1, on_read, &d) == ESP_OK);
+    CHECK(mpu6050_test_connection());
+    CHECK(d.calls == 1);
+    CHECK(d.result == ESP_OK);
+    CHECK(d.value == 0x68);
+
+    // A NACKed read reports the error to its callback only
+    fake_i2c.fail_completion = true;
+    CHECK(mpu6050_read_async(REG_WHO_AM_I, buf, 1, on_read, &d) == ESP_OK);
+    CHECK(mpu6050_test_connection());
+    CHECK(d.calls == 2);
+    CHECK(d.result != ESP_OK);
+}
+
+// Overwrites the stack the timed-out call used
+static void clobber_stack(void) {
+    volatile uint8_t junk[512];
+    memset((uint8_t *)junk, 0xA5, sizeof(junk));
+}
+
+static void test_wait_timeout(void) {
+    setup(true);
+    fake_i2c.regs[REG_ACCEL_CONFIG] = 0;
+
+    // The bus stalls: the write stays queued after the call returns
+    fake_i2c.stalled = true;
+    CHECK(mpu6050_set_accel_range(ACCEL_RANGE_8G) == ESP_ERR_TIMEOUT);
+    CHECK(fake_i2c.queued == 1);
+    clobber_stack();
+
+    // Nothing new is queued over the buffers still in use
+    CHECK(!mpu6050_test_connection());
+    CHECK(fake_i2c.queued == 1);
+
+    // When the bus recovers the write carries the value it was given
+    fake_i2c.stalled = false;
+    CHECK(fake_i2c_complete(1) == 1);
+    CHECK(fake_i2c.regs[REG_ACCEL_CONFIG] == (ACCEL_RANGE_8G << 3));
+    CHECK(mpu6050_test_connection());
+}
+
+static void test_sync_bus(void) {
+    setup(false);
+    read_done_t d = {0};
+    uint8_t buf[1];
+    CHECK(mpu6050_read_async(REG_WHO_AM_I, buf, 1, on_read, &d) == ESP_ERR_NOT_SUPPORTED);
+    CHECK(mpu6050_get_i2c_stats().async_reads == 0);
+    CHECK(mpu6050_test_connection());
+    CHECK(mpu6050_set_accel_range(ACCEL_RANGE_2G) == ESP_OK);
+    CHECK(fake_i2c.regs[REG_ACCEL_CONFIG] == 0);
+}
+
+int main(void) {
+    test_async_read();
+    test_batch_behind_read();
+    test_failures_keep_tags();
+    test_wait_timeout();
+    test_sync_bus();
+    printf("mpu6050_async_test: %d failures\n", s_failures);
+    return s_failures ? 1 : 0;
+}